@@ -0,0 +1,49 @@
+/**
+    Definition of the frame loading shared by the detection benchmarks
+*/
+
+#include "BenchFrames.hpp"
+
+#include <cstddef>  // std::size_t
+#include <memory>   // std::unique_ptr
+
+#include "FrameSource.hpp"
+
+// Frames loaded from the input, enough for a stable average without exhausting memory
+const std::size_t MAX_FRAMES = 300;
+
+// Rate recordings are read at when they do not store one, only used for source times
+const double FRAME_RATE = 30.0;
+
+/**
+    Loads up to MAX_FRAMES frames through FrameSource, so benchmarks read
+    recordings exactly as the monitor does
+
+    @param aLocation video file, directory of images or webcam index
+
+    @return frames in the order they were recorded, empty if none could be read
+*/
+std::vector<cv::Mat> LoadFrames( std::string const& aLocation )
+{
+    std::vector<cv::Mat> frames;
+
+    std::unique_ptr<FrameSource> source = FrameSource::Create( aLocation, FRAME_RATE );
+    if( !source->Open() )
+    {
+        return frames;
+    }
+
+    // Each frame is read into a new Frame, sources may reuse the image they are given
+    while( frames.size() < MAX_FRAMES )
+    {
+        Frame frame;
+        if( !source->Read( frame ) )
+        {
+            break;
+        }
+        frames.push_back( frame.image );
+    }
+
+    source->Close();
+    return frames;
+}
@@ -0,0 +1,11 @@
+/**
+    Declaration of the frame loading shared by the detection benchmarks
+*/
+
+#pragma once
+
+#include <opencv2/core/mat.hpp> // cv::Mat
+#include <string>               // std::string
+#include <vector>               // std::vector
+
+std::vector<cv::Mat> LoadFrames( std::string const& aLocation );
@@ -0,0 +1,313 @@
+/**
+    Microbenchmarks for each stage of the eye tracking hot path
+
+    Every stage is run on the same frames at several resolutions: wrapping a
+    frame as a dlib image, the grayscale conversion and downscale before
+    detection, face detection, landmark fitting, the eye aspect ratio and the
+    blink signal dispatch. The batch eye aspect ratio is also checked against
+    Eye::AspectRatio and the run fails if any result differs. Frames are
+    synthetic noise by default, which keeps runs repeatable between builds, or
+    the first frame of a recording given with --source. Each benchmark is timed
+    over several samples and the median is reported as ns/op and frames/s.
+    --json writes the results in a machine readable form so regressions can be
+    tracked between builds.
+
+    Usage:
+    ./blink_bench [--source <video file | image directory>] [--json <file>]
+*/
+
+#include <algorithm>                // std::sort
+#include <boost/signals2.hpp>       // boost::signals2::signal
+#include <chrono>                   // std::chrono::steady_clock
+#include <dlib/opencv.h>            // dlib::cv_image
+#include <fstream>                  // std::ofstream
+#include <functional>               // std::function
+#include <iomanip>                  // std::setw, std::setprecision
+#include <iostream>                 // std::cout, std::cerr
+#include <opencv2/imgproc.hpp>      // cv::cvtColor, cv::resize
+#include <string>                   // std::string
+#include <vector>                   // std::vector
+
+#include "Eye.hpp"
+#include "EyeBatch.hpp"
+#include "FaceDetector.hpp"
+#include "FrameSource.hpp"
+#include "LandmarkModel.hpp"
+
+// Resolutions every frame based benchmark is run at
+const std::vector<cv::Size> RESOLUTIONS = { cv::Size( 640, 480 ), cv::Size( 1280, 720 ), cv::Size( 1920, 1080 ) };
+
+// Each benchmark is timed SAMPLES times for at least SAMPLE_SECONDS each
+const int SAMPLES = 5;
+const double SAMPLE_SECONDS = 0.2;
+
+// Number of random eyes the batch eye aspect ratio is run on
+const std::size_t BATCH_EYES = 1024;
+
+// Landmark model used for the shape predictor benchmark
+const char* LANDMARK_MODEL = "shape_predictor_68_face_landmarks.dat";
+
+/**
+    Result of a single benchmark
+*/
+struct Result
+{
+    std::string name;
+    std::string resolution;
+    double nsPerOp;
+};
+
+/**
+    Times an operation, repeating it until each sample takes SAMPLE_SECONDS
+
+    @return median time per call in nanoseconds
+*/
+double Measure( std::function<void ()> const& aOperation )
+{
+    // Warm up caches and lazily initialised state
+    aOperation();
+
+    std::vector<double> samples;
+    for( int sample = 0; sample < SAMPLES; ++sample )
+    {
+        long iterations = 0;
+        std::chrono::duration<double> elapsed( 0.0 );
+        auto start = std::chrono::steady_clock::now();
+        while( elapsed.count() < SAMPLE_SECONDS )
+        {
+            aOperation();
+            ++iterations;
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+        samples.push_back( elapsed.count() * 1e9 / iterations );
+    }
+
+    std::sort( samples.begin(), samples.end() );
+    return samples[samples.size() / 2];
+}
+
+/**
+    Creates a repeatable frame of noise at the given resolution, or scales
+    the recorded frame when one was loaded
+
+    @return BGR frame of aSize
+*/
+cv::Mat MakeFrame( cv::Mat const& aRecorded, cv::Size aSize )
+{
+    cv::Mat frame;
+    if( !aRecorded.empty() )
+    {
+        cv::resize( aRecorded, frame, aSize, 0, 0, cv::INTER_AREA );
+        return frame;
+    }
+
+    frame.create( aSize, CV_8UC3 );
+    cv::RNG rng( 0x424c4e4b );
+    rng.fill( frame, cv::RNG::UNIFORM, 0, 256 );
+    return frame;
+}
+
+/**
+    Reads the first frame of a recording
+
+    @return the frame, empty if none could be read
+*/
+cv::Mat LoadRecordedFrame( std::string const& aLocation )
+{
+    Frame frame;
+    std::unique_ptr<FrameSource> source = FrameSource::Create( aLocation, 30.0 );
+    if( !source->Open() || !source->Read( frame ) )
+    {
+        frame.image = cv::Mat();
+    }
+    source->Close();
+    return frame.image;
+}
+
+/**
+    Writes the results as JSON
+*/
+void WriteJson( std::vector<Result> const& aResults, std::string const& aPath )
+{
+    std::ofstream json( aPath );
+    json << "{\n  \"benchmarks\": [\n";
+    for( std::size_t i = 0; i < aResults.size(); ++i )
+    {
+        Result const& result = aResults[i];
+        json << "    { \"name\": \"" << result.name << "\""
+             << ", \"resolution\": \"" << result.resolution << "\""
+             << std::fixed << std::setprecision( 1 )
+             << ", \"ns_per_op\": " << result.nsPerOp
+             << ", \"frames_per_second\": " << 1e9 / result.nsPerOp
+             << " }" << ( i + 1 < aResults.size() ? "," : "" ) << "\n";
+    }
+    json << "  ]\n}\n";
+}
+
+int main( int argc, char* argv[] )
+{
+    std::string source;
+    std::string jsonPath;
+    for( int i = 1; i < argc; ++i )
+    {
+        std::string argument = argv[i];
+        if( argument == "--source" && i + 1 < argc )
+        {
+            source = argv[++i];
+        }
+        else if( argument == "--json" && i + 1 < argc )
+        {
+            jsonPath = argv[++i];
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--source <video file | image directory>] [--json <file>]" << std::endl;
+            return 1;
+        }
+    }
+
+    cv::Mat recorded;
+    if( !source.empty() )
+    {
+        recorded = LoadRecordedFrame( source );
+        if( recorded.empty() )
+        {
+            std::cerr << "No frames could be read from " << source << std::endl;
+            return 1;
+        }
+    }
+
+    LandmarkModel landmarkModel;
+    bool haveModel = landmarkModel.Load( LANDMARK_MODEL );
+    if( !haveModel )
+    {
+        std::cerr << LANDMARK_MODEL << " not found, skipping shape_predictor" << std::endl;
+    }
+
+    std::vector<Result> results;
+    auto run = [&results]( std::string const& aName, std::string const& aResolution, std::function<void ()> const& aOperation )
+    {
+        results.push_back( Result{ aName, aResolution, Measure( aOperation ) } );
+        Result const& result = results.back();
+        std::cout << std::left << std::setw( 24 ) << result.name << std::setw( 12 ) << result.resolution
+                  << std::right << std::fixed << std::setprecision( 0 )
+                  << std::setw( 14 ) << result.nsPerOp << " ns/op"
+                  << std::setprecision( 1 ) << std::setw( 14 ) << 1e9 / result.nsPerOp << " frames/s" << std::endl;
+    };
+
+    for( cv::Size const& size : RESOLUTIONS )
+    {
+        cv::Mat frame = MakeFrame( recorded, size );
+        std::string resolution = std::to_string( size.width ) + "x" + std::to_string( size.height );
+
+        run( "cv_image_wrap", resolution, [&frame]()
+        {
+            dlib::cv_image<dlib::bgr_pixel> cimg( frame );
+            volatile long rows = cimg.nr();
+            (void)rows;
+        } );
+
+        cv::Mat gray;
+        cv::Mat scaled;
+        run( "gray_downscale", resolution, [&frame, &gray, &scaled]()
+        {
+            cv::cvtColor( frame, gray, cv::COLOR_BGR2GRAY );
+            cv::resize( gray, scaled, cv::Size( 640, 640 * gray.rows / gray.cols ), 0, 0, cv::INTER_AREA );
+        } );
+
+        FaceDetector fullDetector( 1.0 );
+        run( "face_detector_full", resolution, [&frame, &fullDetector]()
+        {
+            fullDetector.Detect( frame );
+        } );
+
+        FaceDetector scaledDetector( 0.0 );
+        run( "face_detector_scaled", resolution, [&frame, &scaledDetector]()
+        {
+            scaledDetector.Detect( frame );
+        } );
+
+        if( haveModel )
+        {
+            // Face sized for a user at arm's length, centred in the frame
+            long side = size.height / 3;
+            dlib::rectangle face = dlib::centered_rect
+                (
+                dlib::point( size.width / 2, size.height / 2 ),
+                static_cast<unsigned long>( side ),
+                static_cast<unsigned long>( side )
+                );
+            run( "shape_predictor", resolution, [&frame, &face, &landmarkModel]()
+            {
+                landmarkModel.Fit( frame, face );
+            } );
+        }
+    }
+
+    run( "eye_aspect_ratio", "-", []()
+    {
+        Eye eye( 0, 5, 3, 2, 7, 2, 10, 5, 7, 7, 3, 7 );
+        volatile double ratio = eye.AspectRatio();
+        (void)ratio;
+    } );
+
+    // Random eyes around an open eye outline, scattered by up to 8 pixels
+    cv::RNG rng( 0x424c4e4b );
+    std::vector<Eye> eyes;
+    EyeBatch batch;
+    batch.Reserve( BATCH_EYES );
+    for( std::size_t i = 0; i < BATCH_EYES; ++i )
+    {
+        eyes.push_back( Eye
+            (
+            0 + rng.uniform( -8, 9 ), 5 + rng.uniform( -8, 9 ),
+            30 + rng.uniform( -8, 9 ), 0 + rng.uniform( -8, 9 ),
+            70 + rng.uniform( -8, 9 ), 0 + rng.uniform( -8, 9 ),
+            100 + rng.uniform( -8, 9 ), 5 + rng.uniform( -8, 9 ),
+            70 + rng.uniform( -8, 9 ), 30 + rng.uniform( -8, 9 ),
+            30 + rng.uniform( -8, 9 ), 30 + rng.uniform( -8, 9 )
+            ) );
+        batch.Add( eyes.back() );
+    }
+
+    std::vector<double> ratios;
+    batch.AspectRatios( ratios );
+    for( std::size_t i = 0; i < BATCH_EYES; ++i )
+    {
+        if( ratios[i] != eyes[i].AspectRatio() )
+        {
+            std::cerr << "Batch eye aspect ratio " << ratios[i] << " of eye " << i
+                      << " differs from " << eyes[i].AspectRatio() << std::endl;
+            return 1;
+        }
+    }
+
+    std::string batchSize = std::to_string( BATCH_EYES ) + " eyes";
+    run( "eye_aspect_ratio_loop", batchSize, [&eyes, &ratios]()
+    {
+        for( std::size_t i = 0; i < eyes.size(); ++i )
+        {
+            ratios[i] = eyes[i].AspectRatio();
+        }
+    } );
+
+    run( "eye_aspect_ratio_batch", batchSize, [&batch, &ratios]()
+    {
+        batch.AspectRatios( ratios );
+    } );
+
+    boost::signals2::signal<void ()> userBlinked;
+    volatile long blinks = 0;
+    userBlinked.connect( [&blinks]() { blinks = blinks + 1; } );
+    run( "signal_dispatch", "-", [&userBlinked]()
+    {
+        userBlinked();
+    } );
+
+    if( !jsonPath.empty() )
+    {
+        WriteJson( results, jsonPath );
+    }
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+/**
+    Benchmarks face detection at several detection scales
+
+    Loads frames from a recorded video or a directory of images and runs
+    FaceDetector over every frame once per scale factor. A markdown table is
+    printed with the detection time per frame and the hit rate, which is the
+    fraction of frames where a face found at full resolution is still found
+    at the given scale. Use it to pick MonitorSettings::detectionScale for a
+    camera resolution.
+
+    Usage:
+    ./detection_scale_bench <video file | image directory> [scale ...]
+*/
+
+#include <chrono>               // std::chrono::steady_clock
+#include <cstdlib>              // atof
+#include <iomanip>              // std::setprecision
+#include <iostream>             // std::cout, std::cerr
+#include <string>               // std::string
+#include <vector>               // std::vector
+
+#include "BenchFrames.hpp"
+#include "FaceDetector.hpp"
+
+int main( int argc, char* argv[] )
+{
+    if( argc < 2 )
+    {
+        std::cerr << "Usage: " << argv[0] << " <video file | image directory> [scale ...]" << std::endl;
+        return 1;
+    }
+
+    std::vector<cv::Mat> frames = LoadFrames( argv[1] );
+    if( frames.empty() )
+    {
+        std::cerr << "No frames could be read from " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::vector<double> scales;
+    for( int i = 2; i < argc; ++i )
+    {
+        scales.push_back( atof( argv[i] ) );
+    }
+    if( scales.empty() )
+    {
+        scales = { 1.0, 0.75, 0.5, 0.33, 0.25 };
+    }
+
+    // Frames where a face is found at full resolution are the reference for hit rate
+    FaceDetector reference( 1.0 );
+    std::vector<bool> hasFace;
+    std::size_t referenceHits = 0;
+    for( cv::Mat const& frame : frames )
+    {
+        hasFace.push_back( !reference.Detect( frame ).empty() );
+        referenceHits += hasFace.back() ? 1 : 0;
+    }
+
+    std::cout << frames.size() << " frames of " << frames[0].cols << "x" << frames[0].rows
+              << ", " << referenceHits << " with a face at full resolution" << std::endl << std::endl;
+    std::cout << "| Scale | Detection size | Detection time (ms) | Hit rate |" << std::endl;
+    std::cout << "|------:|---------------:|--------------------:|---------:|" << std::endl;
+
+    for( double scale : scales )
+    {
+        FaceDetector detector( scale );
+
+        std::size_t hits = 0;
+        auto start = std::chrono::steady_clock::now();
+        for( std::size_t i = 0; i < frames.size(); ++i )
+        {
+            if( !detector.Detect( frames[i] ).empty() && hasFace[i] )
+            {
+                ++hits;
+            }
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        double usedScale = detector.ScaleFor( frames[0] );
+        std::cout << std::fixed
+                  << "| " << std::setprecision( 2 ) << usedScale
+                  << " | " << static_cast<int>( frames[0].cols * usedScale ) << "x" << static_cast<int>( frames[0].rows * usedScale )
+                  << " | " << std::setprecision( 1 ) << elapsed.count() / frames.size()
+                  << " | " << std::setprecision( 1 ) << ( referenceHits > 0 ? 100.0 * hits / referenceHits : 0.0 ) << "% |"
+                  << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+/**
+    Compares the face detector engines
+
+    Loads frames from a recorded video or a directory of images and runs
+    FaceDetector with every given engine over every frame, at the automatic
+    detection scale Monitor uses. A markdown table is printed with the mean
+    and 90th percentile detection time per frame, the CPU time per frame
+    summed over all threads, the recall, which is the fraction of faces
+    dlib's HOG detector finds at full resolution that the engine also finds,
+    and the faces found that it does not. A face counts as found when the
+    centre of each rectangle lies inside the other, since engines frame faces
+    differently. Use it to pick the cheapest engine that is accurate enough
+    for a machine, see MonitorSettings::faceDetector.
+
+    Usage:
+    ./face_detector_bench <video file | image directory> [--face-model <network file>] [engine ...]
+*/
+
+#include <algorithm>            // std::sort
+#include <chrono>               // std::chrono::steady_clock
+#include <cstring>              // strcmp
+#include <ctime>                // std::clock
+#include <iomanip>              // std::setprecision
+#include <iostream>             // std::cout, std::cerr
+#include <string>               // std::string
+#include <vector>               // std::vector
+
+#include "BenchFrames.hpp"
+#include "FaceDetector.hpp"
+
+/**
+    @return true if the centre of each face lies inside the other
+*/
+bool SameFace( dlib::rectangle const& aFirst, dlib::rectangle const& aSecond )
+{
+    return aFirst.contains( dlib::center( aSecond ) ) && aSecond.contains( dlib::center( aFirst ) );
+}
+
+/**
+    @return number of faces in aFaces that match a face in aReference
+*/
+std::size_t CountFound( std::vector<dlib::rectangle> const& aReference, std::vector<dlib::rectangle> const& aFaces )
+{
+    std::size_t found = 0;
+    for( dlib::rectangle const& reference : aReference )
+    {
+        for( dlib::rectangle const& face : aFaces )
+        {
+            if( SameFace( reference, face ) )
+            {
+                ++found;
+                break;
+            }
+        }
+    }
+    return found;
+}
+
+int main( int argc, char* argv[] )
+{
+    if( argc < 2 )
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <video file | image directory> [--face-model <network file>] [engine ...]" << std::endl;
+        return 1;
+    }
+
+    std::vector<cv::Mat> frames = LoadFrames( argv[1] );
+    if( frames.empty() )
+    {
+        std::cerr << "No frames could be read from " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::string modelPath;
+    std::vector<std::string> engines;
+    for( int i = 2; i < argc; ++i )
+    {
+        if( strcmp( argv[i], "--face-model" ) == 0 && i + 1 < argc )
+        {
+            modelPath = argv[++i];
+        }
+        else
+        {
+            engines.push_back( argv[i] );
+        }
+    }
+    if( engines.empty() )
+    {
+        engines = { "hog", "haar", "lbp" };
+        if( !modelPath.empty() )
+        {
+            engines.push_back( "dnn" );
+        }
+    }
+
+    // Faces found by dlib's detector at full resolution are the reference for recall
+    FaceDetector reference( 1.0 );
+    std::vector<std::vector<dlib::rectangle>> referenceFaces;
+    std::size_t referenceCount = 0;
+    for( cv::Mat const& frame : frames )
+    {
+        referenceFaces.push_back( reference.Detect( frame ) );
+        referenceCount += referenceFaces.back().size();
+    }
+
+    std::cout << frames.size() << " frames of " << frames[0].cols << "x" << frames[0].rows
+              << ", " << referenceCount << " faces found by hog at full resolution" << std::endl << std::endl;
+    std::cout << "| Engine | Detection time (ms) | 90th percentile (ms) | CPU time (ms) | Recall | False faces |" << std::endl;
+    std::cout << "|:-------|--------------------:|---------------------:|--------------:|-------:|------------:|" << std::endl;
+
+    for( std::string const& engine : engines )
+    {
+        FaceDetector detector( 0.0, nullptr, engine, engine == "dnn" ? modelPath : std::string() );
+        if( engine != detector.Name() )
+        {
+            continue;
+        }
+
+        // The first frame loads caches and sizes buffers, which is not part of the cost per frame
+        detector.Detect( frames[0] );
+
+        std::vector<double> frameTimes;
+        std::size_t found = 0;
+        std::size_t falseFaces = 0;
+        std::clock_t cpuStart = std::clock();
+        for( std::size_t i = 0; i < frames.size(); ++i )
+        {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<dlib::rectangle> faces = detector.Detect( frames[i] );
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            frameTimes.push_back( elapsed.count() );
+
+            found += CountFound( referenceFaces[i], faces );
+            falseFaces += faces.size() - CountFound( faces, referenceFaces[i] );
+        }
+        double cpuTime = 1000.0 * ( std::clock() - cpuStart ) / CLOCKS_PER_SEC;
+
+        double totalTime = 0.0;
+        for( double frameTime : frameTimes )
+        {
+            totalTime += frameTime;
+        }
+        std::sort( frameTimes.begin(), frameTimes.end() );
+
+        std::cout << std::fixed
+                  << "| " << engine
+                  << " | " << std::setprecision( 1 ) << totalTime / frames.size()
+                  << " | " << std::setprecision( 1 ) << frameTimes[frameTimes.size() * 9 / 10]
+                  << " | " << std::setprecision( 1 ) << cpuTime / frames.size()
+                  << " | " << std::setprecision( 1 ) << ( referenceCount > 0 ? 100.0 * found / referenceCount : 0.0 ) << "%"
+                  << " | " << falseFaces << " |"
+                  << std::endl;
+    }
+
+    return 0;
+}
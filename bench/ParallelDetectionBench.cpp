@@ -0,0 +1,109 @@
+/**
+    Benchmarks parallel face detection against the number of threads
+
+    Loads frames from a recorded video or a directory of images and runs
+    FaceDetector over every frame with a WorkerPool of each given size, one
+    thread being dlib's own single threaded detector. A markdown table is
+    printed with the detection time per frame, the speed up over one thread
+    and the number of frames where the faces found differ from those found
+    on one thread, which must be none.
+
+    Usage:
+    ./parallel_detection_bench <video file | image directory> [threads ...]
+*/
+
+#include <algorithm>            // std::max
+#include <chrono>               // std::chrono::steady_clock
+#include <cstdlib>              // atoi
+#include <iomanip>              // std::setprecision
+#include <iostream>             // std::cout, std::cerr
+#include <string>               // std::string
+#include <thread>               // std::thread::hardware_concurrency
+#include <vector>               // std::vector
+
+#include "BenchFrames.hpp"
+#include "FaceDetector.hpp"
+#include "WorkerPool.hpp"
+
+int main( int argc, char* argv[] )
+{
+    if( argc < 2 )
+    {
+        std::cerr << "Usage: " << argv[0] << " <video file | image directory> [threads ...]" << std::endl;
+        return 1;
+    }
+
+    std::vector<cv::Mat> frames = LoadFrames( argv[1] );
+    if( frames.empty() )
+    {
+        std::cerr << "No frames could be read from " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::vector<unsigned int> threadCounts;
+    for( int i = 2; i < argc; ++i )
+    {
+        threadCounts.push_back( static_cast<unsigned int>( atoi( argv[i] ) ) );
+    }
+    if( threadCounts.empty() )
+    {
+        for( unsigned int threads = 1; threads < std::thread::hardware_concurrency(); threads *= 2 )
+        {
+            threadCounts.push_back( threads );
+        }
+        threadCounts.push_back( std::max( std::thread::hardware_concurrency(), 1u ) );
+    }
+
+    // Faces found by dlib's detector on the calling thread are the reference
+    FaceDetector reference( 0.0 );
+    std::vector<std::vector<dlib::rectangle>> referenceFaces;
+    auto referenceStart = std::chrono::steady_clock::now();
+    for( cv::Mat const& frame : frames )
+    {
+        referenceFaces.push_back( reference.Detect( frame ) );
+    }
+    std::chrono::duration<double, std::milli> referenceTime = std::chrono::steady_clock::now() - referenceStart;
+    double referenceFrameTime = referenceTime.count() / frames.size();
+
+    std::cout << frames.size() << " frames of " << frames[0].cols << "x" << frames[0].rows
+              << ", detected at " << std::setprecision( 2 ) << reference.ScaleFor( frames[0] ) << " scale"
+              << std::endl << std::endl;
+    std::cout << "| Threads | Detection time (ms) | Speed up | Differing frames |" << std::endl;
+    std::cout << "|--------:|--------------------:|---------:|-----------------:|" << std::endl;
+
+    std::size_t differingFrames = 0;
+    for( unsigned int threads : threadCounts )
+    {
+        WorkerPool workers( threads );
+        workers.Start();
+        FaceDetector detector( 0.0, &workers );
+
+        std::size_t differing = 0;
+        auto start = std::chrono::steady_clock::now();
+        for( std::size_t i = 0; i < frames.size(); ++i )
+        {
+            if( detector.Detect( frames[i] ) != referenceFaces[i] )
+            {
+                ++differing;
+            }
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        workers.Stop();
+        differingFrames += differing;
+
+        double frameTime = elapsed.count() / frames.size();
+        std::cout << std::fixed
+                  << "| " << threads
+                  << " | " << std::setprecision( 1 ) << frameTime
+                  << " | " << std::setprecision( 2 ) << referenceFrameTime / frameTime << "x"
+                  << " | " << differing << " |"
+                  << std::endl;
+    }
+
+    if( differingFrames > 0 )
+    {
+        std::cerr << "Parallel detection found different faces in " << differingFrames << " frames" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -6,21 +6,50 @@
 
 #include <atomic>             // std::atomic
 #include <boost/signals2.hpp> // std::boost::signals2::connection
-
+#include <chrono>             // std::chrono::steady_clock
+#include <condition_variable> // std::condition_variable
+#include <memory>             // std::unique_ptr
+#include <mutex>              // std::mutex
+#include <string>             // std::string
+#include <thread>             // std::thread
+
+#include "BlinkStatistics.hpp"
+#include "ControlServer.hpp"
+#include "EventBus.hpp"
+#include "EventLog.hpp"
+#include "HabitScheduler.hpp"
+#include "Metrics.hpp"
+#include "MetricsExporter.hpp"
+#include "MonitorSettings.hpp"
+
+class DisplayActuator;
 class Monitor;
 class Blink;
 class Rest;
 
 /**
     Runs the application. All of the objects will be initalized in this
-    object and ensure signals, when emitted, are properly handled and
-    forwarded to the correct objects.
+    object and ensure events, when published, are properly handled and
+    forwarded to the correct objects. Every slot runs on the EventBus thread.
+
+    Given a control socket the application runs as a daemon: instead of
+    waiting for Enter it serves commands on the socket, see HandleCommand,
+    until told to stop or sent SIGTERM or SIGINT.
 */
 class App
 {
 public:
 
-    App( int aBlinkInterval, int aRestInterval, int aRestDuration );
+    App
+        (
+        int aBlinkInterval,
+        int aRestInterval,
+        int aRestDuration,
+        MonitorSettings const& aMonitorSettings = MonitorSettings(),
+        MetricsSettings const& aMetricsSettings = MetricsSettings(),
+        std::string const& aDisplayEffects = std::string(),
+        std::string const& aControlSocket = std::string()
+        );
 
     ~App();
 
@@ -38,19 +67,58 @@ private:
 
     void OnRestCancel();
 
+    void OnPaused();
+
+    void LogEvent( EventType aType, float aValue = 0.0f );
+
     void NightLight( bool aTurnOn, int aTemperature );
 
     void SendNotification( int aTimeout );
 
     void RegisterCallbacks();
 
+    std::string HandleCommand( std::string const& aCommand );
+
+    std::string Status() const;
+
+    void ApplyPause();
+
+    void WaitForStopSignal();
+
+    void StartShutdownWatchdog();
+
+    void RecordShutdownStage( char const* aStage, std::chrono::steady_clock::time_point& aStageStart );
+
+    void FinishShutdown();
+
     // Flag set to true when rest habit is being enforced
     std::atomic<bool> mResting;
+    // Flag set to true while reminders and eye tracking are paused from the control socket
+    std::atomic<bool> mPaused;
+
+    // Instrumentation shared by all objects and its exporter, null when not exported
+    Metrics mMetrics;
+    BlinkStatistics mStatistics;
+    std::unique_ptr<MetricsExporter> mMetricsExporter;
+    // Binary log of blinks, eye aspect ratios, reminders and rests, null when not logged
+    std::unique_ptr<EventLog> mEventLog;
+
+    // Delivers the events of Monitor, the habits and this object to the slots
+    EventBus mEventBus;
+    // Carries PAUSED once the habits are stopped, published on the scheduler thread
+    EventBus::ProducerId mProducer;
+    boost::signals2::connection mPausedConnection;
+
+    // Shows the night light and notifications without blocking the event bus thread
+    std::unique_ptr<DisplayActuator> mDisplayActuator;
 
     // Eye tracking objects
     std::unique_ptr<Monitor> mMonitor;
     boost::signals2::connection mUserBlinkedConnection;
 
+    // Hosts the timers of every habit on one thread
+    HabitScheduler mScheduler;
+
     // Blink habit objects
     std::unique_ptr<Blink> mBlinkHabit;
     boost::signals2::connection mBlinkReminderConnection;
@@ -60,4 +128,21 @@ private:
     std::unique_ptr<Rest> mRestHabit;
     boost::signals2::connection mRestReminderConnection;
     boost::signals2::connection mRestCancelConnection;
+
+    // Fires straight away after pause or resume to apply it on the scheduler
+    // thread, so it never races with a reminder
+    HabitScheduler::TimerId mPauseTimer;
+
+    // Serves commands in daemon mode, null otherwise
+    std::unique_ptr<ControlServer> mControlServer;
+
+    // Exits the process if shutting down takes longer than SHUTDOWN_TIMEOUT
+    std::thread mShutdownWatchdog;
+    // Time shutdown began and the time taken by each stage so far
+    std::chrono::steady_clock::time_point mShutdownStart;
+    std::string mShutdownStages;
+    // Flag set to true once shutdown has finished, and its mutex and condition variable
+    bool mShutdownDone;
+    std::mutex mShutdownMutex;
+    std::condition_variable mShutdownCondVar;
 };
\ No newline at end of file
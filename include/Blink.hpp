@@ -7,19 +7,22 @@
 
 #include <atomic>              // std::atomic
 #include <boost/signals2.hpp>  // boost::signals2::connection
-#include <condition_variable>  // std::condition_variable
-#include <mutex>               // std::mutex
-#include <thread>              // std::thread
+
+#include "EventBus.hpp"
+#include "HabitScheduler.hpp"
 
 /**
     Blink manages the habit of blinking consistently. Every mInterval seconds,
-    if the user hasn't blinked, a reminder signal will be sent.
+    if the user hasn't blinked, a reminder event will be published.
+
+    Runs on the timers of a HabitScheduler, all events are published from the
+    scheduler thread and delivered on the EventBus thread.
 */
 class Blink
 {
 public:
 
-    Blink( int aInterval );
+    Blink( HabitScheduler& aScheduler, EventBus& aEventBus, int aInterval );
 
     ~Blink() = default;
 
@@ -29,6 +32,10 @@ public:
 
     void OnUserBlinked();
 
+    int Interval() const;
+
+    void SetInterval( int aInterval );
+
     boost::signals2::connection RegisterBlinkReminder
         (
         boost::signals2::signal<void ()>::slot_type const& aSlot
@@ -41,24 +48,23 @@ public:
 
 private:
 
-    void HostHabit();
-
-    // This habit must be performed once every mInterval
-    int mInterval;
-
-    // Emitted when user needs to reminded to blink
-    boost::signals2::signal<void ()> mRemind;
-    // Emitted when user has blinked
-    boost::signals2::signal<void ()> mCancel;
-
-    // Thread to host blink habit
-    std::thread mThread;
-    // Flag set to true when application needs to exit
-    std::atomic<bool> mExitHabit;
-    // Flag set to true when user has blinked
-    std::atomic<bool> mUserBlinked;
-    // Waits mInterval before waking up to emit a signal or exit
-    std::condition_variable mCondVar;
-    // Mutex for mRestCondVar
-    std::mutex mCondVarMutex;
-};
\ No newline at end of file
+    void OnReminderDue();
+
+    void OnBlinked();
+
+    // Hosts the timers of this habit
+    HabitScheduler& mScheduler;
+
+    // This habit must be performed once every mInterval, may be changed from any thread
+    std::atomic<int> mInterval;
+
+    // Carries BLINK_REMINDER when user needs to reminded to blink and
+    // BLINK_CANCEL when user has blinked
+    EventBus& mEventBus;
+    EventBus::ProducerId mProducer;
+
+    // Fires mInterval after the last blink or reminder
+    HabitScheduler::TimerId mReminderTimer;
+    // Fires straight away after a blink to publish BLINK_CANCEL on the scheduler thread
+    HabitScheduler::TimerId mBlinkedTimer;
+};
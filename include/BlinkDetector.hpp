@@ -0,0 +1,88 @@
+/**
+    Declaration of BlinkDetector
+*/
+
+#pragma once
+
+#include <mutex>    // std::mutex
+#include <string>   // std::string
+
+/**
+    Calibration learned by BlinkDetector, can be saved and restored so a user
+    does not have to be calibrated again on every start
+*/
+struct BlinkDetectorState
+{
+    //! Mean eye aspect ratio while the eyes are open
+    double baseline = 0.0;
+    //! Variance of the eye aspect ratio while the eyes are open
+    double variance = 0.0;
+    //! Mean seconds between frames, 0 until two frames have been seen
+    double frameInterval = 0.0;
+    //! Number of open eye frames the baseline has been learned from
+    unsigned long samples = 0;
+};
+
+/**
+    Detects blinks in a stream of eye aspect ratios, one per frame.
+
+    Instead of a fixed threshold the open eye aspect ratio of the user is
+    learned as a rolling mean and variance, and the eyes count as closed when
+    the ratio falls well below it. The number of closed frames that make a
+    blink follows the measured frame rate. Every update takes constant time.
+
+    Updated from the landmark stage of Monitor, the state can be read from
+    any thread.
+*/
+class BlinkDetector
+{
+public:
+
+    BlinkDetector();
+
+    ~BlinkDetector() = default;
+
+    bool Update( double aEyeAspectRatio, double aTime );
+
+    double Threshold() const;
+
+    void SetFixedThreshold( double aThreshold );
+
+    double FixedThreshold() const;
+
+    unsigned int ConsecutiveFrames() const;
+
+    BlinkDetectorState State() const;
+
+    void Restore( BlinkDetectorState const& aState );
+
+    bool Save( std::string const& aPath ) const;
+
+    bool Load( std::string const& aPath );
+
+private:
+
+    double ThresholdLocked() const;
+
+    unsigned int ConsecutiveFramesLocked() const;
+
+    void UpdateFrameInterval( double aTime );
+
+    void UpdateBaseline( double aEyeAspectRatio );
+
+    // Learned calibration
+    BlinkDetectorState mState;
+    // Threshold used in place of the learned one, 0 to use the learned one
+    double mFixedThreshold;
+    // Flag set to true once a frame time has been seen
+    bool mHasLastTime;
+    // Time of the previous frame in seconds
+    double mLastTime;
+    // Consecutive frames the eye aspect ratio has been below the threshold
+    unsigned int mClosedFrames;
+    // Time of the first of mClosedFrames in seconds
+    double mClosedSince;
+
+    // Mutex for all detector state
+    mutable std::mutex mMutex;
+};
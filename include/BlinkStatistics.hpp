@@ -0,0 +1,131 @@
+/**
+    Declaration of BlinkStatistics
+*/
+
+#pragma once
+
+#include <array>    // std::array
+#include <atomic>   // std::atomic
+#include <chrono>   // std::chrono::steady_clock
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::int64_t, std::uint32_t
+#include <memory>   // std::unique_ptr
+#include <mutex>    // std::mutex
+
+/**
+    Blink habits over a rolling window, see BlinkStatistics::Query
+*/
+struct WindowStatistics
+{
+    //! Seconds of the window covered, less than its length until it has filled
+    double seconds = 0.0;
+    //! Blinks in the window
+    std::uint64_t blinks = 0;
+    double blinksPerMinute = 0.0;
+    //! Median and 90th percentile seconds between blinks, 0 without blinks
+    double medianInterval = 0.0;
+    double interval90 = 0.0;
+    //! Seconds the blink reminder was showing, and their share of seconds
+    double reminderSeconds = 0.0;
+    double reminderShare = 0.0;
+    //! Seconds spent resting the eyes
+    double restSeconds = 0.0;
+};
+
+/**
+    Rolling blink rate, blink interval percentiles and time under reminder
+    over the last minute, hour and day.
+
+    Each window is a ring of fixed time buckets, so memory is fixed and
+    recording an event touches one bucket per window, reusing the oldest
+    bucket when time moves on to a new one. Windows are accurate to within
+    one bucket: a second, a minute and a quarter of an hour. Bucket fields
+    are atomics, and readers check the bucket they read was not reused
+    meanwhile, so any thread can query without taking a lock or holding up
+    the threads recording events.
+*/
+class BlinkStatistics
+{
+public:
+
+    enum class Window
+    {
+        MINUTE,
+        HOUR,
+        DAY
+    };
+
+    BlinkStatistics();
+
+    ~BlinkStatistics() = default;
+
+    void OnUserBlinked();
+
+    void OnBlinkReminder();
+
+    void OnBlinkCancel();
+
+    void OnRestReminder();
+
+    void OnRestCancel();
+
+    WindowStatistics Query( Window aWindow ) const;
+
+private:
+
+    // Log spaced bins of blink intervals, a quarter octave each from 0.25 s to 64 s
+    static constexpr std::size_t INTERVAL_BINS = 32;
+
+    /**
+        Events within one bucket of time
+    */
+    struct Bucket
+    {
+        Bucket();
+
+        // Bucket number since construction this bucket holds, -1 while being reused
+        std::atomic<std::int64_t> number;
+        std::atomic<std::uint32_t> blinks;
+        std::array<std::atomic<std::uint32_t>, INTERVAL_BINS> intervals;
+        std::atomic<std::uint32_t> reminderMilliseconds;
+        std::atomic<std::uint32_t> restMilliseconds;
+    };
+
+    /**
+        Ring of buckets making up one window
+    */
+    struct Ring
+    {
+        Ring( std::int64_t aBucketMicroseconds, std::size_t aBuckets );
+
+        std::int64_t bucketMicroseconds;
+        std::size_t size;
+        std::unique_ptr<Bucket[]> buckets;
+    };
+
+    std::int64_t Now() const;
+
+    Bucket& Current( Ring& aRing, std::int64_t aTime );
+
+    void AddDuration
+        (
+        std::atomic<std::uint32_t> Bucket::*aField,
+        std::int64_t aStart,
+        std::int64_t aEnd
+        );
+
+    // Windows in the order of Window
+    std::array<Ring, 3> mRings;
+
+    // Microseconds since construction of the last blink, -1 before the first
+    std::int64_t mLastBlink;
+    // Microseconds since construction the blink reminder and the rest started, -1 when not
+    std::atomic<std::int64_t> mReminderStart;
+    std::atomic<std::int64_t> mRestStart;
+
+    // Time events are measured from
+    std::chrono::steady_clock::time_point mStart;
+
+    // Mutex for recording events, never taken by Query
+    std::mutex mRecordMutex;
+};
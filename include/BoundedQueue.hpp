@@ -0,0 +1,198 @@
+
+/**
+    Declaration and definition of BoundedQueue
+*/
+
+#pragma once
+
+#include <atomic>              // std::atomic
+#include <condition_variable>  // std::condition_variable
+#include <cstddef>             // std::size_t
+#include <deque>               // std::deque
+#include <mutex>               // std::mutex, std::unique_lock
+
+/**
+    Thread safe queue that holds at most mCapacity items. Pushing onto a full
+    queue discards the oldest item, so a slow consumer always works on the
+    most recent data instead of falling further behind the producer. A queue
+    with a capacity of one behaves as a "latest value" slot.
+*/
+template <typename T>
+class BoundedQueue
+{
+public:
+
+    BoundedQueue( std::size_t aCapacity );
+
+    ~BoundedQueue() = default;
+
+    bool Push( T aItem );
+
+    bool PushWait( T aItem );
+
+    bool Pop( T& aItem );
+
+    bool TryPop( T& aItem );
+
+    void Close();
+
+    bool Empty() const;
+
+    unsigned long Dropped() const;
+
+private:
+
+    // Maximum number of items held before the oldest is discarded
+    std::size_t mCapacity;
+    // Items waiting to be consumed, oldest at the front
+    std::deque<T> mItems;
+    // Flag set to true once no more items will be pushed
+    bool mClosed;
+    // Number of items discarded because the queue was full
+    std::atomic<unsigned long> mDropped;
+    // Wakes up consumers when an item is pushed or the queue is closed
+    std::condition_variable mCondVar;
+    // Wakes up waiting producers when an item is popped or the queue is closed
+    std::condition_variable mSpaceCondVar;
+    // Mutex for mItems, mClosed and the condition variables
+    mutable std::mutex mMutex;
+};
+
+/**
+    Constructor
+*/
+template <typename T>
+BoundedQueue<T>::BoundedQueue( std::size_t aCapacity )
+    : mCapacity( aCapacity > 0 ? aCapacity : 1 )
+    , mClosed( false )
+    , mDropped( 0 )
+{
+}
+
+/**
+    Adds an item to the back of the queue, discarding the oldest item if the
+    queue is full
+
+    @return false if the queue has been closed and the item was not added
+*/
+template <typename T>
+bool BoundedQueue<T>::Push( T aItem )
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        if( mClosed )
+        {
+            return false;
+        }
+
+        if( mItems.size() >= mCapacity )
+        {
+            mItems.pop_front();
+            ++mDropped;
+        }
+        mItems.push_back( std::move( aItem ) );
+    }
+    mCondVar.notify_one();
+    return true;
+}
+
+/**
+    Waits until the queue has space and adds an item to the back of the queue
+
+    @return false if the queue has been closed and the item was not added
+*/
+template <typename T>
+bool BoundedQueue<T>::PushWait( T aItem )
+{
+    {
+        std::unique_lock<std::mutex> lock( mMutex );
+        mSpaceCondVar.wait( lock, [this]() { return mClosed || mItems.size() < mCapacity; } );
+        if( mClosed )
+        {
+            return false;
+        }
+
+        mItems.push_back( std::move( aItem ) );
+    }
+    mCondVar.notify_one();
+    return true;
+}
+
+/**
+    Waits for an item and removes it from the front of the queue
+
+    @return false if the queue was closed and no items remain
+*/
+template <typename T>
+bool BoundedQueue<T>::Pop( T& aItem )
+{
+    {
+        std::unique_lock<std::mutex> lock( mMutex );
+        mCondVar.wait( lock, [this]() { return mClosed || !mItems.empty(); } );
+        if( mItems.empty() )
+        {
+            return false;
+        }
+
+        aItem = std::move( mItems.front() );
+        mItems.pop_front();
+    }
+    mSpaceCondVar.notify_one();
+    return true;
+}
+
+/**
+    Removes the item at the front of the queue without waiting
+
+    @return false if the queue is empty
+*/
+template <typename T>
+bool BoundedQueue<T>::TryPop( T& aItem )
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        if( mItems.empty() )
+        {
+            return false;
+        }
+
+        aItem = std::move( mItems.front() );
+        mItems.pop_front();
+    }
+    mSpaceCondVar.notify_one();
+    return true;
+}
+
+/**
+    Stops accepting new items and wakes up all waiting consumers and
+    producers. Items already in the queue can still be popped.
+*/
+template <typename T>
+void BoundedQueue<T>::Close()
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mClosed = true;
+    }
+    mCondVar.notify_all();
+    mSpaceCondVar.notify_all();
+}
+
+/**
+    @return true if no items are waiting to be popped
+*/
+template <typename T>
+bool BoundedQueue<T>::Empty() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mItems.empty();
+}
+
+/**
+    @return number of items discarded because the queue was full
+*/
+template <typename T>
+unsigned long BoundedQueue<T>::Dropped() const
+{
+    return mDropped;
+}
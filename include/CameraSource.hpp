@@ -0,0 +1,40 @@
+
+/**
+    Declaration of CameraSource
+*/
+
+#pragma once
+
+#include <chrono>                   // std::chrono::steady_clock
+#include <opencv2/videoio.hpp>      // cv::VideoCapture
+
+#include "FrameSource.hpp"
+
+/**
+    Reads frames from a live webcam
+*/
+class CameraSource : public FrameSource
+{
+public:
+
+    CameraSource( int aDevice );
+
+    ~CameraSource() = default;
+
+    bool Open() override;
+
+    void Close() override;
+
+    bool Read( Frame& aFrame ) override;
+
+    bool IsLive() const override;
+
+private:
+
+    // Index of the video device, 0 for /dev/video0
+    int mDevice;
+    // Capture device
+    cv::VideoCapture mVideoCapture;
+    // Time the device was opened, source times are measured from it
+    std::chrono::steady_clock::time_point mOpenTime;
+};
@@ -0,0 +1,41 @@
+/**
+    Declaration of CascadeFaceDetectorEngine
+*/
+
+#pragma once
+
+#include <opencv2/objdetect.hpp>    // cv::CascadeClassifier
+#include <string>                   // std::string
+
+#include "FaceDetectorEngine.hpp"
+
+/**
+    Finds faces with one of OpenCV's boosted cascades of Haar or LBP
+    features. Cascades are far cheaper than the HOG detector, LBP more so
+    than Haar, at the cost of more missed and false faces. Their faces are
+    framed a little differently from dlib's, which the landmark fit tolerates.
+*/
+class CascadeFaceDetectorEngine : public FaceDetectorEngine
+{
+public:
+
+    CascadeFaceDetectorEngine( std::string const& aName );
+
+    ~CascadeFaceDetectorEngine() = default;
+
+    bool Load( std::string const& aPath );
+
+    std::vector<dlib::rectangle> Detect( cv::Mat const& aImage ) override;
+
+    char const* Name() const override;
+
+private:
+
+    // "haar" or "lbp", which picks the cascade shipped with OpenCV that is loaded by default
+    std::string mName;
+    // Cascade of the frontal face
+    cv::CascadeClassifier mCascade;
+
+    // Reused buffer for the histogram equalised frame
+    cv::Mat mEqualized;
+};
@@ -0,0 +1,95 @@
+
+/**
+    Declaration of CompactShapePredictor
+*/
+
+#pragma once
+
+#include <cstddef>                                         // std::size_t
+#include <cstdint>                                         // std::uint32_t, std::uint64_t
+#include <dlib/image_processing/full_object_detection.h>   // dlib::full_object_detection
+#include <opencv2/core/mat.hpp>                            // cv::Mat
+#include <string>                                          // std::string
+
+/**
+    Evaluates a dlib shape predictor directly from a memory mapped cache file.
+
+    dlib deserializes a shape predictor into thousands of small heap matrices,
+    which for the 68 point model takes seconds and roughly 100 MB per process.
+    Convert flattens the regression forests of a dlib model into a single
+    cache file once. Map then maps that file read only, so loading is close to
+    free and every process on the machine shares the same physical pages.
+    Fit produces the same landmarks as dlib::shape_predictor, which
+    tests/CompactShapePredictorTest.cpp checks.
+*/
+class CompactShapePredictor
+{
+public:
+
+    CompactShapePredictor();
+
+    ~CompactShapePredictor();
+
+    CompactShapePredictor( CompactShapePredictor const& ) = delete;
+
+    CompactShapePredictor& operator=( CompactShapePredictor const& ) = delete;
+
+    static bool Convert( std::string const& aModelPath, std::string const& aCachePath );
+
+    bool Map( std::string const& aCachePath, std::string const& aModelPath );
+
+    void Unmap();
+
+    dlib::full_object_detection Fit( cv::Mat const& aImage, dlib::rectangle const& aFace ) const;
+
+    unsigned long NumParts() const;
+
+private:
+
+    /**
+        Split node of a regression tree, compares the difference of two
+        feature pixels against a threshold
+    */
+    struct Split
+    {
+        std::uint32_t idx1;
+        std::uint32_t idx2;
+        float thresh;
+    };
+
+    /**
+        Fixed size header at the start of a cache file
+    */
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t numParts;
+        std::uint32_t numCascades;
+        std::uint32_t treesPerCascade;
+        std::uint32_t splitsPerTree;
+        std::uint32_t featuresPerCascade;
+        std::uint64_t modelSize;
+        std::int64_t modelModifiedTime;
+    };
+
+    float FeaturePixel( cv::Mat const& aImage, long aX, long aY ) const;
+
+    // Start and length of the mapped cache file
+    void* mMapping;
+    std::size_t mMappingSize;
+
+    // Dimensions of the model, see Header
+    unsigned long mNumParts;
+    unsigned long mNumCascades;
+    unsigned long mTreesPerCascade;
+    unsigned long mSplitsPerTree;
+    unsigned long mFeaturesPerCascade;
+
+    // Arrays inside mMapping
+    float const* mInitialShape;
+    std::uint32_t const* mAnchorIdx;
+    float const* mDeltas;
+    Split const* mSplits;
+    float const* mLeafValues;
+};
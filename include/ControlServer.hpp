@@ -0,0 +1,70 @@
+/**
+    Declaration of ControlServer
+*/
+
+#pragma once
+
+#include <atomic>       // std::atomic
+#include <functional>   // std::function
+#include <string>       // std::string
+#include <thread>       // std::thread
+#include <vector>       // std::vector
+
+/**
+    Serves commands on a Unix domain socket so a running instance can be
+    queried and reconfigured without restarting it. Each line a client sends
+    is one command, answered with the text returned by the handler. Clients
+    may stay connected and send any number of commands. Runs on its own
+    thread, the handler is called on it.
+
+    The socket is only accessible to the user running the server.
+*/
+class ControlServer
+{
+public:
+
+    //! Answers one command, the answer ends in a line "ok" or "error <reason>"
+    typedef std::function<std::string ( std::string const& aCommand )> Handler;
+
+    ControlServer( std::string const& aSocketPath, Handler aHandler );
+
+    ~ControlServer();
+
+    bool Start();
+
+    void Stop();
+
+    std::string const& SocketPath() const;
+
+private:
+
+    /**
+        Connected client and the part of a command received so far
+    */
+    struct Client
+    {
+        int socket;
+        std::string input;
+    };
+
+    void Serve();
+
+    bool Receive( Client& aClient );
+
+    // Path of the socket
+    std::string mSocketPath;
+    // Answers commands
+    Handler mHandler;
+
+    // Listening Unix domain socket, -1 if not serving
+    int mSocket;
+    // Event used to wake up the server thread to exit
+    int mWakeEvent;
+    // Connected clients, only used on the server thread
+    std::vector<Client> mClients;
+
+    // Thread serving the socket
+    std::thread mThread;
+    // Flag set to true when the server needs to exit
+    std::atomic<bool> mExitServer;
+};
@@ -0,0 +1,117 @@
+/**
+    Declaration of CpuGovernor
+*/
+
+#pragma once
+
+#include <atomic>   // std::atomic
+#include <chrono>   // std::chrono::steady_clock
+#include <cstddef>  // std::size_t
+#include <mutex>    // std::mutex
+#include <vector>   // std::vector
+
+#include "FaceDetector.hpp"
+#include "FaceTracker.hpp"
+#include "Frame.hpp"
+#include "MonitorSettings.hpp"
+
+/**
+    Keeps eye tracking within a CPU budget and frame rate by deciding which
+    captured frames are processed.
+
+    The process CPU time is measured every control period and divided by the
+    frames processed to find the cost of a frame, which sets the frame rate
+    the budget affords. When even the lowest useful frame rate is over budget
+    each frame is made cheaper by running the face detector less often and
+    then on smaller frames, and these are undone again once there is room in
+    the budget. Frames are processed at a fraction of the afforded rate right
+    after a blink, rising to the full rate as the blink reminder comes due.
+
+    The budget is shared evenly by every camera added, and the detector
+    settings of all cameras are changed together. All methods are thread
+    safe, OnFrame is called from the capture thread of each camera.
+*/
+class CpuGovernor
+{
+public:
+
+    CpuGovernor( MonitorSettings const& aSettings );
+
+    ~CpuGovernor() = default;
+
+    void AddCamera( FaceDetector& aFaceDetector, FaceTracker& aFaceTracker );
+
+    bool Enabled() const;
+
+    bool OnFrame( std::size_t aCamera, Frame const& aFrame );
+
+    void OnUserBlinked();
+
+    void SetBlinkInterval( int aBlinkInterval );
+
+private:
+
+    void Control( std::chrono::steady_clock::time_point aNow );
+
+    bool Degrade();
+
+    bool Relax();
+
+    double TargetFrameRate( std::chrono::steady_clock::time_point aNow ) const;
+
+    /**
+        Detector settings of one camera
+    */
+    struct Camera
+    {
+        // Knobs adjusted to make each frame cheaper
+        FaceDetector* faceDetector;
+        FaceTracker* faceTracker;
+        // Scale requested by the user, restored once the budget allows
+        double configuredScale;
+        // Scale the first frame was detected at, 0 until the first frame sets it
+        double baseScale;
+        // Smallest scale detection is degraded to
+        double minScale;
+        // Frames arriving before this time are skipped
+        std::chrono::steady_clock::time_point nextFrameTime;
+    };
+
+    void ApplyScale( Camera const& aCamera );
+
+    // Cameras in the order they were added
+    std::vector<Camera> mCameras;
+
+    // Share of one core eye tracking may use, 0 for no limit
+    double mCpuBudget;
+    // Highest frame rate processed from each camera, 0 for no limit
+    double mMaxFrameRate;
+    // Seconds after a blink the user is reminded to blink, 0 if unknown
+    double mBlinkInterval;
+
+    // Detection stride requested by the user, restored once the budget allows
+    unsigned int mConfiguredStride;
+    // Current detection stride of every camera
+    unsigned int mStride;
+    // Times the detection scale of every camera was reduced by SCALE_STEP
+    unsigned int mScaleSteps;
+    // Flag set to true once the first frame started the control periods
+    bool mStarted;
+
+    // Frame rate the budget affords each camera at the current detector settings, 0 until measured
+    double mBudgetFrameRate;
+    // Frame rate last logged, to only log significant changes
+    double mLoggedFrameRate;
+
+    // Start of the current control period and process CPU time at its start
+    std::chrono::steady_clock::time_point mPeriodStart;
+    double mPeriodCpuSeconds;
+    // Frames processed by all cameras in the current control period
+    unsigned long mPeriodFrames;
+
+    // Time of the last blink
+    std::atomic<std::chrono::steady_clock::rep> mLastBlink;
+
+    // Mutex for everything but mLastBlink
+    std::mutex mMutex;
+};
@@ -0,0 +1,49 @@
+/**
+    Declaration of DBusDisplayEffects
+*/
+
+#pragma once
+
+#include "DisplayEffects.hpp"
+
+// GLib types, only defined when built with GIO
+typedef struct _GSettings GSettings;
+typedef struct _GDBusConnection GDBusConnection;
+
+/**
+    Applies display effects from within the process over D-Bus: the night
+    light through GSettings, which writes to the settings daemon's dconf
+    database, and notifications through the org.freedesktop.Notifications
+    service. Calls are sent without waiting for a reply, so no process is
+    started and no reminder waits on the desktop.
+
+    Only available when built with GIO and when the GNOME colour schema is
+    installed, see IsAvailable.
+*/
+class DBusDisplayEffects : public DisplayEffects
+{
+public:
+
+    DBusDisplayEffects();
+
+    ~DBusDisplayEffects();
+
+    DBusDisplayEffects( DBusDisplayEffects const& ) = delete;
+
+    DBusDisplayEffects& operator=( DBusDisplayEffects const& ) = delete;
+
+    bool IsAvailable() const;
+
+    void NightLight( bool aTurnOn, int aTemperature ) override;
+
+    void Notify( std::string const& aMessage, int aTimeout ) override;
+
+    char const* Name() const override;
+
+private:
+
+    // Settings of the settings daemon's colour plugin, null if not installed
+    GSettings* mColorSettings;
+    // Connection to the session bus, null if there is none
+    GDBusConnection* mSessionBus;
+};
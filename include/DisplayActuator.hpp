@@ -0,0 +1,97 @@
+/**
+    Declaration of DisplayActuator
+*/
+
+#pragma once
+
+#include <condition_variable>  // std::condition_variable
+#include <deque>               // std::deque
+#include <memory>              // std::unique_ptr
+#include <mutex>               // std::mutex
+#include <string>              // std::string
+#include <thread>              // std::thread
+
+#include "DisplayEffects.hpp"
+#include "Metrics.hpp"
+
+/**
+    Applies display effects on a thread of its own so the threads reacting to
+    the user, which only describe the night light they want, never wait on
+    the desktop.
+
+    The night light is kept as a desired state. Whenever it changes the
+    actuator waits briefly for the state to settle, then compares it with the
+    state last applied and only talks to the desktop if they differ. A burst
+    of changes therefore costs at most one update, and a change back to the
+    state already applied costs none. Notifications are events and are all
+    shown, in order.
+*/
+class DisplayActuator
+{
+public:
+
+    DisplayActuator( std::unique_ptr<DisplayEffects> aDisplayEffects, Metrics& aMetrics );
+
+    ~DisplayActuator();
+
+    void Start();
+
+    void Stop();
+
+    void NightLight( bool aTurnOn, int aTemperature );
+
+    void Notify( std::string const& aMessage, int aTimeout );
+
+    char const* Name() const;
+
+private:
+
+    /**
+        State of the night light
+    */
+    struct NightLightState
+    {
+        bool turnOn;
+        int temperature;
+    };
+
+    /**
+        Notification waiting to be shown
+    */
+    struct Notification
+    {
+        std::string message;
+        int timeout;
+    };
+
+    void Actuate();
+
+    void Apply( std::unique_lock<std::mutex>& aLock );
+
+    // Backend that changes the desktop, only used on the actuator thread
+    std::unique_ptr<DisplayEffects> mDisplayEffects;
+    // Counts applied and skipped night light changes
+    Metrics& mMetrics;
+
+    // Night light wanted by the application
+    NightLightState mTarget;
+    // Flag set to true when mTarget changed since it was last compared
+    bool mTargetChanged;
+    // Night light last applied, only valid once mHasApplied is true
+    NightLightState mApplied;
+    // Flag set to true once the night light has been set, its state is unknown before
+    bool mHasApplied;
+    // Notifications waiting to be shown, oldest first
+    std::deque<Notification> mNotifications;
+
+    // Thread applying the effects
+    std::thread mThread;
+    // Flag set to true when the actuator needs to exit
+    bool mExit;
+    // Flag set to true once the thread has exited, effects are then applied by the caller
+    bool mStopped;
+    // Wakes up the actuator when the target changes or it needs to exit
+    std::condition_variable mCondVar;
+    // Mutex for the target, applied state, notifications and mExit
+    std::mutex mMutex;
+};
@@ -0,0 +1,45 @@
+/**
+    Declaration of DisplayEffects
+*/
+
+#pragma once
+
+#include <memory>   // std::unique_ptr
+#include <string>   // std::string
+
+/**
+    Changes to the desktop used to remind the user of their eye habits: the
+    night light that tints the screen and notifications. Backends talk to the
+    desktop in process over D-Bus, run the gsettings and notify-send commands,
+    or only record the effects for tests and machines without a desktop.
+*/
+class DisplayEffects
+{
+public:
+
+    virtual ~DisplayEffects() = default;
+
+    /**
+        Switches the night light on or off
+
+        @param aTurnOn true to switch the night light on
+        @param aTemperature colour temperature in kelvin, set before switching,
+                0 or less leaves the temperature unchanged
+    */
+    virtual void NightLight( bool aTurnOn, int aTemperature ) = 0;
+
+    /**
+        Shows a critical notification
+
+        @param aMessage text of the notification
+        @param aTimeout seconds the notification is shown for
+    */
+    virtual void Notify( std::string const& aMessage, int aTimeout ) = 0;
+
+    /**
+        @return name of the backend, as accepted by Create
+    */
+    virtual char const* Name() const = 0;
+
+    static std::unique_ptr<DisplayEffects> Create( std::string const& aBackend );
+};
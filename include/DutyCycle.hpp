@@ -0,0 +1,56 @@
+/**
+    Declaration of DutyCycle
+*/
+
+#pragma once
+
+#include <chrono>   // std::chrono::steady_clock
+#include <mutex>    // std::mutex
+
+/**
+    Decides which frames of a live camera are worth processing, so the
+    detector does not run at full speed when nobody is at the desk or while
+    the user rests their eyes.
+
+    While a face is in view every frame is processed. Once no face has been
+    found for a moment the time between processed frames doubles with every
+    frame that finds none, up to a few seconds, and drops back to every frame
+    as soon as a face is found. While the user rests, frames are processed at
+    a low rate only to check the eyes are closed. After a long absence the
+    camera is to be released, see ShouldRelease. Thread safe, Admit is called
+    from the capture thread and OnFaces from the workers.
+*/
+class DutyCycle
+{
+public:
+
+    DutyCycle( bool aEnabled );
+
+    ~DutyCycle() = default;
+
+    bool Admit( std::chrono::steady_clock::time_point aNow );
+
+    void OnFaces( std::chrono::steady_clock::time_point aNow, bool aFaceFound );
+
+    void SetResting( bool aResting );
+
+    bool ShouldRelease( std::chrono::steady_clock::time_point aNow ) const;
+
+    void Wake( std::chrono::steady_clock::time_point aNow );
+
+private:
+
+    // Flag set to true for live cameras, recordings process every frame
+    bool mEnabled;
+    // Flag set to true while the user rests their eyes
+    bool mResting;
+    // Time a face was last found
+    std::chrono::steady_clock::time_point mLastFace;
+    // Time between processed frames while no face is found, zero while one is
+    std::chrono::steady_clock::duration mBackoff;
+    // Earliest time the next frame is processed
+    std::chrono::steady_clock::time_point mNextFrame;
+
+    // Mutex for all duty cycle state
+    mutable std::mutex mMutex;
+};
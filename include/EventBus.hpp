@@ -0,0 +1,117 @@
+/**
+    Declaration of EventBus
+*/
+
+#pragma once
+
+#include <array>                // std::array
+#include <atomic>               // std::atomic
+#include <boost/signals2.hpp>   // boost::signals2::signal, boost::signals2::connection
+#include <cstddef>              // std::size_t
+#include <memory>               // std::unique_ptr
+#include <thread>               // std::thread
+#include <vector>               // std::vector
+
+#include "Metrics.hpp"
+#include "SpscQueue.hpp"
+
+/**
+    Event passed from Monitor, the habits and App to the slots subscribed to it
+*/
+struct BusEvent
+{
+    enum Type
+    {
+        //! User blinked
+        USER_BLINKED,
+        //! User needs to be reminded to blink
+        BLINK_REMINDER,
+        //! User blinked after being reminded to
+        BLINK_CANCEL,
+        //! User needs to be reminded to rest, value is the rest duration in seconds
+        REST_REMINDER,
+        //! User has rested for the rest duration
+        REST_CANCEL,
+        //! Reminders and eye tracking were paused from the control socket
+        PAUSED,
+        //! Number of event types
+        TYPES
+    };
+
+    Type type;
+    int value;
+};
+
+/**
+    Carries events from the threads that produce them to the slots subscribed
+    to them, which all run on the bus's own thread. Producers never wait:
+    each has a lock free queue of its own, see SpscQueue, and the bus thread
+    is only woken through an eventfd when it is asleep. Slots therefore never
+    run on, and never hold up, the capture workers or the habit scheduler.
+
+    Events of one producer are delivered in the order they were published,
+    events of different producers in no particular order. Subscribers are
+    kept in boost::signals2 signals, so connections work as before.
+*/
+class EventBus
+{
+public:
+
+    //! Identifies a producer added with AddProducer
+    typedef std::size_t ProducerId;
+
+    EventBus( Metrics& aMetrics, std::size_t aCapacity = 256 );
+
+    ~EventBus();
+
+    EventBus( EventBus const& ) = delete;
+
+    EventBus& operator=( EventBus const& ) = delete;
+
+    ProducerId AddProducer();
+
+    void Start();
+
+    void Stop();
+
+    bool Publish( ProducerId aProducer, BusEvent::Type aType, int aValue = 0 );
+
+    boost::signals2::connection Subscribe
+        (
+        BusEvent::Type aType,
+        boost::signals2::signal<void ()>::slot_type const& aSlot
+        );
+
+    boost::signals2::connection Subscribe
+        (
+        BusEvent::Type aType,
+        boost::signals2::signal<void ( int aValue )>::slot_type const& aSlot
+        );
+
+private:
+
+    void Run();
+
+    bool Deliver();
+
+    // Counts events dropped because a producer's queue was full
+    Metrics& mMetrics;
+    // Capacity of each producer's queue
+    std::size_t mCapacity;
+
+    // Events of each producer, indexed by ProducerId, only added before Start
+    std::vector<std::unique_ptr<SpscQueue<BusEvent>>> mQueues;
+    // Slots of each event type, with and without the event value
+    std::array<boost::signals2::signal<void ()>, BusEvent::TYPES> mSignals;
+    std::array<boost::signals2::signal<void ( int aValue )>, BusEvent::TYPES> mValueSignals;
+
+    // Event used to wake up the bus thread when events arrive or to exit
+    int mWakeEvent;
+    // Flag set to true while the bus thread waits for mWakeEvent
+    std::atomic<bool> mSleeping;
+
+    // Thread running the slots
+    std::thread mThread;
+    // Flag set to true when the bus thread needs to exit
+    std::atomic<bool> mExitBus;
+};
@@ -0,0 +1,125 @@
+/**
+    Declaration of EventLog
+*/
+
+#pragma once
+
+#include <chrono>   // std::chrono::system_clock
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::uint8_t, std::uint32_t, std::uint64_t, std::int64_t
+#include <mutex>    // std::mutex
+#include <string>   // std::string
+
+/**
+    Kinds of events recorded in the event log
+*/
+enum class EventType : std::uint8_t
+{
+    //! User blinked, value is the eye aspect ratio threshold the blink crossed
+    BLINK = 1,
+    //! Mean eye aspect ratio over one second the user's eyes were tracked
+    EYE_ASPECT_RATIO = 2,
+    //! User was reminded to blink
+    BLINK_REMINDER = 3,
+    //! User was reminded to rest, value is the rest duration in seconds
+    REST_REMINDER = 4,
+    //! Rest was completed
+    REST_END = 5
+};
+
+/**
+    One event as stored in the log file
+*/
+struct EventRecord
+{
+    //! Microseconds since the Unix epoch
+    std::int64_t time;
+    //! Measurement belonging to the event, see EventType
+    float value;
+    //! EventType of the event
+    std::uint8_t type;
+    //! Zero, reserved for later use
+    std::uint8_t reserved[3];
+};
+
+/**
+    Start of every log file
+*/
+struct EventLogHeader
+{
+    //! EVENT_LOG_MAGIC
+    char magic[8];
+    //! EVENT_LOG_VERSION
+    std::uint32_t version;
+    //! sizeof( EventRecord )
+    std::uint32_t recordSize;
+    //! Records written so far, only complete records are counted
+    std::uint64_t recordCount;
+};
+
+//! Identifies event log files and their format
+constexpr char EVENT_LOG_MAGIC[8] = { 'B', 'L', 'N', 'K', 'E', 'V', 'T', '\0' };
+constexpr std::uint32_t EVENT_LOG_VERSION = 1;
+//! Bytes reserved for the header, records start after it. A multiple of
+//! every page size so record chunks can be mapped on their own.
+constexpr std::size_t EVENT_LOG_HEADER_BYTES = 65536;
+
+static_assert( sizeof( EventRecord ) == 16, "event records are 16 bytes in the file format" );
+
+/**
+    Compact, append only binary log of blink, eye aspect ratio, reminder and
+    rest events, one file per month named blinkplease-YYYY-MM.events (UTC).
+
+    The file grows in chunks of EVENT_LOG_CHUNK_BYTES that are mapped into the
+    process, so appending an event is a copy into memory and only moving on to
+    the next chunk or month makes system calls. The record count in the mapped
+    header is updated after each record, so a reader or a crash never sees a
+    partly written record. A file that cannot be opened when the month changes
+    is retried every minute until Close is called. Thread safe, see
+    EventLogReader for reading.
+*/
+class EventLog
+{
+public:
+
+    EventLog( std::string const& aDirectory );
+
+    ~EventLog();
+
+    bool Open();
+
+    void Close();
+
+    void Append( EventType aType, float aValue = 0.0f );
+
+    void Append( EventType aType, float aValue, std::chrono::system_clock::time_point aTime );
+
+    static std::string FileName( std::chrono::system_clock::time_point aTime );
+
+private:
+
+    bool OpenFile( std::chrono::system_clock::time_point aTime );
+
+    void CloseFile();
+
+    bool MapChunk( std::uint64_t aChunk );
+
+    // Directory the log files are written to
+    std::string mDirectory;
+    // Descriptor of the current month's file, -1 when closed
+    int mFd;
+    // Mapped header of the current file
+    EventLogHeader* mHeader;
+    // Mapped chunk records are appended to, and its index in the file
+    EventRecord* mChunk;
+    std::uint64_t mChunkIndex;
+    // Start of the next month, when the next file is opened
+    std::chrono::system_clock::time_point mFileEnd;
+    // Flag set to true between a successful Open and Close
+    bool mOpen;
+    // Time a file that failed to open is tried again
+    std::chrono::system_clock::time_point mRetryTime;
+
+    // Mutex for all log state
+    std::mutex mMutex;
+};
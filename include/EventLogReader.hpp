@@ -0,0 +1,47 @@
+/**
+    Declaration of EventLogReader
+*/
+
+#pragma once
+
+#include <cstddef>  // std::size_t
+#include <string>   // std::string
+
+#include "EventLog.hpp"
+
+/**
+    Maps an event log file written by EventLog read only, so months of events
+    can be scanned without copying them. Only records counted in the header
+    are exposed, so a file that is still being written can be read.
+*/
+class EventLogReader
+{
+public:
+
+    EventLogReader();
+
+    ~EventLogReader();
+
+    EventLogReader( EventLogReader const& ) = delete;
+
+    EventLogReader& operator=( EventLogReader const& ) = delete;
+
+    bool Open( std::string const& aPath );
+
+    void Close();
+
+    EventRecord const* begin() const;
+
+    EventRecord const* end() const;
+
+    std::size_t Size() const;
+
+private:
+
+    // Mapping of the whole file and its size, null when closed
+    void* mMapping;
+    std::size_t mMappingBytes;
+    // Records following the header and how many of them are complete
+    EventRecord const* mRecords;
+    std::size_t mCount;
+};
@@ -4,16 +4,29 @@
 
 #pragma once
 
-#include <vector>
+#include <array>    // std::array
+#include <cstddef>  // std::size_t
 
 /**
 	Holds points relating to an eye and provides methods for calculating
 	Eye Aspect Ratio used in determining if eye is blinking.
+
+	Points are stored inline, so an Eye never allocates and can live on the
+	stack of the landmark stage for every frame.
 */
 class Eye
 {
 public:
 
+	//! Number of landmarks outlining an eye
+	static constexpr std::size_t POINTS = 6;
+
+	//! Offsets of each eye's landmarks from the first eye landmark of a shape,
+	//! points 36-41 and 42-47 of the 68 point model, 0-5 and 6-11 of the eye model
+	typedef std::array<unsigned long, POINTS> Parts;
+	static constexpr Parts LEFT_EYE_PARTS = { { 0, 1, 2, 3, 4, 5 } };
+	static constexpr Parts RIGHT_EYE_PARTS = { { 6, 7, 8, 9, 10, 11 } };
+
 	Eye
 		(
 		int x1, int y1,
@@ -26,10 +39,37 @@ public:
 
 	~Eye() = default;
 
-	double AspectRatio();
+	/**
+		Creates an eye from the landmarks of a fitted shape
+
+		@param aShape shape with a part( i ) method returning points with x() and y()
+		@param aFirstEyePart index of the first eye landmark in aShape
+		@param aParts LEFT_EYE_PARTS or RIGHT_EYE_PARTS
+
+		@return eye outlined by the landmarks
+	*/
+	template <typename Shape>
+	static Eye FromShape( Shape const& aShape, unsigned long aFirstEyePart, Parts const& aParts )
+	{
+		return Eye
+			(
+			aShape.part( aFirstEyePart + aParts[0] ).x(), aShape.part( aFirstEyePart + aParts[0] ).y(),
+			aShape.part( aFirstEyePart + aParts[1] ).x(), aShape.part( aFirstEyePart + aParts[1] ).y(),
+			aShape.part( aFirstEyePart + aParts[2] ).x(), aShape.part( aFirstEyePart + aParts[2] ).y(),
+			aShape.part( aFirstEyePart + aParts[3] ).x(), aShape.part( aFirstEyePart + aParts[3] ).y(),
+			aShape.part( aFirstEyePart + aParts[4] ).x(), aShape.part( aFirstEyePart + aParts[4] ).y(),
+			aShape.part( aFirstEyePart + aParts[5] ).x(), aShape.part( aFirstEyePart + aParts[5] ).y()
+			);
+	}
+
+	double AspectRatio() const;
+
+	double Width() const;
 
 private:
 
+	friend class EyeBatch;
+
 	/**
 		Stores x,y coordinate for a point
 	*/
@@ -39,8 +79,8 @@ private:
 		int y;
 	};
 
-	double EuclideanDistance( int p, int q );
+	double EuclideanDistance( int p, int q ) const;
 
 	//! Stores set of points outlining the eye
-	std::vector<Point> mEyePoints;
-};
\ No newline at end of file
+	std::array<Point, POINTS> mEyePoints;
+};
@@ -0,0 +1,46 @@
+/**
+    Declaration of EyeBatch
+*/
+
+#pragma once
+
+#include <array>    // std::array
+#include <cstddef>  // std::size_t
+#include <vector>   // std::vector
+
+#include "Eye.hpp"
+
+/**
+	Computes the Eye Aspect Ratio of many eyes at once, for offline analysis
+	of recorded landmarks.
+
+	Coordinates are stored as a struct of arrays, one array per landmark and
+	axis, so the ratio of consecutive eyes is computed by a single loop with
+	no branches that the compiler can vectorise. Results are identical to
+	Eye::AspectRatio.
+*/
+class EyeBatch
+{
+public:
+
+	EyeBatch() = default;
+
+	~EyeBatch() = default;
+
+	void Reserve( std::size_t aCount );
+
+	void Clear();
+
+	void Add( Eye const& aEye );
+
+	std::size_t Size() const;
+
+	void AspectRatios( std::vector<double>& aRatios ) const;
+
+private:
+
+	//! x coordinates of each landmark, one entry per eye
+	std::array<std::vector<double>, Eye::POINTS> mX;
+	//! y coordinates of each landmark, one entry per eye
+	std::array<std::vector<double>, Eye::POINTS> mY;
+};
@@ -0,0 +1,61 @@
+
+/**
+    Declaration of FaceDetector
+*/
+
+#pragma once
+
+#include <atomic>                       // std::atomic
+#include <dlib/geometry/rectangle.h>    // dlib::rectangle
+#include <memory>                       // std::unique_ptr
+#include <opencv2/core/mat.hpp>         // cv::Mat
+#include <string>                       // std::string
+#include <vector>                       // std::vector
+
+#include "FaceDetectorEngine.hpp"
+#include "WorkerPool.hpp"
+
+/**
+    Finds faces in a frame using one of the FaceDetectorEngine engines, dlib's
+    HOG frontal face detector by default. Detection runs on a downscaled
+    single channel copy of the frame, which is far cheaper than the full size
+    colour image, and the faces found are mapped back to full resolution
+    coordinates so landmarks can still be fitted on the original frame. Given
+    a WorkerPool with more than one thread the levels of the HOG detector's
+    image pyramid are scanned in parallel, see HogPyramidDetector.
+*/
+class FaceDetector
+{
+public:
+
+    FaceDetector
+        (
+        double aScale,
+        WorkerPool* aWorkers = nullptr,
+        std::string const& aEngine = std::string(),
+        std::string const& aModelPath = std::string()
+        );
+
+    ~FaceDetector() = default;
+
+    std::vector<dlib::rectangle> Detect( cv::Mat const& aImage );
+
+    void SetScale( double aScale );
+
+    double Scale() const;
+
+    double ScaleFor( cv::Mat const& aImage ) const;
+
+    char const* Name() const;
+
+private:
+
+    // Finds the faces in the downscaled frame
+    std::unique_ptr<FaceDetectorEngine> mEngine;
+    // Factor frames are scaled by before detection, 0 scales to DEFAULT_DETECTION_WIDTH
+    std::atomic<double> mScale;
+
+    // Reused buffers for the grayscale and downscaled frame
+    cv::Mat mGray;
+    cv::Mat mScaled;
+};
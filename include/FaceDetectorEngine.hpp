@@ -0,0 +1,48 @@
+/**
+    Declaration of FaceDetectorEngine
+*/
+
+#pragma once
+
+#include <dlib/geometry/rectangle.h>    // dlib::rectangle
+#include <memory>                       // std::unique_ptr
+#include <opencv2/core/mat.hpp>         // cv::Mat
+#include <string>                       // std::string
+#include <vector>                       // std::vector
+
+#include "WorkerPool.hpp"
+
+/**
+    Finds faces in a single channel frame that FaceDetector has already
+    scaled down. Engines run dlib's HOG detector, one of the Haar or LBP
+    cascades that ship with OpenCV, or a neural network loaded with OpenCV's
+    DNN module, so each machine can use the cheapest engine that is accurate
+    enough, see face_detector_bench.
+
+    Not thread safe, every FaceDetector has its own engine.
+*/
+class FaceDetectorEngine
+{
+public:
+
+    virtual ~FaceDetectorEngine() = default;
+
+    /**
+        Detects faces in an 8 bit single channel image
+
+        @return rectangles of the faces found, in aImage coordinates
+    */
+    virtual std::vector<dlib::rectangle> Detect( cv::Mat const& aImage ) = 0;
+
+    /**
+        @return name of the engine, as accepted by Create
+    */
+    virtual char const* Name() const = 0;
+
+    static std::unique_ptr<FaceDetectorEngine> Create
+        (
+        std::string const& aEngine,
+        std::string const& aModelPath = std::string(),
+        WorkerPool* aWorkers = nullptr
+        );
+};
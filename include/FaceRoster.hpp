@@ -0,0 +1,107 @@
+/**
+    Declaration of FaceRoster
+*/
+
+#pragma once
+
+#include <cstddef>                      // std::size_t
+#include <dlib/geometry/rectangle.h>    // dlib::rectangle
+#include <map>                          // std::map
+#include <mutex>                        // std::mutex
+#include <vector>                       // std::vector
+
+#include "BlinkDetector.hpp"
+
+/**
+    Eyes of one face in one frame
+*/
+struct FaceObservation
+{
+    //! ID given to the face by FaceTracker
+    unsigned long id = 0;
+    //! Rectangle the face was found in
+    dlib::rectangle face;
+    //! Flag set to true when the eye landmarks fitted the face
+    bool fitted = false;
+    //! Eye aspect ratio averaged over both eyes, valid when fitted
+    double eyeAspectRatio = 0.0;
+    //! How well the eyes can be seen, see View
+    double quality = 0.0;
+};
+
+/**
+    Blink count of one face seen by a camera
+*/
+struct FaceStatus
+{
+    //! Camera the face is seen by
+    std::size_t camera = 0;
+    //! ID given to the face by FaceTracker, unique for each camera
+    unsigned long id = 0;
+    //! Blinks detected since the face was first seen
+    unsigned long blinks = 0;
+    //! Flag set to true for the face taken to be the user
+    bool primary = false;
+};
+
+/**
+    Keeps blink state for every face a camera sees, and picks the face that
+    is taken to be the user.
+
+    The primary face is the largest face closest to the centre of the frame.
+    Another face only takes over when it scores clearly higher, or once the
+    primary face has been out of view for a while, so a colleague walking
+    past does not interrupt the user's reminders. Every face has its own
+    BlinkDetector so each face's blinks are counted separately.
+
+    Updated by one thread at a time, Status can be called from any thread.
+*/
+class FaceRoster
+{
+public:
+
+    FaceRoster( std::size_t aCamera );
+
+    ~FaceRoster() = default;
+
+    bool Update
+        (
+        double aTime,
+        long aFrameWidth,
+        std::vector<FaceObservation> const& aFaces,
+        std::size_t& aPrimary
+        );
+
+    std::vector<FaceStatus> Status() const;
+
+    void SetFixedThreshold( double aThreshold );
+
+private:
+
+    /**
+        Blink state of one face
+    */
+    struct Face
+    {
+        // Learns the face's open eye ratio and detects its blinks
+        BlinkDetector blinkDetector;
+        // Blinks detected since the face was first seen
+        unsigned long blinks = 0;
+        // Time the face was last seen in seconds
+        double lastSeen = 0.0;
+    };
+
+    // Camera the faces are seen by
+    std::size_t mCamera;
+    // Faces seen recently, by ID
+    std::map<unsigned long, Face> mFaces;
+    // Flag set to true once a primary face has been picked
+    bool mHasPrimary;
+    // ID of the face taken to be the user
+    unsigned long mPrimaryId;
+    // Threshold every face's BlinkDetector uses in place of its learned one, 0 for none
+    double mFixedThreshold;
+
+    // Mutex for mFaces, mHasPrimary, mPrimaryId and mFixedThreshold
+    mutable std::mutex mMutex;
+};
@@ -0,0 +1,100 @@
+
+/**
+    Declaration of FaceTracker
+*/
+
+#pragma once
+
+#include <atomic>                                         // std::atomic
+#include <dlib/geometry/rectangle.h>                      // dlib::rectangle
+#include <dlib/image_processing/full_object_detection.h>  // dlib::full_object_detection
+#include <mutex>                                          // std::mutex
+#include <vector>                                         // std::vector
+
+/**
+    Follows the faces in view between frames so the full frame face detector
+    does not have to run on every frame. After faces are detected their
+    rectangles are moved along with the fitted eye landmarks, and the
+    detector is only needed again every mDetectionStride frames or when the
+    landmark fit of any face degrades.
+
+    Every face gets an ID that stays the same while it is tracked and across
+    detections, as long as it overlaps where it was last seen. A face the
+    detector misses keeps its ID for a few detections.
+
+    Shared between the detection and landmark stages of Monitor, all methods
+    are thread safe.
+*/
+class FaceTracker
+{
+public:
+
+    FaceTracker( unsigned int aDetectionStride );
+
+    ~FaceTracker() = default;
+
+    bool TrackedFaces
+        (
+        std::vector<dlib::rectangle>& aFaces,
+        std::vector<unsigned long>& aFaceIds
+        );
+
+    void OnFacesDetected
+        (
+        unsigned long aSequence,
+        std::vector<dlib::rectangle> const& aFaces,
+        std::vector<unsigned long>& aFaceIds
+        );
+
+    bool OnLandmarksFitted
+        (
+        unsigned long aSequence,
+        unsigned long aFaceId,
+        dlib::rectangle const& aFace,
+        dlib::full_object_detection const& aShape,
+        unsigned long aFirstEyePart
+        );
+
+    void SetDetectionStride( unsigned int aDetectionStride );
+
+    unsigned int DetectionStride() const;
+
+private:
+
+    /**
+        Face followed between frames
+    */
+    struct Face
+    {
+        // Stable ID of the face
+        unsigned long id;
+        // Current estimate of the face rectangle
+        dlib::rectangle rectangle;
+        // Detections in a row the face was not found in, 0 while in view
+        unsigned int missedDetections;
+        // Flag set to true once the eye geometry of the detected face has been measured
+        bool hasReference;
+        // Distance between outer eye corners relative to the face width at detection
+        double referenceSpan;
+        // Offset of the eye centre from the face centre relative to the face width
+        double referenceOffsetX;
+        double referenceOffsetY;
+    };
+
+    // Full frame detection is forced at least once every mDetectionStride frames
+    std::atomic<unsigned int> mDetectionStride;
+
+    // Flag set to true while mFaces can be used instead of running the detector
+    bool mTracking;
+    // Faces in view, and faces recently missed by the detector
+    std::vector<Face> mFaces;
+    // ID given to the next new face
+    unsigned long mNextFaceId;
+    // Frames handed out from mFaces since the detector last ran
+    unsigned int mFramesSinceDetection;
+    // Sequence of the frame the detector last ran on, older landmark fits are ignored
+    unsigned long mDetectionSequence;
+
+    // Mutex for all tracking state
+    std::mutex mMutex;
+};
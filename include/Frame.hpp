@@ -0,0 +1,36 @@
+
+/**
+    Declaration of Frame
+*/
+
+#pragma once
+
+#include <chrono>                          // std::chrono::steady_clock
+#include <dlib/geometry/rectangle.h>       // dlib::rectangle
+#include <opencv2/core/mat.hpp>            // cv::Mat
+#include <vector>                          // std::vector
+
+#include "FramePool.hpp"
+
+/**
+    Single captured video frame as it travels through the stages of the eye
+    tracking pipeline. Each stage fills in its results before handing the
+    frame to the next stage.
+*/
+struct Frame
+{
+    //! Pooled pixel buffer image is read into, returned to the pool with the frame
+    FrameBuffer buffer;
+    //! Image as delivered by the frame source, colour or intensity only
+    cv::Mat image;
+    //! Faces found in image by the detection stage, allocated for each frame
+    std::vector<dlib::rectangle> faces;
+    //! ID of each of faces, stable while FaceTracker follows the face
+    std::vector<unsigned long> faceIds;
+    //! Time the image was read from the frame source
+    std::chrono::steady_clock::time_point captureTime;
+    //! Seconds since the start of the recording, or since the camera opened
+    double sourceTime = 0.0;
+    //! Increments by one for every frame read from the frame source
+    unsigned long sequence = 0;
+};
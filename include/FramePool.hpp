@@ -0,0 +1,92 @@
+/**
+    Declaration of FramePool
+*/
+
+#pragma once
+
+#include <condition_variable>   // std::condition_variable
+#include <cstddef>              // std::size_t
+#include <mutex>                // std::mutex
+#include <opencv2/core/mat.hpp> // cv::Mat
+#include <vector>               // std::vector
+
+class FramePool;
+
+/**
+    Lease on one image buffer of a FramePool, returned to the pool when the
+    lease is destroyed. Move only.
+*/
+class FrameBuffer
+{
+public:
+
+    FrameBuffer();
+
+    FrameBuffer( FrameBuffer&& aOther );
+
+    FrameBuffer& operator=( FrameBuffer&& aOther );
+
+    FrameBuffer( FrameBuffer const& ) = delete;
+
+    FrameBuffer& operator=( FrameBuffer const& ) = delete;
+
+    ~FrameBuffer();
+
+    explicit operator bool() const;
+
+    cv::Mat& Image();
+
+private:
+
+    friend class FramePool;
+
+    FrameBuffer( FramePool* aPool, std::size_t aSlot );
+
+    void Release();
+
+    // Pool the buffer belongs to, null for an empty lease
+    FramePool* mPool;
+    // Index of the buffer in the pool
+    std::size_t mSlot;
+};
+
+/**
+    Fixed set of image buffers reused for every frame of a camera, so once the
+    buffers have grown to the frame size webcams and videos read their pixels
+    without allocating. Only the pixels are pooled: image directories decode
+    each file into a new image, and the faces, landmarks and detector results
+    of a frame are still allocated as it is processed.
+
+    Monitor reads each frame into a leased buffer, and the lease travels with
+    the frame until it is processed or dropped. Thread safe.
+*/
+class FramePool
+{
+public:
+
+    FramePool( std::size_t aBuffers );
+
+    ~FramePool() = default;
+
+    FrameBuffer Acquire();
+
+    void Close();
+
+private:
+
+    friend class FrameBuffer;
+
+    void Release( std::size_t aSlot );
+
+    // Buffers of the pool, their data is kept between leases
+    std::vector<cv::Mat> mImages;
+    // Flag set to true for every buffer that is leased out
+    std::vector<bool> mLeased;
+    // Flag set to true once Acquire should stop waiting
+    bool mClosed;
+
+    // Wakes up Acquire when a buffer is returned or the pool closes
+    std::condition_variable mCondVar;
+    // Mutex for mLeased and mClosed
+    std::mutex mMutex;
+};
@@ -0,0 +1,55 @@
+
+/**
+    Declaration of FrameSource
+*/
+
+#pragma once
+
+#include <memory>   // std::unique_ptr
+#include <string>   // std::string
+
+#include "Frame.hpp"
+
+/**
+    Supplies the frames Monitor tracks the eyes in. Backends read from a live
+    camera, a recorded video file or a directory of images, so the whole blink
+    pipeline can be run on recorded sessions without a webcam.
+*/
+class FrameSource
+{
+public:
+
+    virtual ~FrameSource() = default;
+
+    /**
+        Opens the underlying device or file
+
+        @return false if the source cannot deliver frames
+    */
+    virtual bool Open() = 0;
+
+    /**
+        Releases the underlying device or file
+    */
+    virtual void Close() = 0;
+
+    /**
+        Reads the next frame, filling in the image and source time
+
+        @return false at the end of a recording or when the device fails
+    */
+    virtual bool Read( Frame& aFrame ) = 0;
+
+    /**
+        @return true if frames arrive in real time from a device, false if
+                they are read from a recording
+    */
+    virtual bool IsLive() const = 0;
+
+    static std::unique_ptr<FrameSource> Create
+        (
+        std::string const& aLocation,
+        double aFrameRate,
+        bool aLumaCapture = false
+        );
+};
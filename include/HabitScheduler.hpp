@@ -0,0 +1,86 @@
+/**
+    Declaration of HabitScheduler
+*/
+
+#pragma once
+
+#include <atomic>       // std::atomic
+#include <chrono>       // std::chrono::steady_clock
+#include <cstddef>      // std::size_t
+#include <functional>   // std::function
+#include <mutex>        // std::mutex
+#include <thread>       // std::thread
+#include <vector>       // std::vector
+
+/**
+    Single event loop thread hosting the timers of every habit, so adding a
+    habit does not add a thread.
+
+    Each timer holds one deadline and a callback run on the scheduler thread
+    when the deadline passes. A kernel timerfd is armed for the earliest
+    deadline only. Moving a timer's deadline later, as happens when the user
+    blinks, only stores the new deadline; the loop finds it when the earlier
+    deadline fires and re-arms for it. Callbacks run one at a time in deadline
+    order, so habits never race with themselves. A timer cancelled or
+    rescheduled after it fell due but before its callback ran is skipped.
+*/
+class HabitScheduler
+{
+public:
+
+    //! Identifies a timer created with AddTimer
+    typedef std::size_t TimerId;
+
+    HabitScheduler();
+
+    ~HabitScheduler();
+
+    HabitScheduler( HabitScheduler const& ) = delete;
+
+    HabitScheduler& operator=( HabitScheduler const& ) = delete;
+
+    void Start();
+
+    void Stop();
+
+    TimerId AddTimer( std::function<void ()> aCallback );
+
+    void Schedule( TimerId aTimer, std::chrono::steady_clock::duration aDelay );
+
+    void Cancel( TimerId aTimer );
+
+private:
+
+    /**
+        Deadline and callback of a timer
+    */
+    struct Timer
+    {
+        std::function<void ()> callback;
+        std::chrono::steady_clock::time_point deadline;
+        bool armed;
+        // Counts Schedule and Cancel calls, so a due callback can tell it was superseded
+        unsigned long generation;
+    };
+
+    void Run();
+
+    void Arm( std::chrono::steady_clock::time_point aDeadline );
+
+    // Every timer added, indexed by TimerId
+    std::vector<Timer> mTimers;
+    // Deadline the timerfd is armed for, time_point::max() when disarmed
+    std::chrono::steady_clock::time_point mArmedDeadline;
+
+    // Kernel timer expiring at mArmedDeadline
+    int mTimer;
+    // Event used to wake up the scheduler thread to exit
+    int mWakeEvent;
+
+    // Thread running the timer callbacks
+    std::thread mThread;
+    // Flag set to true when the scheduler needs to exit
+    std::atomic<bool> mExitScheduler;
+    // Mutex for mTimers and mArmedDeadline
+    std::mutex mMutex;
+};
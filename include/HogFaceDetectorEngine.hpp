@@ -0,0 +1,38 @@
+/**
+    Declaration of HogFaceDetectorEngine
+*/
+
+#pragma once
+
+#include <dlib/image_processing/frontal_face_detector.h>    // dlib::frontal_face_detector
+#include <memory>                                           // std::unique_ptr
+
+#include "FaceDetectorEngine.hpp"
+#include "HogPyramidDetector.hpp"
+#include "WorkerPool.hpp"
+
+/**
+    Finds faces with dlib's HOG frontal face detector, the detector the shape
+    predictors were trained on. Given a WorkerPool with more than one thread
+    the levels of the detector's image pyramid are scanned in parallel, see
+    HogPyramidDetector.
+*/
+class HogFaceDetectorEngine : public FaceDetectorEngine
+{
+public:
+
+    HogFaceDetectorEngine( WorkerPool* aWorkers = nullptr );
+
+    ~HogFaceDetectorEngine() = default;
+
+    std::vector<dlib::rectangle> Detect( cv::Mat const& aImage ) override;
+
+    char const* Name() const override;
+
+private:
+
+    // dlib HOG face detector
+    dlib::frontal_face_detector mDetector;
+    // Runs mDetector on several threads, null to run it on the calling thread
+    std::unique_ptr<HogPyramidDetector> mPyramidDetector;
+};
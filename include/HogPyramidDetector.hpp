@@ -0,0 +1,65 @@
+/**
+    Declaration of HogPyramidDetector
+*/
+
+#pragma once
+
+#include <cstddef>                                          // std::size_t
+#include <dlib/array2d.h>                                   // dlib::array2d
+#include <dlib/image_processing/frontal_face_detector.h>    // dlib::frontal_face_detector
+#include <dlib/image_transforms/image_pyramid.h>            // dlib::pyramid_down
+#include <dlib/opencv.h>                                    // dlib::cv_image
+#include <memory>                                           // std::unique_ptr
+#include <utility>                                          // std::pair
+#include <vector>                                           // std::vector
+
+#include "WorkerPool.hpp"
+
+/**
+    Runs dlib's HOG frontal face detector with its image pyramid spread over
+    the threads of a WorkerPool.
+
+    dlib scans a pyramid of the image, each level 5/6 the size of the one
+    before, with every filter of the detector on a single thread, and then
+    keeps the highest scoring of any overlapping detections. Here the pyramid
+    images are built the same way, HOG features are extracted and scanned on
+    all levels in parallel, and the detections are merged with the same non-max
+    suppression, so the faces found are those dlib finds. The first level is
+    about a third of the work, which limits the speed up to about three.
+
+    Not thread safe, every HogFaceDetectorEngine has its own.
+*/
+class HogPyramidDetector
+{
+public:
+
+    HogPyramidDetector( dlib::frontal_face_detector const& aDetector, WorkerPool& aWorkers );
+
+    ~HogPyramidDetector() = default;
+
+    std::vector<dlib::rectangle> Detect( dlib::cv_image<unsigned char> const& aImage );
+
+private:
+
+    typedef dlib::frontal_face_detector::image_scanner_type Scanner;
+    typedef dlib::pyramid_down<6> Pyramid;
+    typedef std::vector<std::pair<double, dlib::rectangle>> Detections;
+
+    std::size_t PyramidLevels( dlib::cv_image<unsigned char> const& aImage ) const;
+
+    // Detector whose filters and overlap test are used
+    dlib::frontal_face_detector const& mDetector;
+    // Threads the pyramid levels are scanned on
+    WorkerPool& mWorkers;
+
+    // Filters of the detector prepared for scanning, and the score each must reach
+    std::vector<Scanner::fhog_filterbank> mFilterbanks;
+    std::vector<double> mThresholds;
+
+    // Reused between frames: images of the pyramid levels below the first,
+    // a scanner of a single level for each level, and the detections of each
+    // filter on each level
+    std::vector<std::unique_ptr<dlib::array2d<unsigned char>>> mLevelImages;
+    std::vector<std::unique_ptr<Scanner>> mScanners;
+    std::vector<std::vector<Detections>> mDetections;
+};
@@ -0,0 +1,42 @@
+
+/**
+    Declaration of ImageDirectorySource
+*/
+
+#pragma once
+
+#include <string>   // std::string
+#include <vector>   // std::vector
+
+#include "FrameSource.hpp"
+
+/**
+    Reads frames from a directory of images, in file name order
+*/
+class ImageDirectorySource : public FrameSource
+{
+public:
+
+    ImageDirectorySource( std::string const& aDirectory, double aFrameRate );
+
+    ~ImageDirectorySource() = default;
+
+    bool Open() override;
+
+    void Close() override;
+
+    bool Read( Frame& aFrame ) override;
+
+    bool IsLive() const override;
+
+private:
+
+    // Directory holding the images
+    std::string mDirectory;
+    // Rate the images were recorded at
+    double mFrameRate;
+    // Image files in file name order
+    std::vector<std::string> mFiles;
+    // Index of the next file to read
+    std::size_t mNextFile;
+};
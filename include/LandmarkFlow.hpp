@@ -0,0 +1,73 @@
+/**
+    Declaration of LandmarkFlow
+*/
+
+#pragma once
+
+#include <dlib/image_processing.h>  // dlib::full_object_detection
+#include <map>                      // std::map
+#include <opencv2/core/mat.hpp>     // cv::Mat
+#include <vector>                   // std::vector
+
+/**
+    Follows the twelve eye landmarks of every face a camera sees from frame to
+    frame with sparse pyramidal Lucas-Kanade optical flow, so the shape
+    predictor only has to run on some frames.
+
+    The predictor anchors a face's landmarks at least every interval frames.
+    In between, the landmarks of the previous frame are flowed forward into
+    the current frame and back again, and the flow is only used when every
+    point returns close to where it started. Flow that fails this check, or
+    that moves the eyelids far from the anchored eye aspect ratio as at the
+    start of a blink, is handed back to the predictor, which anchors again.
+
+    BeginFrame and EndFrame are called on one thread around each frame, Track,
+    Anchor and Forget may be called in parallel for different faces in between.
+*/
+class LandmarkFlow
+{
+public:
+
+    LandmarkFlow( unsigned int aInterval );
+
+    ~LandmarkFlow() = default;
+
+    bool Enabled() const;
+
+    void BeginFrame( cv::Mat const& aImage, std::vector<unsigned long> const& aFaceIds );
+
+    bool Track( unsigned long aFaceId, unsigned long aFirstEyePart, dlib::full_object_detection& aShape );
+
+    void Anchor( unsigned long aFaceId, unsigned long aFirstEyePart, dlib::full_object_detection const& aShape );
+
+    void Forget( unsigned long aFaceId );
+
+    void EndFrame();
+
+private:
+
+    /**
+        Landmarks of one face as of the previous frame
+    */
+    struct Face
+    {
+        // Shape last fitted or flowed, its eye landmarks replaced by the flowed points
+        dlib::full_object_detection shape;
+        // Eye landmarks with sub pixel precision, in the order of the shape
+        std::vector<cv::Point2f> eyePoints;
+        // Eye aspect ratio of the last fitted shape
+        double anchorEyeAspectRatio = 0.0;
+        // Frames flowed since the predictor last fitted the landmarks
+        unsigned int framesSinceAnchor = 0;
+        // Flag set to true while the landmarks may be flowed into the next frame
+        bool valid = false;
+    };
+
+    // The predictor runs at least once every mInterval frames, 1 or less disables flow
+    unsigned int mInterval;
+    // Image pyramids of the previous and the current frame
+    std::vector<cv::Mat> mPrevious;
+    std::vector<cv::Mat> mCurrent;
+    // Landmarks of every face in view by face ID, see FaceTracker
+    std::map<unsigned long, Face> mFaces;
+};
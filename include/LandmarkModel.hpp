@@ -0,0 +1,56 @@
+
+/**
+    Declaration of LandmarkModel
+*/
+
+#pragma once
+
+#include <string>   // std::string
+
+#include "CompactShapePredictor.hpp"
+
+/**
+    Shape predictor used to fit eye landmarks onto a detected face. Both the
+    full 68 point face model and the smaller eye only model produced by
+    train_eye_model are supported, the position of the twelve eye landmarks
+    in the fitted shape is given by FirstEyePart.
+
+    The dlib model is converted into a CompactShapePredictor cache on first
+    use and the cache is memory mapped on every later load.
+*/
+class LandmarkModel
+{
+public:
+
+    LandmarkModel();
+
+    ~LandmarkModel() = default;
+
+    bool Load( std::string const& aPath );
+
+    dlib::full_object_detection Fit( cv::Mat const& aImage, dlib::rectangle const& aFace ) const;
+
+    unsigned long FirstEyePart() const;
+
+    unsigned long NumParts() const;
+
+    std::string const& Path() const;
+
+    double LoadMilliseconds() const;
+
+    bool LoadedFromCache() const;
+
+private:
+
+    // Evaluates the model from the mapped cache file
+    CompactShapePredictor mPredictor;
+    // Index of the first eye landmark, the twelve eye landmarks are consecutive
+    unsigned long mFirstEyePart;
+
+    // Resolved path of the loaded dlib model
+    std::string mPath;
+    // Time the last successful Load took
+    double mLoadMilliseconds;
+    // Flag set to true when the last Load mapped an existing cache
+    bool mLoadedFromCache;
+};
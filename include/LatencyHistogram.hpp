@@ -0,0 +1,48 @@
+
+/**
+    Declaration of LatencyHistogram
+*/
+
+#pragma once
+
+#include <array>    // std::array
+#include <atomic>   // std::atomic
+#include <chrono>   // std::chrono::steady_clock
+#include <cstdint>  // std::uint64_t
+#include <ostream>  // std::ostream
+#include <string>   // std::string
+
+/**
+    Histogram of durations with fixed, doubling bucket bounds from 250 us to
+    about 4 s. Recording only increments atomics, so any thread can record
+    from the hot path without taking a lock while another thread exports.
+*/
+class LatencyHistogram
+{
+public:
+
+    // Upper bounds of the buckets in microseconds, a final bucket catches the rest
+    static constexpr std::size_t BUCKETS = 15;
+
+    LatencyHistogram();
+
+    ~LatencyHistogram() = default;
+
+    void Record( std::chrono::steady_clock::duration aDuration );
+
+    void WritePrometheus
+        (
+        std::ostream& aOut,
+        std::string const& aName,
+        std::string const& aHelp
+        ) const;
+
+    double MeanSeconds() const;
+
+private:
+
+    // Number of durations within each bucket, the last bucket has no upper bound
+    std::array<std::atomic<std::uint64_t>, BUCKETS + 1> mCounts;
+    // Sum of all recorded durations in microseconds
+    std::atomic<std::uint64_t> mSumMicroseconds;
+};
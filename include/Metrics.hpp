@@ -0,0 +1,65 @@
+
+/**
+    Declaration of Metrics
+*/
+
+#pragma once
+
+#include <atomic>   // std::atomic
+#include <cstdint>  // std::uint64_t
+#include <ostream>  // std::ostream
+
+#include "LatencyHistogram.hpp"
+
+/**
+    Always on instrumentation of the eye tracking pipeline and the habits.
+    Every field is updated with relaxed atomics so the capture, detection
+    and landmark threads never take a lock to record into it.
+*/
+struct Metrics
+{
+    Metrics();
+
+    void WritePrometheus( std::ostream& aOut ) const;
+
+    //! Time spent running the full frame face detector
+    LatencyHistogram detectTime;
+    //! Time spent fitting landmarks to a face
+    LatencyHistogram landmarkTime;
+    //! Time from reading a frame to finishing its eye aspect ratio
+    LatencyHistogram frameLatency;
+
+    //! Frames read from the frame source
+    std::atomic<std::uint64_t> framesCaptured;
+    //! Frames discarded by the pipeline queues because a later stage was busy
+    std::atomic<std::uint64_t> framesDropped;
+    //! Frames skipped by the CPU governor to stay within the CPU budget
+    std::atomic<std::uint64_t> framesSkipped;
+    //! Frames not processed because nobody was in view or the user was resting
+    std::atomic<std::uint64_t> framesBackedOff;
+    //! Frames where the tracked face was reused instead of running the detector
+    std::atomic<std::uint64_t> framesTracked;
+    //! Faces whose eye landmarks were flowed from the previous frame instead of fitted
+    std::atomic<std::uint64_t> landmarksFlowed;
+    //! Frames that reached the landmark stage without a face
+    std::atomic<std::uint64_t> framesNoFace;
+    //! Frames that reached the landmark stage with more than one face
+    std::atomic<std::uint64_t> framesMultipleFaces;
+    //! Blinks detected
+    std::atomic<std::uint64_t> blinks;
+    //! Reminders to blink
+    std::atomic<std::uint64_t> blinkReminders;
+    //! Reminders to rest
+    std::atomic<std::uint64_t> restReminders;
+    //! Checks of the eyes during rests, and how many found them closed
+    std::atomic<std::uint64_t> restChecks;
+    std::atomic<std::uint64_t> restChecksEyesClosed;
+    //! Times a camera was released because nobody was in view
+    std::atomic<std::uint64_t> cameraReleases;
+    //! Events dropped because the event bus queue of their producer was full
+    std::atomic<std::uint64_t> eventsDropped;
+    //! Night light changes applied to the desktop
+    std::atomic<std::uint64_t> nightLightChanges;
+    //! Night light changes not applied because the night light was already in that state
+    std::atomic<std::uint64_t> nightLightSkipped;
+};
@@ -0,0 +1,77 @@
+
+/**
+    Declaration of MetricsExporter
+*/
+
+#pragma once
+
+#include <atomic>   // std::atomic
+#include <string>   // std::string
+#include <thread>   // std::thread
+
+#include "BlinkStatistics.hpp"
+#include "Metrics.hpp"
+
+/**
+    Where and how often metrics are exported, and where events are logged
+*/
+struct MetricsSettings
+{
+    //! Unix domain socket serving the metrics to every client that connects, empty to disable
+    std::string socketPath;
+    //! File the metrics are written to every intervalSeconds, empty to disable
+    std::string filePath;
+    //! Seconds between writes of filePath
+    int intervalSeconds = 10;
+    //! Directory blink, eye aspect ratio and reminder events are logged to, see EventLog, empty to disable
+    std::string eventLogDirectory;
+};
+
+/**
+    Exports Metrics in the Prometheus text format. Clients connecting to the
+    Unix domain socket are sent the current metrics, and the metrics file is
+    rewritten atomically every interval. Runs on its own thread so exporting
+    never delays the eye tracking pipeline.
+*/
+class MetricsExporter
+{
+public:
+
+    MetricsExporter
+        (
+        Metrics const& aMetrics,
+        BlinkStatistics const& aStatistics,
+        MetricsSettings const& aSettings
+        );
+
+    ~MetricsExporter();
+
+    void Start();
+
+    void Stop();
+
+private:
+
+    void Export();
+
+    std::string Render() const;
+
+    void WriteFile( std::string const& aText );
+
+    // Metrics being exported
+    Metrics const& mMetrics;
+    // Rolling blink statistics exported as gauges
+    BlinkStatistics const& mStatistics;
+    // Export destinations and interval
+    MetricsSettings mSettings;
+
+    // Listening Unix domain socket, -1 if not serving
+    int mSocket;
+    // Event used to wake up the export thread to exit
+    int mWakeEvent;
+
+    // Thread serving the socket and writing the file
+    std::thread mThread;
+    // Flag set to true when the exporter needs to exit
+    std::atomic<bool> mExitExporter;
+};
@@ -7,19 +7,62 @@
 
 #include <atomic>               // std::atomic
 #include <boost/signals2.hpp>   // std::boost::signals2::connection
+#include <chrono>               // std::chrono::steady_clock
 #include <condition_variable>   // std::condition_variable
+#include <cstddef>              // std::size_t
+#include <future>               // std::shared_future
+#include <memory>               // std::unique_ptr
 #include <mutex>                // std::mutex
+#include <string>               // std::string
 #include <thread>               // std::thread
+#include <vector>               // std::vector
+
+#include "BlinkDetector.hpp"
+#include "BoundedQueue.hpp"
+#include "CpuGovernor.hpp"
+#include "DutyCycle.hpp"
+#include "EventBus.hpp"
+#include "EventLog.hpp"
+#include "FaceDetector.hpp"
+#include "FaceRoster.hpp"
+#include "FaceTracker.hpp"
+#include "Frame.hpp"
+#include "FramePool.hpp"
+#include "FrameSource.hpp"
+#include "LandmarkFlow.hpp"
+#include "LandmarkModel.hpp"
+#include "Metrics.hpp"
+#include "MonitorSettings.hpp"
+#include "ViewSelector.hpp"
+#include "WorkerPool.hpp"
 
 /**
     Class to monitor the eyes. This class will track the
-    eyes and emit a signal when the user blinks.
+    eyes and publish an event when the user blinks.
+
+    Any number of cameras can watch the user. Each camera has a thread
+    grabbing frames, since reading a frame blocks, and a bounded queue that
+    drops the oldest frame when full so processing always works on the
+    freshest frame available. Detecting faces and fitting landmarks to
+    calculate the eye aspect ratio runs on a worker pool shared by all
+    cameras, with at most one worker processing the frames of a camera at a
+    time. Every face in view is tracked and has its blinks counted, but only
+    the face taken to be the user, see FaceRoster, is used for reminders.
+    When several cameras see the user the view with the best look at the
+    eyes is picked for each time slot, see ViewSelector, and only those views
+    are used to detect the user's blinks.
 */
 class Monitor
 {
 public:
 
-    Monitor();
+    Monitor
+        (
+        Metrics& aMetrics,
+        EventBus& aEventBus,
+        MonitorSettings const& aSettings = MonitorSettings(),
+        EventLog* aEventLog = nullptr
+        );
 
     ~Monitor() = default;
 
@@ -27,6 +70,28 @@ public:
 
     void Stop();
 
+    void WaitUntilFinished();
+
+    bool IsLive() const;
+
+    void Pause();
+
+    void Resume();
+
+    bool IsPaused() const;
+
+    void OnRestStarted();
+
+    void OnRestEnded();
+
+    void SetBlinkInterval( int aBlinkInterval );
+
+    void SetBlinkThreshold( double aThreshold );
+
+    BlinkDetector const& Calibration() const;
+
+    std::vector<FaceStatus> Faces() const;
+
     boost::signals2::connection RegisterUserBlinked
         (
         boost::signals2::signal<void ()>::slot_type const& aSlot
@@ -34,19 +99,127 @@ public:
 
 private:
 
-    void TrackEyes();
+    /**
+        Frame source of one camera and the state tracking the face it sees
+    */
+    struct Camera
+    {
+        Camera
+            (
+            std::size_t aIndex,
+            std::string const& aFrameSource,
+            MonitorSettings const& aSettings,
+            WorkerPool& aWorkers
+            );
+
+        // Position in mCameras, used to tell views and governed frames apart
+        std::size_t index;
+        // Supplies frames from a webcam or a recording
+        std::unique_ptr<FrameSource> frameSource;
+        // Finds faces on a downscaled grayscale copy of each frame, on the workers
+        FaceDetector faceDetector;
+        // Follows the faces between frames so the detector does not run on every frame
+        FaceTracker faceTracker;
+        // Follows the eye landmarks between frames so the predictor does not run on every frame
+        LandmarkFlow landmarkFlow;
+        // Counts the blinks of every face and picks the face taken to be the user
+        FaceRoster faceRoster;
+        // Eyes of each face of the frame being processed, kept to reuse its capacity
+        std::vector<FaceObservation> observations;
+        // Processes fewer frames while nobody is in view or the user rests
+        DutyCycle dutyCycle;
+        // Buffers frames are read into, declared before capturedFrames so
+        // queued frames are returned before the pool is destroyed
+        FramePool framePool;
+        // Frames read from the camera waiting for a worker, only the latest is kept
+        BoundedQueue<Frame> capturedFrames;
+        // Flag set to true while a task processing capturedFrames is queued or running
+        std::atomic<bool> scheduled;
+        // Thread reading frames from the camera
+        std::thread grabThread;
+    };
+
+    void GrabFrames( Camera& aCamera );
+
+    bool ReleaseUntilMotion( Camera& aCamera, cv::Mat const& aLastImage );
+
+    bool PushFrame( Camera& aCamera, Frame aFrame );
+
+    void ProcessFrames( Camera& aCamera );
+
+    bool LoadLandmarkModel();
+
+    void TrackEyes( Camera& aCamera, Frame& aFrame );
+
+    void SelectView( View const& aView );
+
+    void RemoveCamera( std::size_t aCamera );
+
+    void DetectBlinks( std::vector<View> const& aViews );
+
+    void LogEyeAspectRatio( View const& aView );
 
     void TestTrackEyes();
 
-    // Emitted when user needs to reminded to perform this habit
-    boost::signals2::signal<void ()> mUserBlinked;
+    // Instrumentation of every stage
+    Metrics& mMetrics;
+    // Log blinks and eye aspect ratio samples are appended to, null when not logged
+    EventLog* mEventLog;
+    // Carries USER_BLINKED each time the user blinks, published under mViewMutex
+    // so the workers take turns as a single producer
+    EventBus& mEventBus;
+    EventBus::ProducerId mProducer;
+
+    // Cameras watching the user, in the order of MonitorSettings::frameSources
+    std::vector<std::unique_ptr<Camera>> mCameras;
+    // Flag set to true when frames are paced in real time and stale frames may be dropped
+    bool mDropFrames;
+    // Flag set to true when recordings are replayed at their recorded pace
+    bool mRealTime;
+
+    // Skips frames and makes detection cheaper to stay within the CPU budget
+    CpuGovernor mGovernor;
+    // Threads detecting faces and fitting landmarks for every camera
+    WorkerPool mWorkers;
+
+    // Shape predictor model requested in the settings, empty for the default models
+    std::string mLandmarkModelPath;
+    // Fits eye landmarks onto detected faces
+    LandmarkModel mLandmarkModel;
+    // Result of LoadLandmarkModel, loaded in the background while the cameras open
+    std::shared_future<bool> mLandmarkModelLoaded;
+    // Flag set to true once the start up time has been reported
+    std::atomic<bool> mReportedStartup;
+
+    // Picks the best view of the eyes of each time slot among the cameras
+    ViewSelector mViewSelector;
+    // Detects blinks in the eye aspect ratio of each selected view, calibrated to the user
+    BlinkDetector mBlinkDetector;
+    // Eye aspect ratios of the selected views in the current second of view
+    // time, logged as one mean sample per second
+    double mEyeAspectRatioSum;
+    unsigned int mEyeAspectRatioCount;
+    double mEyeAspectRatioSecond;
+    // Flag set to true while the user rests, and the eye checks made during the
+    // rest and how many found the eyes closed
+    bool mResting;
+    unsigned long mRestChecks;
+    unsigned long mRestChecksEyesClosed;
+    // Mutex for mViewSelector, mBlinkDetector, the eye aspect ratio sample and the rest checks
+    std::mutex mViewMutex;
+    // File the calibration is loaded from on construction and saved to on Stop, empty for none
+    std::string mCalibrationPath;
+
+    // Time Start was called, used to report how long start up took and as
+    // the clock views of live cameras are compared on
+    std::chrono::steady_clock::time_point mStartTime;
 
-    // Thread
-    std::thread mThread;
+    // Flag set to true while frames are read but not processed, keeping the cameras open
+    std::atomic<bool> mPaused;
     // Flag set to true when application needs to exit
     std::atomic<bool> mExitMonitoring;
-    // Waits mInterval before reminding to perform habit or until woken up to exit
+    // Waits between looking for motion in front of a released camera or until woken up to exit
     std::condition_variable mCondVar;
-    // Mutex for mRestCondVar
+    // Mutex for mCondVar
     std::mutex mCondVarMutex;
-};
\ No newline at end of file
+};
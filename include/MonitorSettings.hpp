@@ -0,0 +1,61 @@
+
+/**
+    Declaration of MonitorSettings
+*/
+
+#pragma once
+
+#include <string>   // std::string
+#include <vector>   // std::vector
+
+/**
+    Tuning parameters for the eye tracking pipeline in Monitor
+*/
+struct MonitorSettings
+{
+    //! Factor the frame is scaled by before face detection, 0 picks a scale
+    //! that brings the frame down to FaceDetector's default detection width
+    double detectionScale = 0.0;
+    //! Engine finding faces: "hog", "haar", "lbp" or "dnn", empty for "hog",
+    //! see FaceDetectorEngine::Create
+    std::string faceDetector;
+    //! Cascade file of the "haar" and "lbp" engines, empty for the one shipped
+    //! with OpenCV, or network file of the "dnn" engine
+    std::string faceModelPath;
+    //! Full frame face detection runs at least once every faceDetectionStride
+    //! frames, 1 disables tracking the face between detections
+    unsigned int faceDetectionStride = 10;
+    //! The shape predictor fits the eye landmarks at least once every
+    //! landmarkInterval frames and optical flow follows them in between,
+    //! 1 fits them on every frame
+    unsigned int landmarkInterval = 1;
+    //! Shape predictor used to fit eye landmarks, empty uses the eye only
+    //! model if it is installed and falls back to the 68 point face model
+    std::string landmarkModelPath;
+    //! Where frames come from, one entry per camera: a device index, a video
+    //! file or a directory of images, see FrameSource::Create. Empty for the
+    //! default webcam
+    std::vector<std::string> frameSources;
+    //! Threads detecting faces and fitting landmarks for all cameras, 0 for
+    //! one per core
+    unsigned int workerThreads = 0;
+    //! Read only the intensity of webcam frames, straight from YUYV or GREY
+    //! frames of the driver, false reads colour frames through OpenCV
+    bool lumaCapture = true;
+    //! Frame rate recordings are replayed at when they do not store one
+    double replayFrameRate = 30.0;
+    //! Replay recordings at their recorded pace, false processes every frame
+    //! of a recording as fast as possible
+    bool realTime = true;
+    //! File the blink calibration learned for the user is loaded from on
+    //! start and saved to on stop, empty learns it again on every start
+    std::string calibrationPath;
+    //! Share of one core eye tracking may use, 0.25 for a quarter of a core,
+    //! 0 for no limit, see CpuGovernor
+    double cpuBudget = 0.0;
+    //! Highest rate frames are processed at, 0 for no limit
+    double maxFrameRate = 0.0;
+    //! Seconds after a blink the user is reminded to blink, frames are
+    //! processed faster as the reminder comes due
+    int blinkInterval = 0;
+};
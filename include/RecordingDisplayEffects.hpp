@@ -0,0 +1,69 @@
+/**
+    Declaration of RecordingDisplayEffects
+*/
+
+#pragma once
+
+#include <chrono>   // std::chrono::steady_clock
+#include <mutex>    // std::mutex
+#include <ostream>  // std::ostream
+#include <string>   // std::string
+#include <vector>   // std::vector
+
+#include "DisplayEffects.hpp"
+
+/**
+    Display effect applied by RecordingDisplayEffects
+*/
+struct DisplayEffect
+{
+    enum class Type
+    {
+        NightLight,
+        Notification
+    };
+
+    //! Which effect was applied
+    Type type;
+    //! Time the effect was applied
+    std::chrono::steady_clock::time_point time;
+    //! Night light switched on, unused for notifications
+    bool turnOn = false;
+    //! Night light temperature, 0 or less when left unchanged
+    int temperature = 0;
+    //! Text of the notification
+    std::string message;
+    //! Seconds the notification is shown for
+    int timeout = 0;
+};
+
+/**
+    Records display effects instead of changing the desktop, so the reminders
+    can be checked in tests and run on machines without a desktop. Each effect
+    is optionally also written to a log stream.
+*/
+class RecordingDisplayEffects : public DisplayEffects
+{
+public:
+
+    RecordingDisplayEffects( std::ostream* aLog = nullptr );
+
+    ~RecordingDisplayEffects() = default;
+
+    void NightLight( bool aTurnOn, int aTemperature ) override;
+
+    void Notify( std::string const& aMessage, int aTimeout ) override;
+
+    char const* Name() const override;
+
+    std::vector<DisplayEffect> Effects() const;
+
+private:
+
+    // Stream each effect is written to, null for none
+    std::ostream* mLog;
+    // Effects applied so far, oldest first
+    std::vector<DisplayEffect> mEffects;
+    // Mutex for mEffects and mLog
+    mutable std::mutex mMutex;
+};
@@ -5,20 +5,24 @@
 
 #pragma once
 
+#include <atomic>               // std::atomic
 #include <boost/signals2.hpp>   // std::boost::signals2::connection
-#include <condition_variable>   // std::condition_variable
-#include <mutex>                // std::mutex
-#include <thread>               // std::thread
+
+#include "EventBus.hpp"
+#include "HabitScheduler.hpp"
 
 /**
     Rest manages the habit of resting your eyes periodically. Every mInterval
     seconds, a reminder to reset eyes for aRestDuration second.
+
+    Runs on the timers of a HabitScheduler, all events are published from the
+    scheduler thread and delivered on the EventBus thread.
 */
 class Rest
 {
 public:
 
-    Rest( int aInterval, int aRestDuration );
+    Rest( HabitScheduler& aScheduler, EventBus& aEventBus, int aInterval, int aRestDuration );
 
     ~Rest() = default;
 
@@ -26,6 +30,14 @@ public:
 
     void Stop();
 
+    int Interval() const;
+
+    void SetInterval( int aInterval );
+
+    int RestDuration() const;
+
+    void SetRestDuration( int aRestDuration );
+
     boost::signals2::connection RegisterRestReminder
         (
         boost::signals2::signal<void ( int aRestDuration )>::slot_type const& aSlot
@@ -38,24 +50,25 @@ public:
 
 private:
 
-    void HostHabit();
-
-    // This habit must be performed once every mInterval
-    int mInterval;
-    // User must rest for mRestDuration seconds
-    int mRestDuration;
-
-    // Emitted after mInterval seconds to remind user to rest for mRestDuration seconds
-    boost::signals2::signal<void ( int aRestDuration )> mRemind;
-    // Emitted after user has rested for mRestDuration seconds
-    boost::signals2::signal<void ()> mCancel;
-
-    // Thread to host rest habit
-    std::thread mThread;
-    // Flag set to true when application needs to exit
-    std::atomic<bool> mExitHabit;
-    // Waits mInterval or until woken up for reminder or exit
-    std::condition_variable mCondVar;
-    // Mutex for mRestCondVar
-    std::mutex mCondVarMutex;
-};
\ No newline at end of file
+    void OnRestDue();
+
+    void OnRestDone();
+
+    // Hosts the timers of this habit
+    HabitScheduler& mScheduler;
+
+    // This habit must be performed once every mInterval, may be changed from any thread
+    std::atomic<int> mInterval;
+    // User must rest for mRestDuration seconds, may be changed from any thread
+    std::atomic<int> mRestDuration;
+
+    // Carries REST_REMINDER after mInterval seconds to remind user to rest for
+    // mRestDuration seconds and REST_CANCEL after user has rested
+    EventBus& mEventBus;
+    EventBus::ProducerId mProducer;
+
+    // Fires mInterval after the last rest ended
+    HabitScheduler::TimerId mRestDueTimer;
+    // Fires mRestDuration after the reminder to rest
+    HabitScheduler::TimerId mRestDoneTimer;
+};
@@ -0,0 +1,27 @@
+/**
+    Declaration of ShellDisplayEffects
+*/
+
+#pragma once
+
+#include "DisplayEffects.hpp"
+
+/**
+    Applies display effects by running the gsettings and notify-send commands.
+    Every change forks a shell, so this is only used when the desktop cannot
+    be reached over D-Bus from within the process.
+*/
+class ShellDisplayEffects : public DisplayEffects
+{
+public:
+
+    ShellDisplayEffects() = default;
+
+    ~ShellDisplayEffects() = default;
+
+    void NightLight( bool aTurnOn, int aTemperature ) override;
+
+    void Notify( std::string const& aMessage, int aTimeout ) override;
+
+    char const* Name() const override;
+};
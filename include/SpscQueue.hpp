@@ -0,0 +1,136 @@
+/**
+    Declaration and definition of SpscQueue
+*/
+
+#pragma once
+
+#include <atomic>   // std::atomic
+#include <cstddef>  // std::size_t
+#include <vector>   // std::vector
+
+/**
+    Lock free queue of a fixed capacity between exactly one producer thread
+    and one consumer thread. Pushing never blocks and never allocates, a push
+    onto a full queue fails instead. The producer and the consumer each own
+    one index, kept on its own cache line, and only read the other's index
+    when their cached copy of it says the queue is full or empty.
+
+    Several threads may take turns as the producer, or as the consumer, when
+    something else orders their turns, such as a mutex held while pushing.
+*/
+template <typename T>
+class SpscQueue
+{
+public:
+
+    SpscQueue( std::size_t aCapacity );
+
+    ~SpscQueue() = default;
+
+    SpscQueue( SpscQueue const& ) = delete;
+
+    SpscQueue& operator=( SpscQueue const& ) = delete;
+
+    bool Push( T const& aItem );
+
+    bool Pop( T& aItem );
+
+    bool Empty() const;
+
+private:
+
+    // Size of a cache line, the indices are kept apart so the producer and
+    // the consumer do not invalidate each other's cache lines
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    // Slots of the ring, a power of two so positions wrap with mMask
+    std::vector<T> mItems;
+    std::size_t mMask;
+
+    // Position of the next item to pop, written by the consumer, and the
+    // consumer's copy of mTail
+    alignas( CACHE_LINE ) std::atomic<std::size_t> mHead;
+    std::size_t mCachedTail;
+    // Position of the next item to push, written by the producer, and the
+    // producer's copy of mHead
+    alignas( CACHE_LINE ) std::atomic<std::size_t> mTail;
+    std::size_t mCachedHead;
+};
+
+/**
+    Constructor
+
+    @param aCapacity least number of items held, rounded up to a power of two
+*/
+template <typename T>
+SpscQueue<T>::SpscQueue( std::size_t aCapacity )
+    : mMask( 0 )
+    , mHead( 0 )
+    , mCachedTail( 0 )
+    , mTail( 0 )
+    , mCachedHead( 0 )
+{
+    std::size_t capacity = 1;
+    while( capacity < aCapacity )
+    {
+        capacity *= 2;
+    }
+    mItems.resize( capacity );
+    mMask = capacity - 1;
+}
+
+/**
+    Adds an item, called by the producer only
+
+    @return false if the queue is full and the item was not added
+*/
+template <typename T>
+bool SpscQueue<T>::Push( T const& aItem )
+{
+    std::size_t tail = mTail.load( std::memory_order_relaxed );
+    if( tail - mCachedHead == mItems.size() )
+    {
+        mCachedHead = mHead.load( std::memory_order_acquire );
+        if( tail - mCachedHead == mItems.size() )
+        {
+            return false;
+        }
+    }
+
+    mItems[tail & mMask] = aItem;
+    mTail.store( tail + 1, std::memory_order_release );
+    return true;
+}
+
+/**
+    Removes the oldest item, called by the consumer only
+
+    @return false if the queue is empty
+*/
+template <typename T>
+bool SpscQueue<T>::Pop( T& aItem )
+{
+    std::size_t head = mHead.load( std::memory_order_relaxed );
+    if( head == mCachedTail )
+    {
+        mCachedTail = mTail.load( std::memory_order_acquire );
+        if( head == mCachedTail )
+        {
+            return false;
+        }
+    }
+
+    aItem = mItems[head & mMask];
+    mHead.store( head + 1, std::memory_order_release );
+    return true;
+}
+
+/**
+    @return true if no items are waiting, may be called from any thread but
+            is out of date as soon as it returns
+*/
+template <typename T>
+bool SpscQueue<T>::Empty() const
+{
+    return mHead.load( std::memory_order_acquire ) == mTail.load( std::memory_order_acquire );
+}
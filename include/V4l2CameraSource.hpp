@@ -0,0 +1,74 @@
+/**
+    Declaration of V4l2CameraSource
+*/
+
+#pragma once
+
+#include <chrono>   // std::chrono::steady_clock
+#include <cstddef>  // std::size_t
+#include <cstdint>  // std::uint32_t
+#include <vector>   // std::vector
+
+#include "CameraSource.hpp"
+#include "FrameSource.hpp"
+
+/**
+    Reads only the intensity of a webcam's frames straight from the Video4Linux
+    driver.
+
+    The device is asked for GREY or YUYV frames, which are streamed through
+    buffers mapped from the driver, and only the Y plane is copied into the
+    frame as a single channel image. Face detection and landmark fitting only
+    use intensity, so this avoids decoding every frame to BGR and moves a third
+    of the data through the rest of the pipeline. Devices that deliver neither
+    format, and builds without Video4Linux headers, fall back to CameraSource.
+*/
+class V4l2CameraSource : public FrameSource
+{
+public:
+
+    V4l2CameraSource( int aDevice );
+
+    ~V4l2CameraSource();
+
+    bool Open() override;
+
+    void Close() override;
+
+    bool Read( Frame& aFrame ) override;
+
+    bool IsLive() const override;
+
+private:
+
+    bool OpenDevice();
+
+    /**
+        Driver buffer mapped into the process
+    */
+    struct MappedBuffer
+    {
+        void* start;
+        std::size_t length;
+    };
+
+    // Index of the video device, 0 for /dev/video0
+    int mDevice;
+    // File descriptor of the open device, -1 when closed
+    int mFd;
+    // Pixel format delivered by the device, GREY or YUYV
+    std::uint32_t mPixelFormat;
+    // Frame size and bytes per row of the driver's buffers
+    int mWidth;
+    int mHeight;
+    std::size_t mBytesPerLine;
+    // Buffers shared with the driver
+    std::vector<MappedBuffer> mBuffers;
+    // Time the device was opened, source times are measured from it
+    std::chrono::steady_clock::time_point mOpenTime;
+
+    // Reads colour frames through OpenCV when the device cannot deliver intensity
+    CameraSource mFallback;
+    // Flag set to true while mFallback is in use
+    bool mUsingFallback;
+};
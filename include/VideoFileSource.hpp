@@ -0,0 +1,42 @@
+
+/**
+    Declaration of VideoFileSource
+*/
+
+#pragma once
+
+#include <opencv2/videoio.hpp>  // cv::VideoCapture
+#include <string>               // std::string
+
+#include "FrameSource.hpp"
+
+/**
+    Reads frames from a recorded video file
+*/
+class VideoFileSource : public FrameSource
+{
+public:
+
+    VideoFileSource( std::string const& aPath, double aDefaultFrameRate );
+
+    ~VideoFileSource() = default;
+
+    bool Open() override;
+
+    void Close() override;
+
+    bool Read( Frame& aFrame ) override;
+
+    bool IsLive() const override;
+
+private:
+
+    // Path of the video file
+    std::string mPath;
+    // Frame rate of the recording, aDefaultFrameRate if the file does not say
+    double mFrameRate;
+    // Video file decoder
+    cv::VideoCapture mVideoCapture;
+    // Number of frames read so far
+    unsigned long mFramesRead;
+};
@@ -0,0 +1,65 @@
+/**
+    Declaration of ViewSelector
+*/
+
+#pragma once
+
+#include <cstddef>  // std::size_t
+#include <map>      // std::map
+#include <vector>   // std::vector
+
+/**
+    Eyes as seen by one camera in one frame
+*/
+struct View
+{
+    //! Camera the frame came from
+    std::size_t camera = 0;
+    //! Seconds on the clock shared by all cameras, see Monitor
+    double time = 0.0;
+    //! Eye aspect ratio averaged over both eyes
+    double eyeAspectRatio = 0.0;
+    //! How well the eyes can be seen, larger is better, 0 when no face was fitted
+    double quality = 0.0;
+};
+
+/**
+    Picks the camera with the best view of the eyes for every time slot when
+    several cameras watch the user.
+
+    Views are grouped into slots of a fixed length by time. A slot is complete
+    once every active camera has delivered a view for it or a later slot, or
+    once views SLOT_LAG slots newer have arrived from any camera, so a slow or
+    stalled camera cannot hold up the others for long. Completed slots are
+    handed out in time order with the best of their views; views arriving
+    after their slot completed are dropped. Not thread safe.
+*/
+class ViewSelector
+{
+public:
+
+    ViewSelector( std::size_t aCameras, double aSlotSeconds );
+
+    ~ViewSelector() = default;
+
+    void Add( View const& aView, std::vector<View>& aCompleted );
+
+    void RemoveCamera( std::size_t aCamera, std::vector<View>& aCompleted );
+
+    void Flush( std::vector<View>& aCompleted );
+
+private:
+
+    void Complete( std::vector<View>& aCompleted );
+
+    // Length of a time slot in seconds
+    double mSlotSeconds;
+    // Newest slot each camera delivered a view for, -1 before the first view
+    std::vector<long> mCameraSlots;
+    // Flag set to false for cameras that will deliver no more views
+    std::vector<bool> mActive;
+    // Best view of every slot that is not complete yet, by slot
+    std::map<long, View> mOpenSlots;
+    // Newest slot handed out, views for it or earlier slots are dropped
+    long mCompletedSlot;
+};
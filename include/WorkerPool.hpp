@@ -0,0 +1,62 @@
+
+/**
+    Declaration of WorkerPool
+*/
+
+#pragma once
+
+#include <condition_variable>  // std::condition_variable
+#include <cstddef>             // std::size_t
+#include <deque>               // std::deque
+#include <functional>          // std::function
+#include <mutex>               // std::mutex
+#include <thread>              // std::thread
+#include <vector>              // std::vector
+
+/**
+    Fixed set of threads running submitted tasks in the order they were
+    submitted. Shared by every camera in Monitor, so the number of threads
+    doing detection and landmark work does not grow with the cameras.
+*/
+class WorkerPool
+{
+public:
+
+    WorkerPool( unsigned int aThreads );
+
+    ~WorkerPool();
+
+    void Start();
+
+    void Stop();
+
+    void Submit( std::function<void ()> aTask );
+
+    void ParallelFor( std::size_t aCount, std::function<void ( std::size_t )> const& aBody );
+
+    void WaitIdle();
+
+    unsigned int Size() const;
+
+private:
+
+    void Work();
+
+    // Number of threads started by Start
+    unsigned int mSize;
+    // Tasks waiting for a thread, oldest first
+    std::deque<std::function<void ()>> mTasks;
+    // Number of tasks currently running
+    unsigned int mRunning;
+    // Flag set to true when the threads need to exit
+    bool mExit;
+
+    // Threads running the tasks
+    std::vector<std::thread> mThreads;
+    // Wakes up threads when a task is submitted or the pool stops
+    std::condition_variable mCondVar;
+    // Wakes up WaitIdle when the last task finishes
+    std::condition_variable mIdleCondVar;
+    // Mutex for mTasks, mRunning and mExit
+    std::mutex mMutex;
+};
@@ -4,26 +4,96 @@
 
 #include "App.hpp"
 
-#include <iostream> // std::cin, std::getline
-#include <string>   // std::string, std::to_string
+#include <csignal>    // sigset_t, sigwait, pthread_sigmask, kill, SIGINT, SIGTERM
+#include <cstdlib>    // std::_Exit, std::strtod, std::strtol
+#include <iomanip>    // std::setprecision
+#include <iostream>   // std::cin, std::cout, std::getline
+#include <sstream>    // std::istringstream, std::ostringstream
+#include <string>     // std::string, std::to_string
+#include <unistd.h>   // getpid
 
 #include "Blink.hpp"
+#include "DisplayActuator.hpp"
 #include "Monitor.hpp"
 #include "Rest.hpp"
 
 // Constants for changing night light settings
 int TEMPERATURE_REST = 2500;
 int TEMPERATURE_BLINK = 4000;
+int TEMPERATURE_DEFAULT = 4000;
+
+// Longest shutdown may take before the process exits without finishing it
+const std::chrono::seconds SHUTDOWN_TIMEOUT( 5 );
+
+/**
+    @return event log opened in the directory of the settings, null if none
+            is set or it could not be opened
+*/
+static EventLog* OpenEventLog( MetricsSettings const& aSettings )
+{
+    if( aSettings.eventLogDirectory.empty() )
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<EventLog> eventLog( new EventLog( aSettings.eventLogDirectory ) );
+    if( !eventLog->Open() )
+    {
+        return nullptr;
+    }
+    std::cout << "Logging events to " << aSettings.eventLogDirectory << std::endl;
+    return eventLog.release();
+}
+
+/**
+    @return signals that stop the application in daemon mode
+*/
+static sigset_t StopSignals()
+{
+    sigset_t signals;
+    sigemptyset( &signals );
+    sigaddset( &signals, SIGINT );
+    sigaddset( &signals, SIGTERM );
+    return signals;
+}
 
 /**
     Constructor
 */
-App::App( int aBlinkInterval, int aRestInterval, int aRestDuration )
+App::App
+    (
+    int aBlinkInterval,
+    int aRestInterval,
+    int aRestDuration,
+    MonitorSettings const& aMonitorSettings,
+    MetricsSettings const& aMetricsSettings,
+    std::string const& aDisplayEffects,
+    std::string const& aControlSocket
+    )
     : mResting( false )
-    , mMonitor( new Monitor() )
-    , mBlinkHabit( new Blink( aBlinkInterval ) )
-    , mRestHabit( new Rest( aRestInterval, aRestDuration ) )
+    , mPaused( false )
+    , mEventLog( OpenEventLog( aMetricsSettings ) )
+    , mEventBus( mMetrics )
+    , mProducer( mEventBus.AddProducer() )
+    , mDisplayActuator( new DisplayActuator( DisplayEffects::Create( aDisplayEffects ), mMetrics ) )
+    , mMonitor( new Monitor( mMetrics, mEventBus, aMonitorSettings, mEventLog.get() ) )
+    , mBlinkHabit( new Blink( mScheduler, mEventBus, aBlinkInterval ) )
+    , mRestHabit( new Rest( mScheduler, mEventBus, aRestInterval, aRestDuration ) )
+    , mPauseTimer( mScheduler.AddTimer( [this]() { ApplyPause(); } ) )
+    , mShutdownDone( false )
 {
+    if( !aMetricsSettings.socketPath.empty() || !aMetricsSettings.filePath.empty() )
+    {
+        mMetricsExporter.reset( new MetricsExporter( mMetrics, mStatistics, aMetricsSettings ) );
+    }
+
+    if( !aControlSocket.empty() )
+    {
+        mControlServer.reset( new ControlServer( aControlSocket, [this]( std::string const& aCommand ) { return HandleCommand( aCommand ); } ) );
+    }
+
+    std::cout << "Using " << mDisplayActuator->Name() << " display effects" << std::endl;
+
     RegisterCallbacks();
 }
 
@@ -32,6 +102,7 @@ App::App( int aBlinkInterval, int aRestInterval, int aRestDuration )
 */
 App::~App()
 {
+    std::chrono::steady_clock::time_point stageStart = std::chrono::steady_clock::now();
     mMonitor.reset();
     mBlinkHabit.reset();
     mRestHabit.reset();
@@ -41,51 +112,107 @@ App::~App()
     mBlinkCancelConnection.disconnect();
     mRestReminderConnection.disconnect();
     mRestCancelConnection.disconnect();
+    mPausedConnection.disconnect();
 
-    // Reset temperature to default
-    system( "gsettings set org.gnome.settings-daemon.plugins.color night-light-temperature 4000" );
-
-    NightLight( false, -1 );
+    // Reset temperature to default, waiting until it has been applied
+    NightLight( false, TEMPERATURE_DEFAULT );
+    mDisplayActuator->Stop();
+    RecordShutdownStage( "display", stageStart );
+    FinishShutdown();
 }
 
 /**
     Begins the application by starting the eye tracking and habits,
     waits for user to exit, and finally cleans up when user exists
+
+    When replaying a recording the application exits once every frame
+    has been processed instead of waiting for the user.
 */
 void App::Run()
 {
+    // In daemon mode the stop signals are waited for, which needs them
+    // blocked in every thread, so before any thread is started
+    if( mControlServer )
+    {
+        sigset_t stopSignals = StopSignals();
+        pthread_sigmask( SIG_BLOCK, &stopSignals, nullptr );
+    }
+
     // Start Applications
+    if( mMetricsExporter )
+    {
+        mMetricsExporter->Start();
+    }
+    mDisplayActuator->Start();
+    mEventBus.Start();
     mMonitor->Start();
     mBlinkHabit->Start();
     mRestHabit->Start();
+    mScheduler.Start();
 
-    // Waits until user hits enter
-    std::string in;
-    std::getline( std::cin, in );
+    if( mControlServer )
+    {
+        WaitForStopSignal();
+    }
+    else if( mMonitor->IsLive() )
+    {
+        // Waits until user hits enter
+        std::string in;
+        std::getline( std::cin, in );
+    }
+    else
+    {
+        mMonitor->WaitUntilFinished();
+    }
 
-    // Stops Applications
+    // Stops Applications, each stage timed
+    StartShutdownWatchdog();
+    std::chrono::steady_clock::time_point stageStart = std::chrono::steady_clock::now();
+    if( mControlServer )
+    {
+        mControlServer->Stop();
+        RecordShutdownStage( "control", stageStart );
+    }
     mMonitor->Stop();
+    RecordShutdownStage( "monitor", stageStart );
     mBlinkHabit->Stop();
     mRestHabit->Stop();
+    mScheduler.Stop();
+    RecordShutdownStage( "habits", stageStart );
+    mEventBus.Stop();
+    RecordShutdownStage( "events", stageStart );
+    if( mMetricsExporter )
+    {
+        mMetricsExporter->Stop();
+        RecordShutdownStage( "metrics", stageStart );
+    }
 }
 
 /**
-    Slot for Monitor::mUserBlinked signal
+    Slot for USER_BLINKED events of Monitor
 
-    Forwards signal from Monitor that user blinked to mBlinkHabit
+    Forwards event from Monitor that user blinked to mBlinkHabit and mStatistics
 */
 void App::OnUserBlinked()
 {
+    mStatistics.OnUserBlinked();
     mBlinkHabit->OnUserBlinked();
 }
 
 /**
-    Slot for Blink::mRemind signal
+    Slot for BLINK_REMINDER events of Blink
 
     Turns ON monitor's night filter (temperature = 5000)
 */
 void App::OnBlinkReminder()
 {
+    if( mPaused )
+    {
+        return;
+    }
+    mMetrics.blinkReminders.fetch_add( 1, std::memory_order_relaxed );
+    LogEvent( EventType::BLINK_REMINDER );
+    mStatistics.OnBlinkReminder();
     if( !mResting )
     {
         NightLight( true, TEMPERATURE_BLINK );
@@ -93,12 +220,13 @@ void App::OnBlinkReminder()
 }
 
 /**
-    Slot for Blink::mCancel signal
+    Slot for BLINK_CANCEL events of Blink
 
     Turns OFF monitor's night filter
 */
 void App::OnBlinkCancel()
 {
+    mStatistics.OnBlinkCancel();
     if( !mResting )
     {
         NightLight( false, -1 );
@@ -106,45 +234,71 @@ void App::OnBlinkCancel()
 }
 
 /**
-    Slot for Rest::mRemind signal
+    Slot for REST_REMINDER events of Rest
 
     Turns ON monitor's night lights and sends a notification
 */
 void App::OnRestReminder( int aRestDuration )
 {
+    if( mPaused )
+    {
+        return;
+    }
+    mMetrics.restReminders.fetch_add( 1, std::memory_order_relaxed );
+    LogEvent( EventType::REST_REMINDER, static_cast<float>( aRestDuration ) );
+    mStatistics.OnRestReminder();
+    mMonitor->OnRestStarted();
     mResting = true;
     SendNotification( aRestDuration );
     NightLight( true, TEMPERATURE_REST );
 }
 
 /**
-    Slot for Rest::mCancel signal
+    Slot for REST_CANCEL events of Rest
 
-    Turns OFF monitors't night light
+    Turns OFF monitors't night light, unless no rest is showing because it was
+    paused or already ended by OnPaused
 */
 void App::OnRestCancel()
 {
-    mResting = false;
+    if( !mResting.exchange( false ) )
+    {
+        return;
+    }
+    LogEvent( EventType::REST_END );
+    mStatistics.OnRestCancel();
+    mMonitor->OnRestEnded();
     NightLight( false, -1 );
 }
 
 /**
-    Sets the state of the desktop night light
+    Slot for PAUSED events, ends any reminder or rest showing
 */
-void App::NightLight( bool aTurnOn, int aTemperature )
+void App::OnPaused()
+{
+    OnRestCancel();
+    OnBlinkCancel();
+}
+
+/**
+    Appends an event to mEventLog when events are logged
+*/
+void App::LogEvent( EventType aType, float aValue )
 {
-    if( aTurnOn )
+    if( mEventLog )
     {
-        // Set temperature for night light
-        std::string setTempCommand = "gsettings set org.gnome.settings-daemon.plugins.color night-light-temperature ";
-        setTempCommand += std::to_string( aTemperature );
-        system( setTempCommand.c_str() );
+        mEventLog->Append( aType, aValue );
     }
+}
 
-    // Switches light on or off
-    std::string onOffCommand = "gsettings set org.gnome.settings-daemon.plugins.color night-light-enabled ";
-    onOffCommand += ( aTurnOn ) ? "true" : "false";
-    system( onOffCommand.c_str() );
+/**
+    Sets the state of the desktop night light
+
+    @param aTemperature colour temperature set before switching, -1 leaves it unchanged
+*/
+void App::NightLight( bool aTurnOn, int aTemperature )
+{
+    mDisplayActuator->NightLight( aTurnOn, aTemperature );
 }
 
 /**
@@ -152,33 +306,247 @@ void App::NightLight( bool aTurnOn, int aTemperature )
 */
 void App::SendNotification( int aTimeout )
 {
-    // Note: notify-send ignores timeout, it is a known bug
-    std::string command = "notify-send -u critical \"Rest your eyes!\" -t " + std::to_string( aTimeout*1000 );
-    system( command.c_str() );
+    mDisplayActuator->Notify( "Rest your eyes!", aTimeout );
 }
 
 /**
-    Registers all callbacks for signals
+    Registers all callbacks for events
 */
 void App::RegisterCallbacks()
 {
-    // Register to get callbacks for Monitor's Blinked signal
+    // Register to get callbacks for Monitor's Blinked event
     boost::signals2::signal<void ()>::slot_type userBlinkedSlot( &App::OnUserBlinked, this );
     mUserBlinkedConnection = mMonitor->RegisterUserBlinked( userBlinkedSlot );
 
-    // Register to get callbacks for Blink's Remind signal
+    // Register to get callbacks for Blink's Remind event
     boost::signals2::signal<void ()>::slot_type blinkReminderSlot( &App::OnBlinkReminder, this );
     mBlinkReminderConnection = mBlinkHabit->RegisterBlinkReminder( blinkReminderSlot );
 
-    // Register to get callbacks for Blink's Cancel signal
+    // Register to get callbacks for Blink's Cancel event
     boost::signals2::signal<void ()>::slot_type blinkCancelSlot( &App::OnBlinkCancel, this );
     mBlinkCancelConnection = mBlinkHabit->RegisterBlinkCancel( blinkCancelSlot );
 
-    // Register to get callbacks for Rest's Remind signal
+    // Register to get callbacks for Rest's Remind event
     boost::signals2::signal<void ( int aRestDuration )>::slot_type restReminderSlot( &App::OnRestReminder, this, _1 );
     mRestReminderConnection = mRestHabit->RegisterRestReminder( restReminderSlot );
 
-    // Register to get callbacks for Rest's Remind signal
+    // Register to get callbacks for Rest's Cancel event
     boost::signals2::signal<void ()>::slot_type restCancelSlot( &App::OnRestCancel, this );
     mRestCancelConnection = mRestHabit->RegisterRestCancel( restCancelSlot );
-}
\ No newline at end of file
+
+    // Register to get callbacks for this object's Paused event
+    boost::signals2::signal<void ()>::slot_type pausedSlot( &App::OnPaused, this );
+    mPausedConnection = mEventBus.Subscribe( BusEvent::PAUSED, pausedSlot );
+}
+
+/**
+    Answers a command from the control socket, called on the control server thread
+
+    Commands:
+    status                       settings, state and blink statistics
+    pause                        stops reminders and eye tracking, the cameras stay open
+    resume                       starts reminders and eye tracking again
+    set blink-interval <seconds> seconds without blinking before a reminder
+    set rest-interval <seconds>  seconds between rests
+    set rest-duration <seconds>  seconds each rest lasts
+    set threshold <ratio | auto> eye aspect ratio below which the eyes count as
+                                 closed, auto for the learned threshold
+    stop                         shuts the application down
+
+    @return answer ending in a line "ok" or "error <reason>"
+*/
+std::string App::HandleCommand( std::string const& aCommand )
+{
+    std::istringstream words( aCommand );
+    std::string verb;
+    std::string setting;
+    std::string value;
+    words >> verb >> setting >> value;
+
+    if( verb == "status" )
+    {
+        return Status() + "ok\n";
+    }
+    if( verb == "pause" || verb == "resume" )
+    {
+        bool pause = ( verb == "pause" );
+        if( mPaused.exchange( pause ) != pause )
+        {
+            mScheduler.Schedule( mPauseTimer, std::chrono::steady_clock::duration::zero() );
+        }
+        return "ok\n";
+    }
+    if( verb == "stop" )
+    {
+        // Stops the same way as a signal, see WaitForStopSignal
+        kill( getpid(), SIGTERM );
+        return "ok\n";
+    }
+    if( verb != "set" )
+    {
+        return "error unknown command " + verb + "\n";
+    }
+
+    char* end = nullptr;
+    if( setting == "threshold" )
+    {
+        double threshold = ( value == "auto" ) ? 0.0 : std::strtod( value.c_str(), &end );
+        if( value != "auto" && ( value.empty() || *end != '\0' || threshold <= 0.0 || threshold >= 1.0 ) )
+        {
+            return "error threshold must be between 0 and 1 or auto\n";
+        }
+        mMonitor->SetBlinkThreshold( threshold );
+        return "ok\n";
+    }
+
+    long seconds = std::strtol( value.c_str(), &end, 10 );
+    if( value.empty() || *end != '\0' || seconds <= 0 || seconds > 24 * 60 * 60 )
+    {
+        return "error " + setting + " must be a number of seconds up to a day\n";
+    }
+    if( setting == "blink-interval" )
+    {
+        mBlinkHabit->SetInterval( static_cast<int>( seconds ) );
+        mMonitor->SetBlinkInterval( static_cast<int>( seconds ) );
+    }
+    else if( setting == "rest-interval" )
+    {
+        mRestHabit->SetInterval( static_cast<int>( seconds ) );
+    }
+    else if( setting == "rest-duration" )
+    {
+        mRestHabit->SetRestDuration( static_cast<int>( seconds ) );
+    }
+    else
+    {
+        return "error unknown setting " + setting + "\n";
+    }
+    return "ok\n";
+}
+
+/**
+    @return one "name value" line for each setting, state and statistic
+*/
+std::string App::Status() const
+{
+    WindowStatistics minute = mStatistics.Query( BlinkStatistics::Window::MINUTE );
+    WindowStatistics hour = mStatistics.Query( BlinkStatistics::Window::HOUR );
+    BlinkDetector const& calibration = mMonitor->Calibration();
+
+    std::ostringstream status;
+    status << std::setprecision( 3 );
+    status << "state " << ( mPaused ? "paused" : ( mResting ? "resting" : "running" ) ) << "\n";
+    status << "blink_interval " << mBlinkHabit->Interval() << "\n";
+    status << "rest_interval " << mRestHabit->Interval() << "\n";
+    status << "rest_duration " << mRestHabit->RestDuration() << "\n";
+    status << "threshold " << calibration.Threshold() << ( calibration.FixedThreshold() > 0.0 ? " fixed" : " learned" ) << "\n";
+    status << "faces " << mMonitor->Faces().size() << "\n";
+    status << "blinks " << mMetrics.blinks.load( std::memory_order_relaxed ) << "\n";
+    status << "blinks_per_minute_1m " << minute.blinksPerMinute << "\n";
+    status << "blinks_per_minute_1h " << hour.blinksPerMinute << "\n";
+    status << "median_blink_interval_1h " << hour.medianInterval << "\n";
+    status << "blink_reminder_ratio_1h " << hour.reminderShare << "\n";
+    return status.str();
+}
+
+/**
+    Applies mPaused on the scheduler thread, so it never races with the
+    habits. Pausing stops the habits and eye tracking and ends any reminder or
+    rest showing on the event bus thread, see OnPaused; resuming starts them again.
+*/
+void App::ApplyPause()
+{
+    if( mPaused )
+    {
+        mMonitor->Pause();
+        mBlinkHabit->Stop();
+        mRestHabit->Stop();
+        mEventBus.Publish( mProducer, BusEvent::PAUSED );
+    }
+    else
+    {
+        mMonitor->Resume();
+        mBlinkHabit->Start();
+        mRestHabit->Start();
+    }
+}
+
+/**
+    Serves the control socket until SIGINT or SIGTERM arrives, or a stop command
+*/
+void App::WaitForStopSignal()
+{
+    if( mControlServer->Start() )
+    {
+        std::cout << "Serving commands on " << mControlServer->SocketPath() << std::endl;
+    }
+    else
+    {
+        std::cerr << "Could not open control socket " << mControlServer->SocketPath() << std::endl;
+    }
+
+    sigset_t stopSignals = StopSignals();
+    int signal = 0;
+    sigwait( &stopSignals, &signal );
+}
+
+/**
+    Starts timing shutdown, exiting the process if it does not finish within
+    SHUTDOWN_TIMEOUT so a stuck camera or desktop never keeps it running
+*/
+void App::StartShutdownWatchdog()
+{
+    mShutdownStart = std::chrono::steady_clock::now();
+    mShutdownWatchdog = std::thread
+        (
+        [this]()
+        {
+            std::unique_lock<std::mutex> lock( mShutdownMutex );
+            if( !mShutdownCondVar.wait_for( lock, SHUTDOWN_TIMEOUT, [this]() { return mShutdownDone; } ) )
+            {
+                std::cerr << "Shutdown took over " << SHUTDOWN_TIMEOUT.count() << " s after "
+                          << mShutdownStages << ", exiting" << std::endl;
+                std::_Exit( EXIT_FAILURE );
+            }
+        }
+        );
+}
+
+/**
+    Records the time taken by a stage of shutdown
+
+    @param aStageStart start of the stage, set to now for the next stage
+*/
+void App::RecordShutdownStage( char const* aStage, std::chrono::steady_clock::time_point& aStageStart )
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::milli> stageTime = now - aStageStart;
+    aStageStart = now;
+
+    std::ostringstream stage;
+    stage << std::fixed << std::setprecision( 1 ) << ( mShutdownStages.empty() ? "" : ", " ) << aStage << " " << stageTime.count() << " ms";
+    std::lock_guard<std::mutex> lock( mShutdownMutex );
+    mShutdownStages += stage.str();
+}
+
+/**
+    Stops the shutdown watchdog and reports the time shutdown took
+*/
+void App::FinishShutdown()
+{
+    if( !mShutdownWatchdog.joinable() )
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( mShutdownMutex );
+        mShutdownDone = true;
+    }
+    mShutdownCondVar.notify_one();
+    mShutdownWatchdog.join();
+
+    std::chrono::duration<double, std::milli> shutdownTime = std::chrono::steady_clock::now() - mShutdownStart;
+    std::cout << std::fixed << std::setprecision( 1 ) << "Shut down in " << shutdownTime.count() << " ms ("
+              << mShutdownStages << ")" << std::endl;
+}
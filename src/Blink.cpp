@@ -7,10 +7,13 @@
 /**
     Constructor
 */
-Blink::Blink( int aInterval )
-    : mInterval( aInterval )
-    , mExitHabit( false )
-    , mUserBlinked( false )
+Blink::Blink( HabitScheduler& aScheduler, EventBus& aEventBus, int aInterval )
+    : mScheduler( aScheduler )
+    , mInterval( aInterval )
+    , mEventBus( aEventBus )
+    , mProducer( aEventBus.AddProducer() )
+    , mReminderTimer( aScheduler.AddTimer( [this]() { OnReminderDue(); } ) )
+    , mBlinkedTimer( aScheduler.AddTimer( [this]() { OnBlinked(); } ) )
 {
 }
 
@@ -19,80 +22,84 @@ Blink::Blink( int aInterval )
 */
 void Blink::Start()
 {
-    mThread = std::thread( &Blink::HostHabit, this );
+    mScheduler.Schedule( mReminderTimer, std::chrono::seconds( mInterval ) );
 }
 
 /**
-    Wakes up mCondVar and exits thread
+    Stops tracking of the blink habit
 */
 void Blink::Stop()
 {
-    mExitHabit = true;
-    mCondVar.notify_one();
-    if( mThread.joinable() )
-    {
-        mThread.join();
-    }
+    mScheduler.Cancel( mReminderTimer );
+    mScheduler.Cancel( mBlinkedTimer );
 }
 
 /**
-    Wakes up mCondVar and informs that user has blinked
+    Informs that user has blinked, the reminder is pushed back and
+    BLINK_CANCEL published from the scheduler thread
 */
 void Blink::OnUserBlinked()
 {
-    mUserBlinked = true;
-    mCondVar.notify_one();
+    mScheduler.Schedule( mBlinkedTimer, std::chrono::steady_clock::duration::zero() );
 }
 
 /**
-    Registers callback for mRemind signal
+    @return seconds the user may go without blinking before being reminded
+*/
+int Blink::Interval() const
+{
+    return mInterval;
+}
+
+/**
+    Changes the blink interval, taking effect from the next blink or reminder
+*/
+void Blink::SetInterval( int aInterval )
+{
+    mInterval = aInterval;
+}
 
-    @return connection to mRemind signal
+/**
+    Registers callback for BLINK_REMINDER events, run on the event bus thread
+
+    @return connection to the callback
 */
 boost::signals2::connection Blink::RegisterBlinkReminder
     (
     boost::signals2::signal<void ()>::slot_type const& aSlot
     )
 {
-    return mRemind.connect( aSlot );
+    return mEventBus.Subscribe( BusEvent::BLINK_REMINDER, aSlot );
 }
 
 /**
-    Registers callback for mCancel signal
+    Registers callback for BLINK_CANCEL events, run on the event bus thread
 
-    @return connection to mCancel signal
+    @return connection to the callback
 */
 boost::signals2::connection Blink::RegisterBlinkCancel
     (
     boost::signals2::signal<void ()>::slot_type const& aSlot
     )
 {
-    return mCancel.connect( aSlot );
+    return mEventBus.Subscribe( BusEvent::BLINK_CANCEL, aSlot );
+}
+
+/**
+    User has not blinked for mInterval seconds, reminds them and keeps
+    reminding every mInterval seconds until they blink
+*/
+void Blink::OnReminderDue()
+{
+    mEventBus.Publish( mProducer, BusEvent::BLINK_REMINDER );
+    mScheduler.Schedule( mReminderTimer, std::chrono::seconds( mInterval ) );
 }
 
 /**
-    Manages habit of blinking at least once every mInterval seconds
+    User blinked, cancels the reminder and restarts the interval
 */
-void Blink::HostHabit()
+void Blink::OnBlinked()
 {
-    while( !mExitHabit )
-    {
-        std::unique_lock<std::mutex> lock( mCondVarMutex );
-        if( mCondVar.wait_for
-            (
-            lock,
-            std::chrono::seconds( mInterval ),
-            [this]() { return mExitHabit || mUserBlinked; }
-            ) )
-        {
-            // if woken up
-            mCancel();
-            mUserBlinked = false;
-        }
-        else
-        {
-            // if timed out
-            mRemind();
-        }
-    }
-}
\ No newline at end of file
+    mScheduler.Schedule( mReminderTimer, std::chrono::seconds( mInterval ) );
+    mEventBus.Publish( mProducer, BusEvent::BLINK_CANCEL );
+}
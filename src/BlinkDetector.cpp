@@ -0,0 +1,310 @@
+/**
+    Definition of BlinkDetector
+*/
+
+#include "BlinkDetector.hpp"
+
+#include <algorithm>    // std::max
+#include <cmath>        // std::sqrt, std::lround
+#include <fstream>      // std::ifstream, std::ofstream
+#include <iomanip>      // std::setprecision
+
+// Threshold and closed frame count used until the user has been calibrated
+const double DEFAULT_THRESHOLD = 0.2;
+const unsigned int DEFAULT_CONSECUTIVE_FRAMES = 2;
+
+// Open eye frames needed before the learned threshold replaces the default
+const unsigned long CALIBRATION_SAMPLES = 90;
+// Smallest weight of a new frame in the rolling baseline, about the last 500 frames
+const double MIN_BASELINE_WEIGHT = 0.002;
+
+// Eyes count as closed below the baseline minus the larger of THRESHOLD_DEVIATIONS
+// standard deviations and MIN_THRESHOLD_DROP of the baseline
+const double THRESHOLD_DEVIATIONS = 3.0;
+const double MIN_THRESHOLD_DROP = 0.2;
+// The threshold never falls below MIN_THRESHOLD, however noisy the baseline
+const double MIN_THRESHOLD = 0.1;
+
+// Shortest closure counted as a blink, two frames at the 30 frames/s the
+// default frame count was tuned for
+const double MIN_BLINK_SECONDS = 2.0 / 30.0;
+// Weight of a new frame in the mean frame interval
+const double FRAME_INTERVAL_WEIGHT = 0.05;
+// Gaps between frames longer than this end a closure instead of extending it
+const double MAX_FRAME_GAP_SECONDS = 1.0;
+// Eyes closed for longer than this, well beyond a rest period, mean the open eye
+// aspect ratio has changed, for example after moving the camera, and the user is
+// calibrated again
+const double RECALIBRATE_SECONDS = 60.0;
+
+/**
+    Constructor
+*/
+BlinkDetector::BlinkDetector()
+    : mFixedThreshold( 0.0 )
+    , mHasLastTime( false )
+    , mLastTime( 0.0 )
+    , mClosedFrames( 0 )
+    , mClosedSince( 0.0 )
+{
+}
+
+/**
+    Processes the eye aspect ratio of the next frame
+
+    @param aEyeAspectRatio eye aspect ratio averaged over both eyes
+    @param aTime time of the frame in seconds, see Frame::sourceTime
+
+    @return true when the eyes opened again after a blink
+*/
+bool BlinkDetector::Update( double aEyeAspectRatio, double aTime )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    UpdateFrameInterval( aTime );
+
+    // Every frame is learned from until calibrated, so users whose open eyes
+    // fall below the default threshold are still calibrated
+    bool calibrated = mState.samples >= CALIBRATION_SAMPLES;
+    if( !calibrated )
+    {
+        UpdateBaseline( aEyeAspectRatio );
+
+        // Frames below the default threshold while calibrating are not a blink
+        if( mState.samples >= CALIBRATION_SAMPLES )
+        {
+            mClosedFrames = 0;
+        }
+    }
+
+    if( aEyeAspectRatio < ThresholdLocked() )
+    {
+        if( mClosedFrames == 0 )
+        {
+            mClosedSince = aTime;
+        }
+        ++mClosedFrames;
+
+        if( calibrated && aTime - mClosedSince > RECALIBRATE_SECONDS )
+        {
+            mState.baseline = 0.0;
+            mState.variance = 0.0;
+            mState.samples = 0;
+            mClosedFrames = 0;
+        }
+        return false;
+    }
+
+    // Check if eye was closed for required number of frames
+    bool blinked = mClosedFrames >= ConsecutiveFramesLocked();
+    mClosedFrames = 0;
+
+    // Once calibrated only open eyes are learned from, so blinks do not pull
+    // the baseline down
+    if( calibrated )
+    {
+        UpdateBaseline( aEyeAspectRatio );
+    }
+    return blinked;
+}
+
+/**
+    @return eye aspect ratio below which the eyes count as closed
+*/
+double BlinkDetector::Threshold() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return ThresholdLocked();
+}
+
+/**
+    Overrides the learned threshold, the baseline is still learned so the
+    learned threshold is ready when the override is removed
+
+    @param aThreshold eye aspect ratio below which the eyes count as closed,
+                      0 to use the learned threshold again
+*/
+void BlinkDetector::SetFixedThreshold( double aThreshold )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mFixedThreshold = std::max( aThreshold, 0.0 );
+}
+
+/**
+    @return threshold set with SetFixedThreshold, 0 when the learned one is used
+*/
+double BlinkDetector::FixedThreshold() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mFixedThreshold;
+}
+
+/**
+    @return number of consecutive closed frames that make a blink
+*/
+unsigned int BlinkDetector::ConsecutiveFrames() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return ConsecutiveFramesLocked();
+}
+
+/**
+    @return copy of the learned calibration
+*/
+BlinkDetectorState BlinkDetector::State() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mState;
+}
+
+/**
+    Replaces the learned calibration, for example with one saved by a
+    previous run
+*/
+void BlinkDetector::Restore( BlinkDetectorState const& aState )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mState = aState;
+    mClosedFrames = 0;
+}
+
+/**
+    Writes the learned calibration to a file
+
+    @return false if the file could not be written
+*/
+bool BlinkDetector::Save( std::string const& aPath ) const
+{
+    BlinkDetectorState state = State();
+
+    std::ofstream file( aPath );
+    file << std::setprecision( 17 )
+         << "baseline " << state.baseline << "\n"
+         << "variance " << state.variance << "\n"
+         << "frame_interval " << state.frameInterval << "\n"
+         << "samples " << state.samples << "\n";
+    return static_cast<bool>( file );
+}
+
+/**
+    Restores a calibration written by Save
+
+    @return false if the file could not be read, the calibration is unchanged
+*/
+bool BlinkDetector::Load( std::string const& aPath )
+{
+    std::ifstream file( aPath );
+    if( !file )
+    {
+        return false;
+    }
+
+    BlinkDetectorState state;
+    unsigned int fields = 0;
+    std::string key;
+    while( file >> key )
+    {
+        if( key == "baseline" && file >> state.baseline )
+        {
+            ++fields;
+        }
+        else if( key == "variance" && file >> state.variance )
+        {
+            ++fields;
+        }
+        else if( key == "frame_interval" && file >> state.frameInterval )
+        {
+            ++fields;
+        }
+        else if( key == "samples" && file >> state.samples )
+        {
+            ++fields;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if( fields != 4 || state.baseline < 0.0 || state.variance < 0.0 || state.frameInterval < 0.0 )
+    {
+        return false;
+    }
+
+    Restore( state );
+    return true;
+}
+
+/**
+    @pre mMutex is locked
+*/
+double BlinkDetector::ThresholdLocked() const
+{
+    if( mFixedThreshold > 0.0 )
+    {
+        return mFixedThreshold;
+    }
+    if( mState.samples < CALIBRATION_SAMPLES )
+    {
+        return DEFAULT_THRESHOLD;
+    }
+
+    double drop = std::max( THRESHOLD_DEVIATIONS * std::sqrt( mState.variance ), MIN_THRESHOLD_DROP * mState.baseline );
+    return std::max( mState.baseline - drop, MIN_THRESHOLD );
+}
+
+/**
+    @pre mMutex is locked
+*/
+unsigned int BlinkDetector::ConsecutiveFramesLocked() const
+{
+    if( mState.frameInterval <= 0.0 )
+    {
+        return DEFAULT_CONSECUTIVE_FRAMES;
+    }
+
+    long frames = std::lround( MIN_BLINK_SECONDS / mState.frameInterval );
+    return static_cast<unsigned int>( std::max( frames, 1L ) );
+}
+
+/**
+    Folds the time since the previous frame into the mean frame interval.
+    Long gaps, such as frames without a face, are not counted and end any
+    closure in progress.
+
+    @pre mMutex is locked
+*/
+void BlinkDetector::UpdateFrameInterval( double aTime )
+{
+    if( mHasLastTime )
+    {
+        double interval = aTime - mLastTime;
+        if( interval > MAX_FRAME_GAP_SECONDS )
+        {
+            mClosedFrames = 0;
+        }
+        else if( interval > 0.0 )
+        {
+            mState.frameInterval = mState.frameInterval > 0.0
+                ? mState.frameInterval + FRAME_INTERVAL_WEIGHT * ( interval - mState.frameInterval )
+                : interval;
+        }
+    }
+
+    mLastTime = aTime;
+    mHasLastTime = true;
+}
+
+/**
+    Folds an open eye aspect ratio into the rolling mean and variance. The
+    first frames are weighted equally, later frames decay exponentially.
+
+    @pre mMutex is locked
+*/
+void BlinkDetector::UpdateBaseline( double aEyeAspectRatio )
+{
+    ++mState.samples;
+    double weight = std::max( 1.0 / mState.samples, MIN_BASELINE_WEIGHT );
+    double difference = aEyeAspectRatio - mState.baseline;
+    mState.baseline += weight * difference;
+    mState.variance = ( 1.0 - weight ) * ( mState.variance + weight * difference * difference );
+}
@@ -0,0 +1,306 @@
+/**
+    Definition of BlinkStatistics
+*/
+
+#include "BlinkStatistics.hpp"
+
+#include <algorithm>    // std::min, std::max
+#include <cmath>        // std::log2, std::exp2
+
+// Bucket lengths and counts of the minute, hour and day windows
+const std::int64_t MICROSECONDS_PER_SECOND = 1000000;
+const std::size_t MINUTE_BUCKETS = 60;
+const std::size_t HOUR_BUCKETS = 60;
+const std::size_t DAY_BUCKETS = 96;
+
+// Blinks further apart than this are taken to span a break, not an interval between blinks
+const double MAX_BLINK_INTERVAL_SECONDS = 60.0;
+// Upper bound of the first interval bin, and bins per doubling of the interval
+const double FIRST_INTERVAL_SECONDS = 0.25;
+const double INTERVAL_BINS_PER_OCTAVE = 4.0;
+
+/**
+    @return interval bin a blink interval falls in
+*/
+static std::size_t IntervalBin( double aSeconds, std::size_t aBins )
+{
+    if( aSeconds < FIRST_INTERVAL_SECONDS )
+    {
+        return 0;
+    }
+    std::size_t bin = static_cast<std::size_t>( INTERVAL_BINS_PER_OCTAVE * std::log2( aSeconds / FIRST_INTERVAL_SECONDS ) );
+    return std::min( bin, aBins - 1 );
+}
+
+/**
+    @return blink interval in the middle of a bin, on a log scale
+*/
+static double IntervalBinMiddle( std::size_t aBin )
+{
+    return FIRST_INTERVAL_SECONDS * std::exp2( ( aBin + 0.5 ) / INTERVAL_BINS_PER_OCTAVE );
+}
+
+/**
+    Constructor
+*/
+BlinkStatistics::Bucket::Bucket()
+    : number( -1 )
+    , blinks( 0 )
+    , reminderMilliseconds( 0 )
+    , restMilliseconds( 0 )
+{
+    for( std::atomic<std::uint32_t>& count : intervals )
+    {
+        count.store( 0, std::memory_order_relaxed );
+    }
+}
+
+/**
+    Constructor
+*/
+BlinkStatistics::Ring::Ring( std::int64_t aBucketMicroseconds, std::size_t aBuckets )
+    : bucketMicroseconds( aBucketMicroseconds )
+    , size( aBuckets )
+    , buckets( new Bucket[aBuckets] )
+{
+}
+
+/**
+    Constructor
+*/
+BlinkStatistics::BlinkStatistics()
+    : mRings
+        { {
+        Ring( MICROSECONDS_PER_SECOND, MINUTE_BUCKETS ),
+        Ring( 60 * MICROSECONDS_PER_SECOND, HOUR_BUCKETS ),
+        Ring( 900 * MICROSECONDS_PER_SECOND, DAY_BUCKETS )
+        } }
+    , mLastBlink( -1 )
+    , mReminderStart( -1 )
+    , mRestStart( -1 )
+    , mStart( std::chrono::steady_clock::now() )
+{
+}
+
+/**
+    Slot for USER_BLINKED events of Monitor
+
+    Counts the blink and the interval since the previous blink in every window
+*/
+void BlinkStatistics::OnUserBlinked()
+{
+    std::lock_guard<std::mutex> lock( mRecordMutex );
+    std::int64_t now = Now();
+    double interval = static_cast<double>( now - mLastBlink ) / MICROSECONDS_PER_SECOND;
+    bool countInterval = ( mLastBlink >= 0 && interval <= MAX_BLINK_INTERVAL_SECONDS );
+    mLastBlink = now;
+
+    for( Ring& ring : mRings )
+    {
+        Bucket& bucket = Current( ring, now / ring.bucketMicroseconds );
+        bucket.blinks.fetch_add( 1, std::memory_order_relaxed );
+        if( countInterval )
+        {
+            bucket.intervals[IntervalBin( interval, INTERVAL_BINS )].fetch_add( 1, std::memory_order_relaxed );
+        }
+    }
+}
+
+/**
+    Slot for BLINK_REMINDER events of Blink, starts timing the reminder
+*/
+void BlinkStatistics::OnBlinkReminder()
+{
+    std::int64_t none = -1;
+    mReminderStart.compare_exchange_strong( none, Now() );
+}
+
+/**
+    Slot for BLINK_CANCEL events of Blink, adds the time the reminder showed to every window
+*/
+void BlinkStatistics::OnBlinkCancel()
+{
+    std::lock_guard<std::mutex> lock( mRecordMutex );
+    std::int64_t start = mReminderStart.exchange( -1 );
+    if( start >= 0 )
+    {
+        AddDuration( &Bucket::reminderMilliseconds, start, Now() );
+    }
+}
+
+/**
+    Slot for REST_REMINDER events of Rest, starts timing the rest
+*/
+void BlinkStatistics::OnRestReminder()
+{
+    std::int64_t none = -1;
+    mRestStart.compare_exchange_strong( none, Now() );
+}
+
+/**
+    Slot for REST_CANCEL events of Rest, adds the time rested to every window
+*/
+void BlinkStatistics::OnRestCancel()
+{
+    std::lock_guard<std::mutex> lock( mRecordMutex );
+    std::int64_t start = mRestStart.exchange( -1 );
+    if( start >= 0 )
+    {
+        AddDuration( &Bucket::restMilliseconds, start, Now() );
+    }
+}
+
+/**
+    Sums the buckets of a window, skipping buckets that are reused while
+    they are read. Never blocks, so any thread may call it at any time.
+
+    @return blink habits over the last minute, hour or day
+*/
+WindowStatistics BlinkStatistics::Query( Window aWindow ) const
+{
+    Ring const& ring = mRings[static_cast<std::size_t>( aWindow )];
+    std::int64_t now = Now();
+    std::int64_t newest = now / ring.bucketMicroseconds;
+    std::int64_t oldest = newest - static_cast<std::int64_t>( ring.size ) + 1;
+    std::int64_t windowStart = std::max<std::int64_t>( 0, oldest * ring.bucketMicroseconds );
+
+    std::uint64_t blinks = 0;
+    std::array<std::uint64_t, INTERVAL_BINS> intervals = {};
+    std::uint64_t reminderMilliseconds = 0;
+    std::uint64_t restMilliseconds = 0;
+    for( std::size_t i = 0; i < ring.size; ++i )
+    {
+        Bucket const& bucket = ring.buckets[i];
+        std::int64_t number = bucket.number.load( std::memory_order_acquire );
+        if( number < oldest || number > newest )
+        {
+            continue;
+        }
+
+        std::uint32_t bucketBlinks = bucket.blinks.load( std::memory_order_relaxed );
+        std::array<std::uint32_t, INTERVAL_BINS> bucketIntervals;
+        for( std::size_t bin = 0; bin < INTERVAL_BINS; ++bin )
+        {
+            bucketIntervals[bin] = bucket.intervals[bin].load( std::memory_order_relaxed );
+        }
+        std::uint32_t bucketReminder = bucket.reminderMilliseconds.load( std::memory_order_relaxed );
+        std::uint32_t bucketRest = bucket.restMilliseconds.load( std::memory_order_relaxed );
+
+        // Discard the bucket if it was reused while being read
+        std::atomic_thread_fence( std::memory_order_acquire );
+        if( bucket.number.load( std::memory_order_relaxed ) != number )
+        {
+            continue;
+        }
+
+        blinks += bucketBlinks;
+        for( std::size_t bin = 0; bin < INTERVAL_BINS; ++bin )
+        {
+            intervals[bin] += bucketIntervals[bin];
+        }
+        reminderMilliseconds += bucketReminder;
+        restMilliseconds += bucketRest;
+    }
+
+    WindowStatistics statistics;
+    statistics.seconds = static_cast<double>( now - windowStart ) / MICROSECONDS_PER_SECOND;
+    statistics.blinks = blinks;
+    statistics.blinksPerMinute = statistics.seconds > 0.0 ? blinks * 60.0 / statistics.seconds : 0.0;
+
+    std::uint64_t intervalCount = 0;
+    for( std::uint64_t count : intervals )
+    {
+        intervalCount += count;
+    }
+    std::uint64_t seen = 0;
+    for( std::size_t bin = 0; bin < INTERVAL_BINS && intervalCount > 0; ++bin )
+    {
+        std::uint64_t previous = seen;
+        seen += intervals[bin];
+        if( previous <= intervalCount / 2 && seen > intervalCount / 2 )
+        {
+            statistics.medianInterval = IntervalBinMiddle( bin );
+        }
+        if( previous <= intervalCount * 9 / 10 && seen > intervalCount * 9 / 10 )
+        {
+            statistics.interval90 = IntervalBinMiddle( bin );
+        }
+    }
+
+    // Reminders and rests still going on are counted up to now
+    std::int64_t reminderStart = mReminderStart.load( std::memory_order_relaxed );
+    if( reminderStart >= 0 )
+    {
+        reminderMilliseconds += ( now - std::max( reminderStart, windowStart ) ) / 1000;
+    }
+    std::int64_t restStart = mRestStart.load( std::memory_order_relaxed );
+    if( restStart >= 0 )
+    {
+        restMilliseconds += ( now - std::max( restStart, windowStart ) ) / 1000;
+    }
+    statistics.reminderSeconds = std::min( reminderMilliseconds / 1000.0, statistics.seconds );
+    statistics.reminderShare = statistics.seconds > 0.0 ? statistics.reminderSeconds / statistics.seconds : 0.0;
+    statistics.restSeconds = std::min( restMilliseconds / 1000.0, statistics.seconds );
+    return statistics;
+}
+
+/**
+    @return microseconds since construction
+*/
+std::int64_t BlinkStatistics::Now() const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - mStart ).count();
+}
+
+/**
+    Finds the bucket of a ring holding a bucket number, clearing the oldest
+    bucket for it when time has moved on to a new bucket
+
+    @pre mRecordMutex is locked
+*/
+BlinkStatistics::Bucket& BlinkStatistics::Current( Ring& aRing, std::int64_t aNumber )
+{
+    Bucket& bucket = aRing.buckets[static_cast<std::size_t>( aNumber ) % aRing.size];
+    if( bucket.number.load( std::memory_order_relaxed ) == aNumber )
+    {
+        return bucket;
+    }
+
+    // Mark the bucket as being reused before clearing it, see Query
+    bucket.number.store( -1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+    bucket.blinks.store( 0, std::memory_order_relaxed );
+    for( std::atomic<std::uint32_t>& count : bucket.intervals )
+    {
+        count.store( 0, std::memory_order_relaxed );
+    }
+    bucket.reminderMilliseconds.store( 0, std::memory_order_relaxed );
+    bucket.restMilliseconds.store( 0, std::memory_order_relaxed );
+    bucket.number.store( aNumber, std::memory_order_release );
+    return bucket;
+}
+
+/**
+    Spreads a duration over the buckets of every window it overlaps
+
+    @pre mRecordMutex is locked
+*/
+void BlinkStatistics::AddDuration
+    (
+    std::atomic<std::uint32_t> Bucket::*aField,
+    std::int64_t aStart,
+    std::int64_t aEnd
+    )
+{
+    for( Ring& ring : mRings )
+    {
+        std::int64_t last = aEnd / ring.bucketMicroseconds;
+        std::int64_t first = std::max( aStart / ring.bucketMicroseconds, last - static_cast<std::int64_t>( ring.size ) + 1 );
+        for( std::int64_t number = first; number <= last; ++number )
+        {
+            std::int64_t overlap = std::min( aEnd, ( number + 1 ) * ring.bucketMicroseconds ) -
+                                   std::max( aStart, number * ring.bucketMicroseconds );
+            ( Current( ring, number ).*aField ).fetch_add( static_cast<std::uint32_t>( overlap / 1000 ), std::memory_order_relaxed );
+        }
+    }
+}
@@ -0,0 +1,64 @@
+/**
+    Definition of CameraSource
+*/
+
+#include "CameraSource.hpp"
+
+/**
+    Constructor
+*/
+CameraSource::CameraSource( int aDevice )
+    : mDevice( aDevice )
+{
+}
+
+/**
+    Opens the webcam
+
+    @return false if the webcam could not be opened
+*/
+bool CameraSource::Open()
+{
+    if( !mVideoCapture.open( mDevice ) )
+    {
+        return false;
+    }
+
+    // Keep the driver's own buffer short, freshness is handled by Monitor
+    mVideoCapture.set( cv::CAP_PROP_BUFFERSIZE, 1 );
+    mOpenTime = std::chrono::steady_clock::now();
+    return true;
+}
+
+/**
+    Releases the webcam
+*/
+void CameraSource::Close()
+{
+    mVideoCapture.release();
+}
+
+/**
+    Reads the next frame from the webcam
+
+    @return false if the webcam stopped delivering frames
+*/
+bool CameraSource::Read( Frame& aFrame )
+{
+    if( !mVideoCapture.read( aFrame.image ) || aFrame.image.empty() )
+    {
+        return false;
+    }
+
+    std::chrono::duration<double> sinceOpen = std::chrono::steady_clock::now() - mOpenTime;
+    aFrame.sourceTime = sinceOpen.count();
+    return true;
+}
+
+/**
+    @return true, frames arrive in real time
+*/
+bool CameraSource::IsLive() const
+{
+    return true;
+}
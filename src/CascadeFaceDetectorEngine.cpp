@@ -0,0 +1,104 @@
+/**
+    Definition of CascadeFaceDetectorEngine
+*/
+
+#include "CascadeFaceDetectorEngine.hpp"
+
+#include <filesystem>           // std::filesystem
+#include <opencv2/imgproc.hpp>  // cv::equalizeHist
+#include <vector>               // std::vector
+
+// Frontal face cascades shipped with OpenCV, relative to its data directory
+const char* HAAR_CASCADE = "haarcascades/haarcascade_frontalface_default.xml";
+const char* LBP_CASCADE = "lbpcascades/lbpcascade_frontalface_improved.xml";
+
+// Factor the search window grows by between scales, and the number of
+// overlapping detections a face needs to be kept
+const double SCALE_FACTOR = 1.1;
+const int MIN_NEIGHBORS = 3;
+// Smallest face searched for, half of dlib's 80x80 window since cascades
+// find smaller faces
+const cv::Size MIN_FACE_SIZE( 40, 40 );
+
+/**
+    Finds a cascade shipped with OpenCV in the data directory OpenCV was
+    installed to or the usual system directories
+
+    @return path of the cascade, empty if it was not found
+*/
+static std::filesystem::path FindCascade( std::string const& aName )
+{
+    std::vector<std::filesystem::path> directories;
+#ifdef BLINKPLEASE_OPENCV_DATA_DIR
+    directories.emplace_back( BLINKPLEASE_OPENCV_DATA_DIR );
+#endif
+    directories.emplace_back( "/usr/share/opencv4" );
+    directories.emplace_back( "/usr/local/share/opencv4" );
+    directories.emplace_back( "/usr/share/opencv" );
+
+    for( std::filesystem::path const& directory : directories )
+    {
+        std::error_code error;
+        if( std::filesystem::exists( directory / aName, error ) )
+        {
+            return directory / aName;
+        }
+    }
+    return std::filesystem::path();
+}
+
+/**
+    Constructor
+
+    @param aName "haar" or "lbp"
+*/
+CascadeFaceDetectorEngine::CascadeFaceDetectorEngine( std::string const& aName )
+    : mName( aName )
+{
+}
+
+/**
+    Loads a cascade
+
+    @param aPath cascade file, empty for the frontal face cascade shipped
+            with OpenCV
+
+    @return false if the cascade could not be found or loaded
+*/
+bool CascadeFaceDetectorEngine::Load( std::string const& aPath )
+{
+    std::filesystem::path path = aPath.empty()
+        ? FindCascade( mName == "lbp" ? LBP_CASCADE : HAAR_CASCADE )
+        : std::filesystem::path( aPath );
+    return !path.empty() && mCascade.load( path.string() );
+}
+
+/**
+    Detects faces in an 8 bit single channel image
+
+    @return rectangles of the faces found, in aImage coordinates
+*/
+std::vector<dlib::rectangle> CascadeFaceDetectorEngine::Detect( cv::Mat const& aImage )
+{
+    // The cascades were trained on equalised images
+    cv::equalizeHist( aImage, mEqualized );
+
+    std::vector<cv::Rect> found;
+    mCascade.detectMultiScale( mEqualized, found, SCALE_FACTOR, MIN_NEIGHBORS, 0, MIN_FACE_SIZE );
+
+    std::vector<dlib::rectangle> faces;
+    faces.reserve( found.size() );
+    for( cv::Rect const& face : found )
+    {
+        faces.emplace_back( face.x, face.y, face.x + face.width - 1, face.y + face.height - 1 );
+    }
+    return faces;
+}
+
+/**
+    @return "haar" or "lbp"
+*/
+char const* CascadeFaceDetectorEngine::Name() const
+{
+    return mName.c_str();
+}
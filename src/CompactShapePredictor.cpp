@@ -0,0 +1,440 @@
+/**
+    Definition of CompactShapePredictor
+*/
+
+#include "CompactShapePredictor.hpp"
+
+#include <cerrno>                                   // errno, EINTR
+#include <cstdio>                                   // std::rename, std::remove
+#include <cstdlib>                                  // mkstemp
+#include <cstring>                                  // std::memcmp, std::memcpy
+#include <dlib/image_processing/shape_predictor.h>  // dlib::impl::regression_tree, dlib::impl::unnormalizing_tform
+#include <fcntl.h>                                  // open
+#include <fstream>                                  // std::ifstream
+#include <sys/mman.h>                               // mmap, munmap, madvise
+#include <sys/stat.h>                               // stat, fstat, fchmod
+#include <unistd.h>                                 // close, write
+#include <vector>                                   // std::vector
+
+// Identifies cache files, bump CACHE_VERSION whenever the layout changes
+const char CACHE_MAGIC[8] = { 'B', 'L', 'I', 'N', 'K', 'S', 'P', '\0' };
+const std::uint32_t CACHE_VERSION = 1;
+
+// Version written by dlib's shape_predictor serialize
+const int DLIB_SHAPE_PREDICTOR_VERSION = 1;
+
+// Permissions of cache files, readable by every process that loads the model
+const mode_t CACHE_MODE = 0644;
+
+/**
+    Writes all of aSize bytes to a file, retrying short and interrupted writes
+
+    @return false if the write failed
+*/
+static bool WriteAll( int aFile, void const* aData, std::size_t aSize )
+{
+    char const* data = static_cast<char const*>( aData );
+    while( aSize > 0 )
+    {
+        ssize_t written = write( aFile, data, aSize );
+        if( written < 0 )
+        {
+            if( errno == EINTR )
+            {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        aSize -= static_cast<std::size_t>( written );
+    }
+    return true;
+}
+
+/**
+    Constructor
+*/
+CompactShapePredictor::CompactShapePredictor()
+    : mMapping( nullptr )
+    , mMappingSize( 0 )
+    , mNumParts( 0 )
+    , mNumCascades( 0 )
+    , mTreesPerCascade( 0 )
+    , mSplitsPerTree( 0 )
+    , mFeaturesPerCascade( 0 )
+    , mInitialShape( nullptr )
+    , mAnchorIdx( nullptr )
+    , mDeltas( nullptr )
+    , mSplits( nullptr )
+    , mLeafValues( nullptr )
+{
+}
+
+/**
+    Destructor
+*/
+CompactShapePredictor::~CompactShapePredictor()
+{
+    Unmap();
+}
+
+/**
+    Converts a serialized dlib shape predictor into a cache file
+
+    The forests of the model must be uniform, every cascade holding the same
+    number of trees of the same depth and the same number of feature pixels,
+    which is always the case for models produced by dlib's trainer. The cache
+    is written to a uniquely named temporary file next to it first, so
+    processes converting at the same time never interleave their writes and a
+    concurrent Map never sees a partially written cache.
+
+    @return false if the model could not be read or the cache not written
+*/
+bool CompactShapePredictor::Convert( std::string const& aModelPath, std::string const& aCachePath )
+{
+    struct stat modelStat;
+    if( stat( aModelPath.c_str(), &modelStat ) != 0 )
+    {
+        return false;
+    }
+
+    // Read the model in the order dlib's shape_predictor serializes it
+    int version = 0;
+    dlib::matrix<float, 0, 1> initialShape;
+    std::vector<std::vector<dlib::impl::regression_tree>> forests;
+    std::vector<std::vector<unsigned long>> anchorIdx;
+    std::vector<std::vector<dlib::vector<float, 2>>> deltas;
+    try
+    {
+        std::ifstream model( aModelPath, std::ios::binary );
+        dlib::deserialize( version, model );
+        dlib::deserialize( initialShape, model );
+        dlib::deserialize( forests, model );
+        dlib::deserialize( anchorIdx, model );
+        dlib::deserialize( deltas, model );
+    }
+    catch( dlib::serialization_error const& )
+    {
+        return false;
+    }
+
+    if( version != DLIB_SHAPE_PREDICTOR_VERSION || forests.empty() || forests[0].empty() ||
+        anchorIdx.size() != forests.size() || deltas.size() != forests.size() )
+    {
+        return false;
+    }
+
+    Header header;
+    std::memcpy( header.magic, CACHE_MAGIC, sizeof( header.magic ) );
+    header.version = CACHE_VERSION;
+    header.numParts = static_cast<std::uint32_t>( initialShape.size() / 2 );
+    header.numCascades = static_cast<std::uint32_t>( forests.size() );
+    header.treesPerCascade = static_cast<std::uint32_t>( forests[0].size() );
+    header.splitsPerTree = static_cast<std::uint32_t>( forests[0][0].splits.size() );
+    header.featuresPerCascade = static_cast<std::uint32_t>( anchorIdx[0].size() );
+    header.modelSize = static_cast<std::uint64_t>( modelStat.st_size );
+    header.modelModifiedTime = static_cast<std::int64_t>( modelStat.st_mtime );
+
+    // Flatten every array, checking the forests are uniform along the way
+    std::vector<float> shapeValues( initialShape.begin(), initialShape.end() );
+    std::vector<std::uint32_t> anchorValues;
+    std::vector<float> deltaValues;
+    std::vector<Split> splitValues;
+    std::vector<float> leafValues;
+
+    for( std::size_t cascade = 0; cascade < forests.size(); ++cascade )
+    {
+        if( forests[cascade].size() != header.treesPerCascade ||
+            anchorIdx[cascade].size() != header.featuresPerCascade ||
+            deltas[cascade].size() != header.featuresPerCascade )
+        {
+            return false;
+        }
+
+        for( std::size_t feature = 0; feature < header.featuresPerCascade; ++feature )
+        {
+            anchorValues.push_back( static_cast<std::uint32_t>( anchorIdx[cascade][feature] ) );
+            deltaValues.push_back( deltas[cascade][feature].x() );
+            deltaValues.push_back( deltas[cascade][feature].y() );
+        }
+
+        for( dlib::impl::regression_tree const& tree : forests[cascade] )
+        {
+            if( tree.splits.size() != header.splitsPerTree ||
+                tree.leaf_values.size() != header.splitsPerTree + 1 )
+            {
+                return false;
+            }
+
+            for( dlib::impl::split_feature const& split : tree.splits )
+            {
+                splitValues.push_back
+                    (
+                    Split
+                        {
+                        static_cast<std::uint32_t>( split.idx1 ),
+                        static_cast<std::uint32_t>( split.idx2 ),
+                        split.thresh
+                        }
+                    );
+            }
+
+            for( dlib::matrix<float, 0, 1> const& leaf : tree.leaf_values )
+            {
+                if( static_cast<std::size_t>( leaf.size() ) != shapeValues.size() )
+                {
+                    return false;
+                }
+                leafValues.insert( leafValues.end(), leaf.begin(), leaf.end() );
+            }
+        }
+    }
+
+    std::string temporaryPath = aCachePath + ".XXXXXX";
+    int file = mkstemp( &temporaryPath[0] );
+    if( file < 0 )
+    {
+        return false;
+    }
+
+    bool written = fchmod( file, CACHE_MODE ) == 0 &&
+        WriteAll( file, &header, sizeof( header ) ) &&
+        WriteAll( file, shapeValues.data(), shapeValues.size() * sizeof( float ) ) &&
+        WriteAll( file, anchorValues.data(), anchorValues.size() * sizeof( std::uint32_t ) ) &&
+        WriteAll( file, deltaValues.data(), deltaValues.size() * sizeof( float ) ) &&
+        WriteAll( file, splitValues.data(), splitValues.size() * sizeof( Split ) ) &&
+        WriteAll( file, leafValues.data(), leafValues.size() * sizeof( float ) );
+    written = close( file ) == 0 && written;
+
+    if( !written || std::rename( temporaryPath.c_str(), aCachePath.c_str() ) != 0 )
+    {
+        std::remove( temporaryPath.c_str() );
+        return false;
+    }
+    return true;
+}
+
+/**
+    Maps a cache file written by Convert
+
+    @param aCachePath cache file to map
+    @param aModelPath model the cache was converted from, the cache is rejected
+            if the model has changed since, empty skips the check
+
+    @return false if the cache is missing, stale or invalid
+*/
+bool CompactShapePredictor::Map( std::string const& aCachePath, std::string const& aModelPath )
+{
+    Unmap();
+
+    int file = open( aCachePath.c_str(), O_RDONLY | O_CLOEXEC );
+    if( file < 0 )
+    {
+        return false;
+    }
+
+    struct stat cacheStat;
+    if( fstat( file, &cacheStat ) != 0 || static_cast<std::size_t>( cacheStat.st_size ) < sizeof( Header ) )
+    {
+        close( file );
+        return false;
+    }
+
+    // Read only shared mapping, the page cache keeps a single copy for all processes
+    std::size_t size = static_cast<std::size_t>( cacheStat.st_size );
+    void* mapping = mmap( nullptr, size, PROT_READ, MAP_SHARED, file, 0 );
+    close( file );
+    if( mapping == MAP_FAILED )
+    {
+        return false;
+    }
+
+    Header const* header = static_cast<Header const*>( mapping );
+    bool valid = std::memcmp( header->magic, CACHE_MAGIC, sizeof( CACHE_MAGIC ) ) == 0 &&
+                 header->version == CACHE_VERSION;
+
+    struct stat modelStat;
+    if( valid && !aModelPath.empty() )
+    {
+        valid = stat( aModelPath.c_str(), &modelStat ) == 0 &&
+                header->modelSize == static_cast<std::uint64_t>( modelStat.st_size ) &&
+                header->modelModifiedTime == static_cast<std::int64_t>( modelStat.st_mtime );
+    }
+
+    std::size_t shapeSize = 2 * static_cast<std::size_t>( header->numParts );
+    std::size_t features = static_cast<std::size_t>( header->numCascades ) * header->featuresPerCascade;
+    std::size_t trees = static_cast<std::size_t>( header->numCascades ) * header->treesPerCascade;
+    std::size_t expectedSize = sizeof( Header ) +
+                               shapeSize * sizeof( float ) +
+                               features * ( sizeof( std::uint32_t ) + 2 * sizeof( float ) ) +
+                               trees * header->splitsPerTree * sizeof( Split ) +
+                               trees * ( header->splitsPerTree + 1 ) * shapeSize * sizeof( float );
+    if( !valid || size != expectedSize )
+    {
+        munmap( mapping, size );
+        return false;
+    }
+
+    // Start reading pages in now rather than on the first fitted face
+    madvise( mapping, size, MADV_WILLNEED );
+
+    mMapping = mapping;
+    mMappingSize = size;
+    mNumParts = header->numParts;
+    mNumCascades = header->numCascades;
+    mTreesPerCascade = header->treesPerCascade;
+    mSplitsPerTree = header->splitsPerTree;
+    mFeaturesPerCascade = header->featuresPerCascade;
+
+    char const* next = static_cast<char const*>( mapping ) + sizeof( Header );
+    mInitialShape = reinterpret_cast<float const*>( next );
+    next += shapeSize * sizeof( float );
+    mAnchorIdx = reinterpret_cast<std::uint32_t const*>( next );
+    next += features * sizeof( std::uint32_t );
+    mDeltas = reinterpret_cast<float const*>( next );
+    next += features * 2 * sizeof( float );
+    mSplits = reinterpret_cast<Split const*>( next );
+    next += trees * mSplitsPerTree * sizeof( Split );
+    mLeafValues = reinterpret_cast<float const*>( next );
+
+    return true;
+}
+
+/**
+    Releases the mapped cache file
+*/
+void CompactShapePredictor::Unmap()
+{
+    if( mMapping != nullptr )
+    {
+        munmap( mMapping, mMappingSize );
+    }
+
+    mMapping = nullptr;
+    mMappingSize = 0;
+    mNumParts = 0;
+}
+
+/**
+    Fits landmarks to a face, following dlib::shape_predictor
+
+    Each cascade maps its feature pixels from the mean shape onto the current
+    estimate of the shape with the similarity transform between the two,
+    samples their intensities and adds the leaf each tree selects to the shape.
+
+    The shape transforms are dlib's own, so every feature pixel and landmark
+    is rounded exactly as dlib rounds it.
+
+    @pre a cache has been mapped
+
+    @return landmarks of the face in image coordinates
+*/
+dlib::full_object_detection CompactShapePredictor::Fit( cv::Mat const& aImage, dlib::rectangle const& aFace ) const
+{
+    std::size_t shapeSize = 2 * mNumParts;
+
+    // Reused between calls, each thread fitting faces has its own buffers
+    thread_local std::vector<float> shape;
+    thread_local std::vector<float> featurePixels;
+    thread_local std::vector<dlib::vector<float, 2>> fromPoints;
+    thread_local std::vector<dlib::vector<float, 2>> toPoints;
+    shape.assign( mInitialShape, mInitialShape + shapeSize );
+    featurePixels.resize( mFeaturesPerCascade );
+    fromPoints.resize( mNumParts );
+    toPoints.resize( mNumParts );
+    for( unsigned long part = 0; part < mNumParts; ++part )
+    {
+        fromPoints[part] = dlib::vector<float, 2>( mInitialShape[2 * part], mInitialShape[2 * part + 1] );
+    }
+
+    // Maps the unit square onto the face rectangle
+    dlib::point_transform_affine const toImage = dlib::impl::unnormalizing_tform( aFace );
+
+    float const* leafValues = mLeafValues;
+    Split const* splits = mSplits;
+
+    for( unsigned long cascade = 0; cascade < mNumCascades; ++cascade )
+    {
+        // Least squares similarity transform from the mean shape to the current
+        // shape, the identity for a single landmark as in dlib
+        dlib::matrix<float, 2, 2> transform = dlib::identity_matrix<float>( 2 );
+        if( mNumParts > 1 )
+        {
+            for( unsigned long part = 0; part < mNumParts; ++part )
+            {
+                toPoints[part] = dlib::vector<float, 2>( shape[2 * part], shape[2 * part + 1] );
+            }
+            transform = dlib::matrix_cast<float>( dlib::find_similarity_transform( fromPoints, toPoints ).get_m() );
+        }
+
+        // Sample feature pixels relative to their anchor landmarks
+        std::uint32_t const* anchors = mAnchorIdx + cascade * mFeaturesPerCascade;
+        float const* deltas = mDeltas + cascade * mFeaturesPerCascade * 2;
+        for( unsigned long feature = 0; feature < mFeaturesPerCascade; ++feature )
+        {
+            dlib::vector<float, 2> delta( deltas[2 * feature], deltas[2 * feature + 1] );
+            dlib::vector<float, 2> anchor( shape[2 * anchors[feature]], shape[2 * anchors[feature] + 1] );
+            dlib::point pixel = toImage( transform * delta + anchor );
+            featurePixels[feature] = FeaturePixel( aImage, pixel.x(), pixel.y() );
+        }
+
+        // Walk every tree down to a leaf and add its shape update, taking the
+        // left child when the pixel difference exceeds the threshold
+        for( unsigned long tree = 0; tree < mTreesPerCascade; ++tree )
+        {
+            unsigned long node = 0;
+            while( node < mSplitsPerTree )
+            {
+                Split const& split = splits[node];
+                node = ( featurePixels[split.idx1] - featurePixels[split.idx2] > split.thresh ) ? 2 * node + 1 : 2 * node + 2;
+            }
+
+            float const* leaf = leafValues + ( node - mSplitsPerTree ) * shapeSize;
+            for( std::size_t i = 0; i < shapeSize; ++i )
+            {
+                shape[i] += leaf[i];
+            }
+
+            splits += mSplitsPerTree;
+            leafValues += ( mSplitsPerTree + 1 ) * shapeSize;
+        }
+    }
+
+    std::vector<dlib::point> parts( mNumParts );
+    for( unsigned long part = 0; part < mNumParts; ++part )
+    {
+        parts[part] = toImage( dlib::vector<float, 2>( shape[2 * part], shape[2 * part + 1] ) );
+    }
+    return dlib::full_object_detection( aFace, parts );
+}
+
+/**
+    @return number of landmarks fitted, 0 if no cache is mapped
+*/
+unsigned long CompactShapePredictor::NumParts() const
+{
+    return mNumParts;
+}
+
+/**
+    Reads the intensity of a pixel the way dlib does, averaging the colour
+    channels of colour images
+
+    @return intensity of the pixel, 0 if it lies outside the image
+*/
+float CompactShapePredictor::FeaturePixel( cv::Mat const& aImage, long aX, long aY ) const
+{
+    if( aX < 0 || aY < 0 || aX >= aImage.cols || aY >= aImage.rows )
+    {
+        return 0.0f;
+    }
+
+    unsigned char const* row = aImage.ptr<unsigned char>( static_cast<int>( aY ) );
+    if( aImage.channels() == 1 )
+    {
+        return row[aX];
+    }
+
+    unsigned char const* pixel = row + aX * aImage.channels();
+    return static_cast<float>( ( pixel[0] + pixel[1] + pixel[2] ) / 3 );
+}
@@ -0,0 +1,219 @@
+/**
+    Definition of ControlServer
+*/
+
+#include "ControlServer.hpp"
+
+#include <cstdint>          // std::uint64_t
+#include <poll.h>           // poll
+#include <sys/eventfd.h>    // eventfd
+#include <sys/socket.h>     // socket, bind, listen, accept4, recv, send
+#include <sys/stat.h>       // chmod, lstat
+#include <sys/un.h>         // sockaddr_un
+#include <unistd.h>         // close, unlink, write
+
+// Clients served at once, further clients are turned away
+const std::size_t MAX_CLIENTS = 8;
+// Longest command accepted, clients sending longer lines are disconnected
+const std::size_t MAX_COMMAND_BYTES = 1024;
+
+/**
+    Removes a socket left behind at aPath by an earlier run. Anything else at
+    aPath is kept, so binding to it fails rather than deleting a user's file.
+*/
+static void RemoveStaleSocket( std::string const& aPath )
+{
+    struct stat status;
+    if( lstat( aPath.c_str(), &status ) == 0 && S_ISSOCK( status.st_mode ) )
+    {
+        unlink( aPath.c_str() );
+    }
+}
+
+/**
+    Constructor
+
+    @param aHandler called on the server thread with each command received
+*/
+ControlServer::ControlServer( std::string const& aSocketPath, Handler aHandler )
+    : mSocketPath( aSocketPath )
+    , mHandler( aHandler )
+    , mSocket( -1 )
+    , mWakeEvent( -1 )
+    , mExitServer( false )
+{
+}
+
+/**
+    Destructor
+*/
+ControlServer::~ControlServer()
+{
+    Stop();
+}
+
+/**
+    Opens the socket and starts the server thread
+
+    @return false if the socket could not be opened
+*/
+bool ControlServer::Start()
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if( mSocketPath.size() >= sizeof( address.sun_path ) )
+    {
+        return false;
+    }
+    mSocketPath.copy( address.sun_path, mSocketPath.size() );
+    RemoveStaleSocket( mSocketPath );
+
+    // Only a socket this server bound is removed when opening it fails
+    mSocket = socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+    bool bound = mSocket >= 0 &&
+        bind( mSocket, reinterpret_cast<sockaddr*>( &address ), sizeof( address ) ) == 0;
+    if( !bound ||
+        chmod( mSocketPath.c_str(), S_IRUSR | S_IWUSR ) != 0 ||
+        listen( mSocket, 4 ) != 0 )
+    {
+        if( mSocket >= 0 )
+        {
+            close( mSocket );
+            mSocket = -1;
+        }
+        if( bound )
+        {
+            unlink( mSocketPath.c_str() );
+        }
+        return false;
+    }
+
+    mWakeEvent = eventfd( 0, EFD_CLOEXEC );
+    mExitServer = false;
+    mThread = std::thread( &ControlServer::Serve, this );
+    return true;
+}
+
+/**
+    Wakes up and exits the server thread, disconnecting every client
+*/
+void ControlServer::Stop()
+{
+    if( !mThread.joinable() )
+    {
+        return;
+    }
+
+    mExitServer = true;
+    std::uint64_t wake = 1;
+    ssize_t written = write( mWakeEvent, &wake, sizeof( wake ) );
+    (void)written;
+    mThread.join();
+
+    for( Client& client : mClients )
+    {
+        close( client.socket );
+    }
+    mClients.clear();
+
+    close( mSocket );
+    unlink( mSocketPath.c_str() );
+    mSocket = -1;
+    close( mWakeEvent );
+    mWakeEvent = -1;
+}
+
+/**
+    @return path of the socket
+*/
+std::string const& ControlServer::SocketPath() const
+{
+    return mSocketPath;
+}
+
+/**
+    Accepts clients and answers their commands until woken up to exit
+*/
+void ControlServer::Serve()
+{
+    std::vector<pollfd> descriptors;
+    while( !mExitServer )
+    {
+        descriptors.assign( { { mWakeEvent, POLLIN, 0 }, { mSocket, POLLIN, 0 } } );
+        for( Client const& client : mClients )
+        {
+            descriptors.push_back( { client.socket, POLLIN, 0 } );
+        }
+        poll( descriptors.data(), descriptors.size(), -1 );
+
+        if( descriptors[0].revents & POLLIN )
+        {
+            break;
+        }
+
+        // Clients are served before accepting, so the descriptors still match mClients
+        std::size_t clientCount = mClients.size();
+        for( std::size_t i = clientCount; i > 0; --i )
+        {
+            if( descriptors[i + 1].revents != 0 && !Receive( mClients[i - 1] ) )
+            {
+                close( mClients[i - 1].socket );
+                mClients.erase( mClients.begin() + ( i - 1 ) );
+            }
+        }
+
+        if( descriptors[1].revents & POLLIN )
+        {
+            int client = accept4( mSocket, nullptr, nullptr, SOCK_CLOEXEC );
+            if( client >= 0 && mClients.size() < MAX_CLIENTS )
+            {
+                mClients.push_back( Client{ client, std::string() } );
+            }
+            else if( client >= 0 )
+            {
+                std::string busy = "error too many clients\n";
+                send( client, busy.data(), busy.size(), MSG_NOSIGNAL );
+                close( client );
+            }
+        }
+    }
+}
+
+/**
+    Reads what a client sent and answers every complete command
+
+    @return false if the client disconnected or misbehaved and is to be closed
+*/
+bool ControlServer::Receive( Client& aClient )
+{
+    char buffer[512];
+    ssize_t received = recv( aClient.socket, buffer, sizeof( buffer ), 0 );
+    if( received <= 0 )
+    {
+        return false;
+    }
+    aClient.input.append( buffer, received );
+
+    std::string::size_type end;
+    while( ( end = aClient.input.find( '\n' ) ) != std::string::npos )
+    {
+        std::string command = aClient.input.substr( 0, end );
+        aClient.input.erase( 0, end + 1 );
+        if( !command.empty() && command.back() == '\r' )
+        {
+            command.pop_back();
+        }
+        if( command.empty() )
+        {
+            continue;
+        }
+
+        // Clients that stop reading are dropped rather than blocking the server
+        std::string answer = mHandler( command );
+        if( send( aClient.socket, answer.data(), answer.size(), MSG_NOSIGNAL | MSG_DONTWAIT ) != static_cast<ssize_t>( answer.size() ) )
+        {
+            return false;
+        }
+    }
+    return aClient.input.size() <= MAX_COMMAND_BYTES;
+}
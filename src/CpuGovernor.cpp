@@ -0,0 +1,318 @@
+/**
+    Definition of CpuGovernor
+*/
+
+#include "CpuGovernor.hpp"
+
+#include <algorithm>    // std::min, std::max
+#include <cmath>        // std::abs, std::pow
+#include <ctime>        // std::clock
+#include <iomanip>      // std::setprecision
+#include <iostream>     // std::cout
+
+// Seconds between measurements of the CPU time used
+const double CONTROL_PERIOD_SECONDS = 2.0;
+
+// Blinks last 100 to 400 ms, below this rate they are missed, so detection is
+// made cheaper instead of processing fewer frames
+const double MIN_FRAME_RATE = 10.0;
+// Fraction of the target frame rate processed right after a blink
+const double MIN_URGENCY = 0.25;
+
+// Detector settings are relaxed again once less than this share of the budget is used
+const double RELAX_BUDGET_FRACTION = 0.5;
+// Most frames the tracked face is reused for before detecting again
+const unsigned int MAX_DETECTION_STRIDE = 30;
+// Factor the detection scale is reduced by in each step, and the narrowest
+// frame faces are detected in
+const double SCALE_STEP = 0.8;
+const double MIN_DETECTION_WIDTH = 320.0;
+// Relative change of the afforded frame rate that is logged
+const double LOG_FRAME_RATE_CHANGE = 0.2;
+
+/**
+    @return CPU time used by the process in seconds
+*/
+static double ProcessCpuSeconds()
+{
+    return static_cast<double>( std::clock() ) / CLOCKS_PER_SEC;
+}
+
+/**
+    Constructor
+
+    @param aSettings cpuBudget, maxFrameRate, blinkInterval and faceDetectionStride are used
+*/
+CpuGovernor::CpuGovernor( MonitorSettings const& aSettings )
+    : mCpuBudget( std::max( aSettings.cpuBudget, 0.0 ) )
+    , mMaxFrameRate( std::max( aSettings.maxFrameRate, 0.0 ) )
+    , mBlinkInterval( std::max( aSettings.blinkInterval, 0 ) )
+    , mConfiguredStride( aSettings.faceDetectionStride )
+    , mStride( mConfiguredStride )
+    , mScaleSteps( 0 )
+    , mStarted( false )
+    , mBudgetFrameRate( 0.0 )
+    , mLoggedFrameRate( 0.0 )
+    , mPeriodCpuSeconds( 0.0 )
+    , mPeriodFrames( 0 )
+    , mLastBlink( std::chrono::steady_clock::now().time_since_epoch().count() )
+{
+}
+
+/**
+    Adds a camera, cameras are numbered from 0 in the order they are added
+
+    @param aFaceDetector detector whose scale is lowered when over budget
+    @param aFaceTracker tracker whose detection stride is raised when over budget
+*/
+void CpuGovernor::AddCamera( FaceDetector& aFaceDetector, FaceTracker& aFaceTracker )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mCameras.push_back( Camera{ &aFaceDetector, &aFaceTracker, aFaceDetector.Scale(), 0.0, 0.0, {} } );
+}
+
+/**
+    @return true if a CPU budget or frame rate limit is set
+*/
+bool CpuGovernor::Enabled() const
+{
+    return mCpuBudget > 0.0 || mMaxFrameRate > 0.0;
+}
+
+/**
+    Decides whether a captured frame is processed, and adjusts the detector
+    settings once every control period
+
+    @param aCamera camera the frame was captured by
+
+    @return false if the frame should be skipped
+*/
+bool CpuGovernor::OnFrame( std::size_t aCamera, Frame const& aFrame )
+{
+    if( !Enabled() )
+    {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock( mMutex );
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    Camera& camera = mCameras[aCamera];
+    if( camera.baseScale == 0.0 )
+    {
+        // First frame of the camera, the automatic detection scale depends on the frame size
+        camera.baseScale = camera.faceDetector->ScaleFor( aFrame.image );
+        camera.minScale = std::min( camera.baseScale, MIN_DETECTION_WIDTH / std::max( aFrame.image.cols, 1 ) );
+        camera.nextFrameTime = now;
+        ApplyScale( camera );
+    }
+
+    if( !mStarted )
+    {
+        mStarted = true;
+        mPeriodStart = now;
+        mPeriodCpuSeconds = ProcessCpuSeconds();
+    }
+    else if( std::chrono::duration<double>( now - mPeriodStart ).count() >= CONTROL_PERIOD_SECONDS )
+    {
+        Control( now );
+    }
+
+    double frameRate = TargetFrameRate( now );
+    if( frameRate > 0.0 )
+    {
+        if( now < camera.nextFrameTime )
+        {
+            return false;
+        }
+
+        // Frames arrive on the camera's schedule, so the next frame is due one
+        // interval after this one was due rather than after it arrived
+        camera.nextFrameTime = std::max
+            (
+            camera.nextFrameTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>
+                (
+                std::chrono::duration<double>( 1.0 / frameRate )
+                ),
+            now
+            );
+    }
+
+    ++mPeriodFrames;
+    return true;
+}
+
+/**
+    Records a blink, frames are processed at a lower rate for a while after
+*/
+void CpuGovernor::OnUserBlinked()
+{
+    mLastBlink = std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+/**
+    Changes the blink interval the frame rate ramps up to the full rate over
+*/
+void CpuGovernor::SetBlinkInterval( int aBlinkInterval )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mBlinkInterval = std::max( aBlinkInterval, 0 );
+}
+
+/**
+    Measures the CPU share used over the last control period, updates the
+    frame rate the budget affords and changes the detector settings when
+    the lowest useful frame rate is over budget or there is room again
+*/
+void CpuGovernor::Control( std::chrono::steady_clock::time_point aNow )
+{
+    double cpuSeconds = ProcessCpuSeconds();
+    double usedSeconds = cpuSeconds - mPeriodCpuSeconds;
+    double cpuShare = usedSeconds / std::chrono::duration<double>( aNow - mPeriodStart ).count();
+    unsigned long frames = mPeriodFrames;
+
+    mPeriodStart = aNow;
+    mPeriodCpuSeconds = cpuSeconds;
+    mPeriodFrames = 0;
+
+    if( mCpuBudget <= 0.0 || frames == 0 || usedSeconds <= 0.0 )
+    {
+        return;
+    }
+
+    // Split evenly between the cameras and averaged with the previous
+    // estimate to damp the effect of a single period
+    double affordedFrameRate = mCpuBudget * frames / usedSeconds / mCameras.size();
+    mBudgetFrameRate = mBudgetFrameRate > 0.0
+        ? ( mBudgetFrameRate + affordedFrameRate ) / 2.0
+        : affordedFrameRate;
+
+    bool changed = false;
+    if( affordedFrameRate < MIN_FRAME_RATE && cpuShare > mCpuBudget )
+    {
+        changed = Degrade();
+    }
+    else if( cpuShare < mCpuBudget * RELAX_BUDGET_FRACTION )
+    {
+        changed = Relax();
+    }
+
+    if( changed || std::abs( mBudgetFrameRate - mLoggedFrameRate ) > LOG_FRAME_RATE_CHANGE * mLoggedFrameRate )
+    {
+        std::cout << std::fixed << std::setprecision( 2 )
+                  << "Governor: cpu " << cpuShare * 100.0 << "% of " << mCpuBudget * 100.0 << "% budget, "
+                  << mBudgetFrameRate << " frames/s affordable per camera, "
+                  << "detection stride " << mStride << ", detection scale factor "
+                  << std::pow( SCALE_STEP, mScaleSteps )
+                  << std::defaultfloat << std::endl;
+        mLoggedFrameRate = mBudgetFrameRate;
+    }
+}
+
+/**
+    Makes each frame cheaper, first by reusing the tracked face for more
+    frames and then by detecting faces on smaller frames
+
+    @return false if the detector settings are already as cheap as allowed
+*/
+bool CpuGovernor::Degrade()
+{
+    if( mStride < MAX_DETECTION_STRIDE )
+    {
+        mStride = std::min( mStride + std::max( mStride / 2, 1u ), MAX_DETECTION_STRIDE );
+        for( Camera const& camera : mCameras )
+        {
+            camera.faceTracker->SetDetectionStride( mStride );
+        }
+        return true;
+    }
+
+    double scaleFactor = std::pow( SCALE_STEP, mScaleSteps );
+    for( Camera const& camera : mCameras )
+    {
+        if( camera.baseScale * scaleFactor > camera.minScale )
+        {
+            ++mScaleSteps;
+            for( Camera const& scaled : mCameras )
+            {
+                ApplyScale( scaled );
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+    Undoes Degrade one step at a time, in reverse order, until the settings
+    requested by the user are reached
+
+    @return false if the detector settings are already those requested
+*/
+bool CpuGovernor::Relax()
+{
+    if( mScaleSteps > 0 )
+    {
+        --mScaleSteps;
+        for( Camera const& camera : mCameras )
+        {
+            ApplyScale( camera );
+        }
+        return true;
+    }
+
+    if( mStride > mConfiguredStride )
+    {
+        mStride = std::max( mStride * 2 / 3, mConfiguredStride );
+        for( Camera const& camera : mCameras )
+        {
+            camera.faceTracker->SetDetectionStride( mStride );
+        }
+        return true;
+    }
+
+    return false;
+}
+
+/**
+    Sets the detection scale of a camera that has delivered a frame to its
+    base scale reduced mScaleSteps times
+*/
+void CpuGovernor::ApplyScale( Camera const& aCamera )
+{
+    if( aCamera.baseScale == 0.0 )
+    {
+        return;
+    }
+
+    // Back at the start, which may be the automatic scale
+    aCamera.faceDetector->SetScale
+        (
+        mScaleSteps > 0
+            ? std::max( aCamera.baseScale * std::pow( SCALE_STEP, mScaleSteps ), aCamera.minScale )
+            : aCamera.configuredScale
+        );
+}
+
+/**
+    @return frame rate frames of each camera should be processed at now, 0 for no limit
+*/
+double CpuGovernor::TargetFrameRate( std::chrono::steady_clock::time_point aNow ) const
+{
+    double frameRate = mMaxFrameRate;
+    if( mBudgetFrameRate > 0.0 )
+    {
+        frameRate = frameRate > 0.0 ? std::min( frameRate, mBudgetFrameRate ) : mBudgetFrameRate;
+    }
+
+    if( frameRate <= 0.0 || mBlinkInterval <= 0.0 )
+    {
+        return frameRate;
+    }
+
+    // Sample slowly right after a blink and at the full rate once a reminder is due
+    std::chrono::steady_clock::time_point lastBlink{ std::chrono::steady_clock::duration( mLastBlink.load() ) };
+    double sinceBlink = std::chrono::duration<double>( aNow - lastBlink ).count();
+    double urgency = std::min( std::max( sinceBlink / mBlinkInterval, MIN_URGENCY ), 1.0 );
+    return std::max( frameRate * urgency, std::min( frameRate, MIN_FRAME_RATE ) );
+}
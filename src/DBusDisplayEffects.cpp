@@ -0,0 +1,155 @@
+/**
+    Definition of DBusDisplayEffects
+*/
+
+#include "DBusDisplayEffects.hpp"
+
+#ifdef BLINKPLEASE_HAVE_GIO
+#include <gio/gio.h>    // GSettings, GDBusConnection
+#endif
+
+// Settings schema and keys of the night light
+const char* COLOR_SCHEMA = "org.gnome.settings-daemon.plugins.color";
+const char* NIGHT_LIGHT_ENABLED_KEY = "night-light-enabled";
+const char* NIGHT_LIGHT_TEMPERATURE_KEY = "night-light-temperature";
+
+// Desktop notification service
+const char* NOTIFICATIONS_NAME = "org.freedesktop.Notifications";
+const char* NOTIFICATIONS_PATH = "/org/freedesktop/Notifications";
+const char* APPLICATION_NAME = "BlinkPlease";
+// Urgency hint of critical notifications
+const unsigned char URGENCY_CRITICAL = 2;
+
+/**
+    Constructor
+
+    Looks up the colour schema first, GSettings aborts the process when asked
+    for a schema that is not installed.
+*/
+DBusDisplayEffects::DBusDisplayEffects()
+    : mColorSettings( nullptr )
+    , mSessionBus( nullptr )
+{
+#ifdef BLINKPLEASE_HAVE_GIO
+    GSettingsSchemaSource* schemas = g_settings_schema_source_get_default();
+    GSettingsSchema* schema = schemas ? g_settings_schema_source_lookup( schemas, COLOR_SCHEMA, TRUE ) : nullptr;
+    if( schema )
+    {
+        mColorSettings = g_settings_new( COLOR_SCHEMA );
+        g_settings_schema_unref( schema );
+
+        // Changes are held back until applied, so both keys change together
+        g_settings_delay( mColorSettings );
+    }
+
+    mSessionBus = g_bus_get_sync( G_BUS_TYPE_SESSION, nullptr, nullptr );
+#endif
+}
+
+/**
+    Destructor
+
+    Waits for pending setting changes to be written before disconnecting.
+*/
+DBusDisplayEffects::~DBusDisplayEffects()
+{
+#ifdef BLINKPLEASE_HAVE_GIO
+    if( mColorSettings )
+    {
+        g_settings_sync();
+        g_object_unref( mColorSettings );
+    }
+
+    if( mSessionBus )
+    {
+        g_dbus_connection_flush_sync( mSessionBus, nullptr, nullptr );
+        g_object_unref( mSessionBus );
+    }
+#endif
+}
+
+/**
+    @return true if the night light settings and the session bus can be reached
+*/
+bool DBusDisplayEffects::IsAvailable() const
+{
+    return mColorSettings && mSessionBus;
+}
+
+/**
+    Sets the state of the desktop night light
+*/
+void DBusDisplayEffects::NightLight( bool aTurnOn, int aTemperature )
+{
+#ifdef BLINKPLEASE_HAVE_GIO
+    if( !mColorSettings )
+    {
+        return;
+    }
+
+    if( aTemperature > 0 )
+    {
+        g_settings_set_uint( mColorSettings, NIGHT_LIGHT_TEMPERATURE_KEY, static_cast<guint>( aTemperature ) );
+    }
+    g_settings_set_boolean( mColorSettings, NIGHT_LIGHT_ENABLED_KEY, aTurnOn );
+    g_settings_apply( mColorSettings );
+#else
+    (void)aTurnOn;
+    (void)aTemperature;
+#endif
+}
+
+/**
+    Sends a critical notification to the user
+*/
+void DBusDisplayEffects::Notify( std::string const& aMessage, int aTimeout )
+{
+#ifdef BLINKPLEASE_HAVE_GIO
+    if( !mSessionBus )
+    {
+        return;
+    }
+
+    GVariantBuilder hints;
+    g_variant_builder_init( &hints, G_VARIANT_TYPE( "a{sv}" ) );
+    g_variant_builder_add( &hints, "{sv}", "urgency", g_variant_new_byte( URGENCY_CRITICAL ) );
+
+    g_dbus_connection_call
+        (
+        mSessionBus,
+        NOTIFICATIONS_NAME,
+        NOTIFICATIONS_PATH,
+        NOTIFICATIONS_NAME,
+        "Notify",
+        g_variant_new
+            (
+            "(susssasa{sv}i)",
+            APPLICATION_NAME,
+            0u,
+            "",
+            aMessage.c_str(),
+            "",
+            nullptr,
+            &hints,
+            aTimeout * 1000
+            ),
+        nullptr,
+        G_DBUS_CALL_FLAGS_NONE,
+        -1,
+        nullptr,
+        nullptr,
+        nullptr
+        );
+#else
+    (void)aMessage;
+    (void)aTimeout;
+#endif
+}
+
+/**
+    @return "dbus"
+*/
+char const* DBusDisplayEffects::Name() const
+{
+    return "dbus";
+}
@@ -0,0 +1,197 @@
+/**
+    Definition of DisplayActuator
+*/
+
+#include "DisplayActuator.hpp"
+
+#include <chrono>   // std::chrono::milliseconds
+
+// Changes arriving within this time of each other are applied together
+const std::chrono::milliseconds SETTLE_TIME( 20 );
+
+/**
+    Constructor
+
+    @param aDisplayEffects backend that changes the desktop
+    @param aMetrics counts applied and skipped night light changes
+*/
+DisplayActuator::DisplayActuator( std::unique_ptr<DisplayEffects> aDisplayEffects, Metrics& aMetrics )
+    : mDisplayEffects( std::move( aDisplayEffects ) )
+    , mMetrics( aMetrics )
+    , mTarget{ false, -1 }
+    , mTargetChanged( false )
+    , mApplied{ false, -1 }
+    , mHasApplied( false )
+    , mExit( false )
+    , mStopped( false )
+{
+}
+
+/**
+    Destructor
+*/
+DisplayActuator::~DisplayActuator()
+{
+    Stop();
+}
+
+/**
+    Starts the actuator thread
+*/
+void DisplayActuator::Start()
+{
+    mThread = std::thread( &DisplayActuator::Actuate, this );
+}
+
+/**
+    Applies any pending effects and stops the actuator thread. Effects
+    requested after Stop are applied straight away on the calling thread.
+*/
+void DisplayActuator::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mExit = true;
+    }
+    mCondVar.notify_one();
+
+    if( mThread.joinable() )
+    {
+        mThread.join();
+    }
+
+    std::unique_lock<std::mutex> lock( mMutex );
+    mStopped = true;
+    Apply( lock );
+}
+
+/**
+    Sets the night light wanted, applied by the actuator thread
+
+    @param aTurnOn true to switch the night light on
+    @param aTemperature colour temperature in kelvin, -1 leaves it unchanged
+*/
+void DisplayActuator::NightLight( bool aTurnOn, int aTemperature )
+{
+    std::unique_lock<std::mutex> lock( mMutex );
+    mTarget = NightLightState{ aTurnOn, aTemperature };
+    mTargetChanged = true;
+
+    if( mStopped )
+    {
+        Apply( lock );
+        return;
+    }
+
+    lock.unlock();
+    mCondVar.notify_one();
+}
+
+/**
+    Queues a notification, shown by the actuator thread
+
+    @param aMessage text of the notification
+    @param aTimeout seconds the notification is shown for
+*/
+void DisplayActuator::Notify( std::string const& aMessage, int aTimeout )
+{
+    std::unique_lock<std::mutex> lock( mMutex );
+    mNotifications.push_back( Notification{ aMessage, aTimeout } );
+
+    if( mStopped )
+    {
+        Apply( lock );
+        return;
+    }
+
+    lock.unlock();
+    mCondVar.notify_one();
+}
+
+/**
+    @return name of the display effects backend
+*/
+char const* DisplayActuator::Name() const
+{
+    return mDisplayEffects->Name();
+}
+
+/**
+    Waits for changes and applies them once they have settled
+*/
+void DisplayActuator::Actuate()
+{
+    std::unique_lock<std::mutex> lock( mMutex );
+    while( !mExit )
+    {
+        mCondVar.wait( lock, [this]() { return mExit || mTargetChanged || !mNotifications.empty(); } );
+
+        // Let a burst of changes settle, each change restarts the wait
+        bool targetChanged = mTargetChanged;
+        while( !mExit && mTargetChanged )
+        {
+            mTargetChanged = false;
+            if( !mCondVar.wait_for( lock, SETTLE_TIME, [this]() { return mExit || mTargetChanged; } ) )
+            {
+                break;
+            }
+        }
+
+        mTargetChanged = mTargetChanged || targetChanged;
+        Apply( lock );
+    }
+}
+
+/**
+    Shows queued notifications and applies the night light if it differs
+    from the state last applied. The mutex is released while the desktop is
+    being changed, so new targets can be set meanwhile.
+
+    @pre aLock holds mMutex
+*/
+void DisplayActuator::Apply( std::unique_lock<std::mutex>& aLock )
+{
+    std::deque<Notification> notifications;
+    notifications.swap( mNotifications );
+
+    bool changeNightLight = false;
+    NightLightState target = mTarget;
+    if( mTargetChanged )
+    {
+        mTargetChanged = false;
+        changeNightLight = !mHasApplied
+            || target.turnOn != mApplied.turnOn
+            || ( target.temperature > 0 && target.temperature != mApplied.temperature );
+        if( changeNightLight )
+        {
+            mApplied.turnOn = target.turnOn;
+            if( target.temperature > 0 )
+            {
+                mApplied.temperature = target.temperature;
+            }
+            mHasApplied = true;
+        }
+        else
+        {
+            mMetrics.nightLightSkipped.fetch_add( 1, std::memory_order_relaxed );
+        }
+    }
+
+    if( notifications.empty() && !changeNightLight )
+    {
+        return;
+    }
+
+    aLock.unlock();
+    for( Notification const& notification : notifications )
+    {
+        mDisplayEffects->Notify( notification.message, notification.timeout );
+    }
+
+    if( changeNightLight )
+    {
+        mDisplayEffects->NightLight( target.turnOn, target.temperature );
+        mMetrics.nightLightChanges.fetch_add( 1, std::memory_order_relaxed );
+    }
+    aLock.lock();
+}
@@ -0,0 +1,50 @@
+/**
+    Definition of DisplayEffects
+*/
+
+#include "DisplayEffects.hpp"
+
+#include <iostream> // std::cout, std::cerr
+
+#include "DBusDisplayEffects.hpp"
+#include "RecordingDisplayEffects.hpp"
+#include "ShellDisplayEffects.hpp"
+
+/**
+    Creates the display effects backend with the given name
+
+    @param aBackend "dbus", "shell", "recording", or empty to use D-Bus when
+            the desktop supports it and fall back to the shell otherwise
+
+    @return display effects backend
+*/
+std::unique_ptr<DisplayEffects> DisplayEffects::Create( std::string const& aBackend )
+{
+    if( aBackend == "recording" )
+    {
+        return std::unique_ptr<DisplayEffects>( new RecordingDisplayEffects( &std::cout ) );
+    }
+
+    if( aBackend == "shell" )
+    {
+        return std::unique_ptr<DisplayEffects>( new ShellDisplayEffects() );
+    }
+
+    if( aBackend.empty() || aBackend == "dbus" )
+    {
+        std::unique_ptr<DBusDisplayEffects> dbus( new DBusDisplayEffects() );
+        if( dbus->IsAvailable() )
+        {
+            return dbus;
+        }
+
+        if( aBackend == "dbus" )
+        {
+            std::cerr << "D-Bus display effects are not available, using the shell" << std::endl;
+        }
+        return std::unique_ptr<DisplayEffects>( new ShellDisplayEffects() );
+    }
+
+    std::cerr << "Unknown display effects " << aBackend << ", using the shell" << std::endl;
+    return std::unique_ptr<DisplayEffects>( new ShellDisplayEffects() );
+}
@@ -0,0 +1,94 @@
+/**
+    Definition of DnnFaceDetectorEngine
+*/
+
+#include "DnnFaceDetectorEngine.hpp"
+
+#include <algorithm>            // std::max, std::min
+#include <filesystem>           // std::filesystem
+#include <opencv2/imgproc.hpp>  // cv::cvtColor
+#include <vector>               // std::vector
+
+// Size the frame is resized to and the mean subtracted from each channel,
+// as the res10_300x300_ssd network was trained
+const cv::Size INPUT_SIZE( 300, 300 );
+const cv::Scalar INPUT_MEAN( 104.0, 177.0, 123.0 );
+// Fields of each detection in the output: image ID, class, confidence and
+// box corners relative to the frame size
+const int DETECTION_FIELDS = 7;
+// Confidence a detection needs to be taken as a face
+const float MIN_CONFIDENCE = 0.5f;
+
+/**
+    Loads a network. Caffe models are loaded together with the .prototxt
+    file of the same name next to them, other formats OpenCV reads from a
+    single file.
+
+    @return false if the network could not be loaded
+*/
+bool DnnFaceDetectorEngine::Load( std::string const& aPath )
+{
+    if( aPath.empty() )
+    {
+        return false;
+    }
+
+    std::filesystem::path config;
+    if( std::filesystem::path( aPath ).extension() == ".caffemodel" )
+    {
+        config = std::filesystem::path( aPath ).replace_extension( ".prototxt" );
+    }
+
+    try
+    {
+        mNet = cv::dnn::readNet( aPath, config.string() );
+    }
+    catch( cv::Exception const& )
+    {
+        return false;
+    }
+    return !mNet.empty();
+}
+
+/**
+    Detects faces in an 8 bit single channel image
+
+    @return rectangles of the faces found, in aImage coordinates
+*/
+std::vector<dlib::rectangle> DnnFaceDetectorEngine::Detect( cv::Mat const& aImage )
+{
+    // The network takes colour frames, intensity is repeated in every channel
+    cv::cvtColor( aImage, mColour, cv::COLOR_GRAY2BGR );
+    mBlob = cv::dnn::blobFromImage( mColour, 1.0, INPUT_SIZE, INPUT_MEAN, false, false );
+    mNet.setInput( mBlob );
+    cv::Mat output = mNet.forward();
+
+    cv::Mat detections( static_cast<int>( output.total() / DETECTION_FIELDS ), DETECTION_FIELDS, CV_32F, output.ptr<float>() );
+    std::vector<dlib::rectangle> faces;
+    for( int i = 0; i < detections.rows; ++i )
+    {
+        float const* detection = detections.ptr<float>( i );
+        if( detection[2] < MIN_CONFIDENCE )
+        {
+            continue;
+        }
+
+        long left = std::max( 0L, static_cast<long>( detection[3] * aImage.cols ) );
+        long top = std::max( 0L, static_cast<long>( detection[4] * aImage.rows ) );
+        long right = std::min( static_cast<long>( aImage.cols ) - 1, static_cast<long>( detection[5] * aImage.cols ) );
+        long bottom = std::min( static_cast<long>( aImage.rows ) - 1, static_cast<long>( detection[6] * aImage.rows ) );
+        if( right > left && bottom > top )
+        {
+            faces.emplace_back( left, top, right, bottom );
+        }
+    }
+    return faces;
+}
+
+/**
+    @return "dnn"
+*/
+char const* DnnFaceDetectorEngine::Name() const
+{
+    return "dnn";
+}
@@ -0,0 +1,106 @@
+/**
+    Definition of DutyCycle
+*/
+
+#include "DutyCycle.hpp"
+
+#include <algorithm>    // std::min, std::max
+
+// Faces missed for up to this long, for example while the user turns their head,
+// do not slow processing down
+const std::chrono::milliseconds ABSENCE_GRACE( 1000 );
+// First and longest time between processed frames while no face is found
+const std::chrono::milliseconds MIN_BACKOFF( 250 );
+const std::chrono::milliseconds MAX_BACKOFF( 4000 );
+// Time between processed frames while the user rests their eyes
+const std::chrono::milliseconds REST_CHECK_INTERVAL( 500 );
+// Time without a face after which the camera is released
+const std::chrono::seconds RELEASE_AFTER( 120 );
+
+/**
+    Constructor
+
+    @param aEnabled false to process every frame, for recordings
+*/
+DutyCycle::DutyCycle( bool aEnabled )
+    : mEnabled( aEnabled )
+    , mResting( false )
+    , mLastFace( std::chrono::steady_clock::now() )
+    , mBackoff( std::chrono::steady_clock::duration::zero() )
+{
+}
+
+/**
+    @return true if a frame captured at aNow is to be processed
+*/
+bool DutyCycle::Admit( std::chrono::steady_clock::time_point aNow )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    std::chrono::steady_clock::duration interval = mBackoff;
+    if( mResting )
+    {
+        interval = std::max<std::chrono::steady_clock::duration>( interval, REST_CHECK_INTERVAL );
+    }
+
+    if( !mEnabled || interval == std::chrono::steady_clock::duration::zero() )
+    {
+        return true;
+    }
+    if( aNow < mNextFrame )
+    {
+        return false;
+    }
+    mNextFrame = aNow + interval;
+    return true;
+}
+
+/**
+    Records whether a processed frame found a face, backing off further when
+    it did not
+*/
+void DutyCycle::OnFaces( std::chrono::steady_clock::time_point aNow, bool aFaceFound )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    if( aFaceFound )
+    {
+        mLastFace = std::max( mLastFace, aNow );
+        mBackoff = std::chrono::steady_clock::duration::zero();
+    }
+    else if( aNow - mLastFace > ABSENCE_GRACE )
+    {
+        mBackoff = ( mBackoff == std::chrono::steady_clock::duration::zero() )
+            ? std::chrono::steady_clock::duration( MIN_BACKOFF )
+            : std::min<std::chrono::steady_clock::duration>( 2 * mBackoff, MAX_BACKOFF );
+    }
+}
+
+/**
+    Switches to the low rate eyes closed check for the length of a rest
+*/
+void DutyCycle::SetResting( bool aResting )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mResting = aResting;
+}
+
+/**
+    @return true once no face has been found for so long the camera is to be
+            released until motion is seen, never while resting
+*/
+bool DutyCycle::ShouldRelease( std::chrono::steady_clock::time_point aNow ) const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mEnabled && !mResting && aNow - mLastFace > RELEASE_AFTER;
+}
+
+/**
+    Processes every frame again as if a face had just been found, after the
+    camera was reopened or eye tracking resumed
+*/
+void DutyCycle::Wake( std::chrono::steady_clock::time_point aNow )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mLastFace = aNow;
+    mBackoff = std::chrono::steady_clock::duration::zero();
+    mNextFrame = aNow;
+}
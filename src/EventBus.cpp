@@ -0,0 +1,187 @@
+/**
+    Definition of EventBus
+*/
+
+#include "EventBus.hpp"
+
+#include <cstdint>          // std::uint64_t
+#include <sys/eventfd.h>    // eventfd
+#include <unistd.h>         // close, read, write
+
+/**
+    Constructor
+
+    @param aMetrics counts the events dropped
+    @param aCapacity events each producer may have waiting before more are dropped
+*/
+EventBus::EventBus( Metrics& aMetrics, std::size_t aCapacity )
+    : mMetrics( aMetrics )
+    , mCapacity( aCapacity )
+    , mWakeEvent( eventfd( 0, EFD_CLOEXEC ) )
+    , mSleeping( false )
+    , mExitBus( false )
+{
+}
+
+/**
+    Destructor
+*/
+EventBus::~EventBus()
+{
+    Stop();
+    close( mWakeEvent );
+}
+
+/**
+    Adds a producer with a queue of its own
+
+    @pre the bus has not been started
+
+    @return id the producer publishes its events with
+*/
+EventBus::ProducerId EventBus::AddProducer()
+{
+    mQueues.emplace_back( new SpscQueue<BusEvent>( mCapacity ) );
+    return mQueues.size() - 1;
+}
+
+/**
+    Starts the bus thread
+*/
+void EventBus::Start()
+{
+    mExitBus = false;
+    mThread = std::thread( &EventBus::Run, this );
+}
+
+/**
+    Delivers the events already published and exits the bus thread. Events
+    published afterwards wait until the bus is started again.
+*/
+void EventBus::Stop()
+{
+    if( !mThread.joinable() )
+    {
+        return;
+    }
+
+    mExitBus = true;
+    std::uint64_t wake = 1;
+    ssize_t written = write( mWakeEvent, &wake, sizeof( wake ) );
+    (void)written;
+    mThread.join();
+}
+
+/**
+    Publishes an event without blocking. Only one thread at a time may
+    publish for a producer.
+
+    @param aValue value passed to the slots taking one
+
+    @return false if the producer's queue was full and the event was dropped
+*/
+bool EventBus::Publish( ProducerId aProducer, BusEvent::Type aType, int aValue )
+{
+    if( !mQueues[aProducer]->Push( BusEvent{ aType, aValue } ) )
+    {
+        mMetrics.eventsDropped.fetch_add( 1, std::memory_order_relaxed );
+        return false;
+    }
+
+    // Pairs with the fence in Run, either the bus thread sees the event before
+    // it sleeps or this thread sees it sleeping and wakes it
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if( mSleeping.load( std::memory_order_relaxed ) )
+    {
+        std::uint64_t wake = 1;
+        ssize_t written = write( mWakeEvent, &wake, sizeof( wake ) );
+        (void)written;
+    }
+    return true;
+}
+
+/**
+    Subscribes a slot to an event type, run on the bus thread
+
+    @return connection to the slot
+*/
+boost::signals2::connection EventBus::Subscribe
+    (
+    BusEvent::Type aType,
+    boost::signals2::signal<void ()>::slot_type const& aSlot
+    )
+{
+    return mSignals[aType].connect( aSlot );
+}
+
+/**
+    Subscribes a slot taking the event value to an event type, run on the bus thread
+
+    @return connection to the slot
+*/
+boost::signals2::connection EventBus::Subscribe
+    (
+    BusEvent::Type aType,
+    boost::signals2::signal<void ( int aValue )>::slot_type const& aSlot
+    )
+{
+    return mValueSignals[aType].connect( aSlot );
+}
+
+/**
+    Delivers events until Stop, sleeping on mWakeEvent while every queue is empty
+*/
+void EventBus::Run()
+{
+    while( true )
+    {
+        if( Deliver() )
+        {
+            continue;
+        }
+        if( mExitBus )
+        {
+            break;
+        }
+
+        // Announce the sleep, then look once more for events published before
+        // the announcement could be seen
+        mSleeping.store( true, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if( !Deliver() && !mExitBus )
+        {
+            std::uint64_t wake;
+            ssize_t wakeRead = read( mWakeEvent, &wake, sizeof( wake ) );
+            (void)wakeRead;
+        }
+        mSleeping.store( false, std::memory_order_relaxed );
+    }
+}
+
+/**
+    Runs the slots of every waiting event, taking one event from each
+    producer in turn so no producer holds up the others
+
+    @return true if any event was delivered
+*/
+bool EventBus::Deliver()
+{
+    bool delivered = false;
+    bool pending = true;
+    while( pending )
+    {
+        pending = false;
+        for( std::unique_ptr<SpscQueue<BusEvent>>& queue : mQueues )
+        {
+            BusEvent event;
+            if( queue->Pop( event ) )
+            {
+                mSignals[event.type]();
+                mValueSignals[event.type]( event.value );
+                pending = true;
+                delivered = true;
+            }
+        }
+    }
+    return delivered;
+}
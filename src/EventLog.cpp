@@ -0,0 +1,273 @@
+/**
+    Definition of EventLog
+*/
+
+#include "EventLog.hpp"
+
+#include <cstdio>       // std::snprintf
+#include <cstring>      // std::memcmp, std::memcpy
+#include <ctime>        // std::tm, gmtime_r, timegm
+#include <fcntl.h>      // open
+#include <iostream>     // std::cerr
+#include <sys/file.h>   // flock
+#include <sys/mman.h>   // mmap, munmap
+#include <sys/stat.h>   // fstat
+#include <unistd.h>     // close, ftruncate
+
+// Bytes the file grows by and that are mapped at a time, a multiple of every page size
+const std::size_t EVENT_LOG_CHUNK_BYTES = 65536;
+const std::uint64_t RECORDS_PER_CHUNK = EVENT_LOG_CHUNK_BYTES / sizeof( EventRecord );
+
+// Seconds between attempts to open a file that failed to open, for example on a full disk
+const int EVENT_LOG_RETRY_SECONDS = 60;
+
+/**
+    @return start of the month after the one aTime falls in, UTC
+*/
+static std::chrono::system_clock::time_point NextMonth( std::chrono::system_clock::time_point aTime )
+{
+    std::time_t time = std::chrono::system_clock::to_time_t( aTime );
+    std::tm month;
+    gmtime_r( &time, &month );
+    month.tm_mday = 1;
+    month.tm_hour = 0;
+    month.tm_min = 0;
+    month.tm_sec = 0;
+    month.tm_mon += 1;
+    return std::chrono::system_clock::from_time_t( timegm( &month ) );
+}
+
+/**
+    Constructor
+
+    @param aDirectory existing directory the log files are written to
+*/
+EventLog::EventLog( std::string const& aDirectory )
+    : mDirectory( aDirectory )
+    , mFd( -1 )
+    , mHeader( nullptr )
+    , mChunk( nullptr )
+    , mChunkIndex( 0 )
+    , mOpen( false )
+{
+}
+
+/**
+    Destructor
+*/
+EventLog::~EventLog()
+{
+    Close();
+}
+
+/**
+    Opens the current month's log file, creating it if needed
+
+    @return false if the file could not be opened or is not an event log
+*/
+bool EventLog::Open()
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mOpen = OpenFile( std::chrono::system_clock::now() );
+    return mOpen;
+}
+
+/**
+    Closes the log file, events appended afterwards are discarded
+*/
+void EventLog::Close()
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mOpen = false;
+    CloseFile();
+}
+
+/**
+    Appends an event that happened now
+*/
+void EventLog::Append( EventType aType, float aValue )
+{
+    Append( aType, aValue, std::chrono::system_clock::now() );
+}
+
+/**
+    Appends an event, moving on to next month's file when the month changed.
+    Events are discarded while that file cannot be opened.
+
+    @param aTime time of the event
+*/
+void EventLog::Append( EventType aType, float aValue, std::chrono::system_clock::time_point aTime )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    if( !mOpen )
+    {
+        return;
+    }
+
+    // A file that failed to open is retried now and then, events in between are lost
+    if( mHeader == nullptr || aTime >= mFileEnd )
+    {
+        CloseFile();
+        if( aTime < mRetryTime )
+        {
+            return;
+        }
+        if( !OpenFile( aTime ) )
+        {
+            mRetryTime = aTime + std::chrono::seconds( EVENT_LOG_RETRY_SECONDS );
+            return;
+        }
+    }
+
+    std::uint64_t count = mHeader->recordCount;
+    if( count / RECORDS_PER_CHUNK != mChunkIndex && !MapChunk( count / RECORDS_PER_CHUNK ) )
+    {
+        return;
+    }
+
+    EventRecord& record = mChunk[count % RECORDS_PER_CHUNK];
+    record.time = std::chrono::duration_cast<std::chrono::microseconds>( aTime.time_since_epoch() ).count();
+    record.value = aValue;
+    record.type = static_cast<std::uint8_t>( aType );
+
+    // Publish the record only once it is complete
+    __atomic_store_n( &mHeader->recordCount, count + 1, __ATOMIC_RELEASE );
+}
+
+/**
+    @return name of the log file events at aTime are written to
+*/
+std::string EventLog::FileName( std::chrono::system_clock::time_point aTime )
+{
+    std::time_t time = std::chrono::system_clock::to_time_t( aTime );
+    std::tm month;
+    gmtime_r( &time, &month );
+
+    char name[32];
+    std::snprintf( name, sizeof( name ), "blinkplease-%04d-%02d.events", month.tm_year + 1900, month.tm_mon + 1 );
+    return name;
+}
+
+/**
+    Opens or creates the log file of the month aTime falls in and maps its
+    header and the chunk the next record goes to
+
+    The file is locked for as long as it is open, a file locked by another
+    writer is not written to.
+
+    @return false if the file could not be opened, is locked by another
+            writer or is not an event log
+*/
+bool EventLog::OpenFile( std::chrono::system_clock::time_point aTime )
+{
+    std::string path = mDirectory + "/" + FileName( aTime );
+    mFd = open( path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644 );
+    struct stat status;
+    if( mFd < 0 || fstat( mFd, &status ) != 0 )
+    {
+        std::cerr << "Could not open event log " << path << std::endl;
+        CloseFile();
+        return false;
+    }
+
+    // Records are appended without further coordination, so only one process may write a log
+    if( flock( mFd, LOCK_EX | LOCK_NB ) != 0 )
+    {
+        std::cerr << "Event log " << path << " is being written by another process, events are not logged while it is" << std::endl;
+        CloseFile();
+        return false;
+    }
+
+    bool created = ( status.st_size == 0 );
+    if( created && ftruncate( mFd, EVENT_LOG_HEADER_BYTES ) != 0 )
+    {
+        CloseFile();
+        return false;
+    }
+
+    void* header = mmap( nullptr, EVENT_LOG_HEADER_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0 );
+    if( header == MAP_FAILED )
+    {
+        CloseFile();
+        return false;
+    }
+    mHeader = static_cast<EventLogHeader*>( header );
+
+    if( created )
+    {
+        std::memcpy( mHeader->magic, EVENT_LOG_MAGIC, sizeof( EVENT_LOG_MAGIC ) );
+        mHeader->version = EVENT_LOG_VERSION;
+        mHeader->recordSize = sizeof( EventRecord );
+        mHeader->recordCount = 0;
+    }
+    else if( std::memcmp( mHeader->magic, EVENT_LOG_MAGIC, sizeof( EVENT_LOG_MAGIC ) ) != 0 ||
+             mHeader->version != EVENT_LOG_VERSION || mHeader->recordSize != sizeof( EventRecord ) )
+    {
+        std::cerr << path << " is not an event log, not writing to it" << std::endl;
+        CloseFile();
+        return false;
+    }
+
+    mFileEnd = NextMonth( aTime );
+    if( !MapChunk( mHeader->recordCount / RECORDS_PER_CHUNK ) )
+    {
+        CloseFile();
+        return false;
+    }
+    return true;
+}
+
+/**
+    Unmaps and closes the current file
+*/
+void EventLog::CloseFile()
+{
+    if( mChunk != nullptr )
+    {
+        munmap( mChunk, EVENT_LOG_CHUNK_BYTES );
+        mChunk = nullptr;
+    }
+    if( mHeader != nullptr )
+    {
+        munmap( mHeader, EVENT_LOG_HEADER_BYTES );
+        mHeader = nullptr;
+    }
+    if( mFd >= 0 )
+    {
+        close( mFd );
+        mFd = -1;
+    }
+}
+
+/**
+    Grows the file to hold a chunk if needed and maps it in place of the
+    current chunk
+
+    @return false if the file could not be grown or mapped
+*/
+bool EventLog::MapChunk( std::uint64_t aChunk )
+{
+    if( mChunk != nullptr )
+    {
+        munmap( mChunk, EVENT_LOG_CHUNK_BYTES );
+        mChunk = nullptr;
+    }
+
+    off_t offset = static_cast<off_t>( EVENT_LOG_HEADER_BYTES + aChunk * EVENT_LOG_CHUNK_BYTES );
+    struct stat status;
+    if( fstat( mFd, &status ) != 0 ||
+        ( status.st_size < offset + static_cast<off_t>( EVENT_LOG_CHUNK_BYTES ) &&
+          ftruncate( mFd, offset + EVENT_LOG_CHUNK_BYTES ) != 0 ) )
+    {
+        return false;
+    }
+
+    void* chunk = mmap( nullptr, EVENT_LOG_CHUNK_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, offset );
+    if( chunk == MAP_FAILED )
+    {
+        return false;
+    }
+    mChunk = static_cast<EventRecord*>( chunk );
+    mChunkIndex = aChunk;
+    return true;
+}
@@ -0,0 +1,118 @@
+/**
+    Definition of EventLogReader
+*/
+
+#include "EventLogReader.hpp"
+
+#include <algorithm>    // std::min
+#include <cstring>      // std::memcmp
+#include <fcntl.h>      // open
+#include <sys/mman.h>   // mmap, munmap, madvise
+#include <sys/stat.h>   // fstat
+#include <unistd.h>     // close
+
+/**
+    Constructor
+*/
+EventLogReader::EventLogReader()
+    : mMapping( nullptr )
+    , mMappingBytes( 0 )
+    , mRecords( nullptr )
+    , mCount( 0 )
+{
+}
+
+/**
+    Destructor
+*/
+EventLogReader::~EventLogReader()
+{
+    Close();
+}
+
+/**
+    Maps a log file, closing the previous one
+
+    @return false if the file could not be mapped or is not an event log
+*/
+bool EventLogReader::Open( std::string const& aPath )
+{
+    Close();
+
+    int fd = open( aPath.c_str(), O_RDONLY | O_CLOEXEC );
+    if( fd < 0 )
+    {
+        return false;
+    }
+
+    struct stat status;
+    if( fstat( fd, &status ) != 0 || status.st_size < static_cast<off_t>( EVENT_LOG_HEADER_BYTES ) )
+    {
+        close( fd );
+        return false;
+    }
+
+    void* mapping = mmap( nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+    close( fd );
+    if( mapping == MAP_FAILED )
+    {
+        return false;
+    }
+    mMapping = mapping;
+    mMappingBytes = status.st_size;
+
+    EventLogHeader const* header = static_cast<EventLogHeader const*>( mMapping );
+    if( std::memcmp( header->magic, EVENT_LOG_MAGIC, sizeof( EVENT_LOG_MAGIC ) ) != 0 ||
+        header->version != EVENT_LOG_VERSION || header->recordSize != sizeof( EventRecord ) )
+    {
+        Close();
+        return false;
+    }
+
+    // Records are scanned once from start to end
+    madvise( mMapping, mMappingBytes, MADV_SEQUENTIAL );
+
+    std::size_t written = __atomic_load_n( &header->recordCount, __ATOMIC_ACQUIRE );
+    mRecords = reinterpret_cast<EventRecord const*>( static_cast<char const*>( mMapping ) + EVENT_LOG_HEADER_BYTES );
+    mCount = std::min( written, ( mMappingBytes - EVENT_LOG_HEADER_BYTES ) / sizeof( EventRecord ) );
+    return true;
+}
+
+/**
+    Unmaps the file
+*/
+void EventLogReader::Close()
+{
+    if( mMapping != nullptr )
+    {
+        munmap( mMapping, mMappingBytes );
+        mMapping = nullptr;
+    }
+    mMappingBytes = 0;
+    mRecords = nullptr;
+    mCount = 0;
+}
+
+/**
+    @return first record of the file
+*/
+EventRecord const* EventLogReader::begin() const
+{
+    return mRecords;
+}
+
+/**
+    @return one past the last complete record of the file
+*/
+EventRecord const* EventLogReader::end() const
+{
+    return mRecords + mCount;
+}
+
+/**
+    @return number of complete records in the file
+*/
+std::size_t EventLogReader::Size() const
+{
+    return mCount;
+}
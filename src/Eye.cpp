@@ -18,13 +18,16 @@ Eye::Eye
     int x5, int y5,
     int x6, int y6
     )
+    : mEyePoints
+        { {
+        Point{ x1, y1 },
+        Point{ x2, y2 },
+        Point{ x3, y3 },
+        Point{ x4, y4 },
+        Point{ x5, y5 },
+        Point{ x6, y6 }
+        } }
 {
-    mEyePoints.emplace_back( Point{ x1, y1 } );
-    mEyePoints.emplace_back( Point{ x2, y2 } );
-    mEyePoints.emplace_back( Point{ x3, y3 } );
-    mEyePoints.emplace_back( Point{ x4, y4 } );
-    mEyePoints.emplace_back( Point{ x5, y5 } );
-    mEyePoints.emplace_back( Point{ x6, y6 } );
 }
 
 /**
@@ -40,7 +43,7 @@ Eye::Eye
 
     @return Eye Aspect Ratio for this eye
 */
-double Eye::AspectRatio()
+double Eye::AspectRatio() const
 {
     double height1 = EuclideanDistance( 1, 5 );
     double height2 = EuclideanDistance( 2, 4 );
@@ -48,6 +51,14 @@ double Eye::AspectRatio()
     return ( height1 + height2 ) / ( 2.0 * width );
 }
 
+/**
+    @return distance between the corners of the eye in pixels
+*/
+double Eye::Width() const
+{
+    return EuclideanDistance( 0, 3 );
+}
+
 /**
     Calculates the euclidian distance between two sets of points
 
@@ -56,9 +67,9 @@ double Eye::AspectRatio()
 
     @return Euclidean distance between the two given points
 */
-double Eye::EuclideanDistance( int p, int q )
+double Eye::EuclideanDistance( int p, int q ) const
 {
-    return std::sqrt( std::pow( ( mEyePoints[q].x - mEyePoints[p].x ), 2.0 ) +
-                      std::pow( ( mEyePoints[q].y - mEyePoints[p].y ), 2.0 )
-                    );
-}
\ No newline at end of file
+    double dx = mEyePoints[q].x - mEyePoints[p].x;
+    double dy = mEyePoints[q].y - mEyePoints[p].y;
+    return std::sqrt( dx * dx + dy * dy );
+}
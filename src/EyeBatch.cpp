@@ -0,0 +1,105 @@
+/**
+    Definition of EyeBatch
+*/
+
+#include "EyeBatch.hpp"
+
+#include <cmath>
+
+/**
+    Calculates the Eye Aspect Ratio of aCount eyes stored as one array per
+    landmark coordinate. The arrays are passed as restrict pointers so the
+    compiler knows they do not overlap and can vectorise the loop.
+*/
+static void AspectRatioKernel
+    (
+    double const* __restrict x0, double const* __restrict y0,
+    double const* __restrict x1, double const* __restrict y1,
+    double const* __restrict x2, double const* __restrict y2,
+    double const* __restrict x3, double const* __restrict y3,
+    double const* __restrict x4, double const* __restrict y4,
+    double const* __restrict x5, double const* __restrict y5,
+    double* __restrict aRatios,
+    std::size_t aCount
+    )
+{
+    for( std::size_t i = 0; i < aCount; ++i )
+    {
+        double dx15 = x5[i] - x1[i];
+        double dy15 = y5[i] - y1[i];
+        double dx24 = x4[i] - x2[i];
+        double dy24 = y4[i] - y2[i];
+        double dx03 = x3[i] - x0[i];
+        double dy03 = y3[i] - y0[i];
+        double height1 = std::sqrt( dx15 * dx15 + dy15 * dy15 );
+        double height2 = std::sqrt( dx24 * dx24 + dy24 * dy24 );
+        double width   = std::sqrt( dx03 * dx03 + dy03 * dy03 );
+        aRatios[i] = ( height1 + height2 ) / ( 2.0 * width );
+    }
+}
+
+/**
+    Reserves space so adding aCount eyes does not allocate
+*/
+void EyeBatch::Reserve( std::size_t aCount )
+{
+    for( std::size_t point = 0; point < Eye::POINTS; ++point )
+    {
+        mX[point].reserve( aCount );
+        mY[point].reserve( aCount );
+    }
+}
+
+/**
+    Removes all eyes, keeping the reserved space
+*/
+void EyeBatch::Clear()
+{
+    for( std::size_t point = 0; point < Eye::POINTS; ++point )
+    {
+        mX[point].clear();
+        mY[point].clear();
+    }
+}
+
+/**
+    Adds an eye to the end of the batch
+*/
+void EyeBatch::Add( Eye const& aEye )
+{
+    for( std::size_t point = 0; point < Eye::POINTS; ++point )
+    {
+        mX[point].push_back( aEye.mEyePoints[point].x );
+        mY[point].push_back( aEye.mEyePoints[point].y );
+    }
+}
+
+/**
+    @return number of eyes in the batch
+*/
+std::size_t EyeBatch::Size() const
+{
+    return mX[0].size();
+}
+
+/**
+    Calculates the Eye Aspect Ratio of every eye in the batch, using the same
+    formula and order of operations as Eye::AspectRatio
+
+    @param aRatios resized to Size(), entry i holds the ratio of the i-th eye added
+*/
+void EyeBatch::AspectRatios( std::vector<double>& aRatios ) const
+{
+    aRatios.resize( Size() );
+    AspectRatioKernel
+        (
+        mX[0].data(), mY[0].data(),
+        mX[1].data(), mY[1].data(),
+        mX[2].data(), mY[2].data(),
+        mX[3].data(), mY[3].data(),
+        mX[4].data(), mY[4].data(),
+        mX[5].data(), mY[5].data(),
+        aRatios.data(),
+        aRatios.size()
+        );
+}
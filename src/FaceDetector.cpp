@@ -0,0 +1,118 @@
+/**
+    Definition of FaceDetector
+*/
+
+#include "FaceDetector.hpp"
+
+#include <cmath>                // std::lround
+#include <opencv2/imgproc.hpp>  // cv::cvtColor, cv::resize
+
+// Width frames are scaled down to when no explicit scale is set. Faces closer
+// than arm's length to a webcam are still well above dlib's 80x80 pixel
+// detection window at this width, the largest window of the engines.
+const double DEFAULT_DETECTION_WIDTH = 640.0;
+
+/**
+    Constructor
+
+    @param aScale factor frames are scaled by before detection, values in (0, 1],
+            0 picks a scale that brings frames down to DEFAULT_DETECTION_WIDTH
+    @param aWorkers threads detection is spread over, null or a single thread
+            detects on the calling thread
+    @param aEngine engine finding the faces, see FaceDetectorEngine::Create
+    @param aModelPath cascade or network file of the engine
+*/
+FaceDetector::FaceDetector
+    (
+    double aScale,
+    WorkerPool* aWorkers,
+    std::string const& aEngine,
+    std::string const& aModelPath
+    )
+    : mEngine( FaceDetectorEngine::Create( aEngine, aModelPath, aWorkers ) )
+    , mScale( 0.0 )
+{
+    SetScale( aScale );
+}
+
+/**
+    Detects faces in a BGR or grayscale frame
+
+    @return rectangles of the faces found, in aImage coordinates
+*/
+std::vector<dlib::rectangle> FaceDetector::Detect( cv::Mat const& aImage )
+{
+    double scale = ScaleFor( aImage );
+
+    // Every engine only needs intensity
+    cv::Mat const* detectImage = &aImage;
+    if( aImage.channels() == 3 )
+    {
+        cv::cvtColor( aImage, mGray, cv::COLOR_BGR2GRAY );
+        detectImage = &mGray;
+    }
+
+    if( scale < 1.0 )
+    {
+        cv::resize( *detectImage, mScaled, cv::Size(), scale, scale, cv::INTER_AREA );
+        detectImage = &mScaled;
+    }
+
+    std::vector<dlib::rectangle> faces = mEngine->Detect( *detectImage );
+
+    // Map faces back to full resolution
+    if( scale < 1.0 )
+    {
+        for( dlib::rectangle& face : faces )
+        {
+            face = dlib::rectangle
+                (
+                std::lround( face.left() / scale ),
+                std::lround( face.top() / scale ),
+                std::lround( ( face.right() + 1 ) / scale ) - 1,
+                std::lround( ( face.bottom() + 1 ) / scale ) - 1
+                );
+        }
+    }
+
+    return faces;
+}
+
+/**
+    Sets the factor frames are scaled by before detection. Values outside
+    (0, 1] select the automatic scale.
+*/
+void FaceDetector::SetScale( double aScale )
+{
+    mScale = ( aScale > 0.0 && aScale <= 1.0 ) ? aScale : 0.0;
+}
+
+/**
+    @return factor frames are scaled by before detection, 0 if automatic
+*/
+double FaceDetector::Scale() const
+{
+    return mScale;
+}
+
+/**
+    @return factor aImage will be scaled by before detection
+*/
+double FaceDetector::ScaleFor( cv::Mat const& aImage ) const
+{
+    double scale = mScale;
+    if( scale > 0.0 )
+    {
+        return scale;
+    }
+
+    return ( aImage.cols > DEFAULT_DETECTION_WIDTH ) ? DEFAULT_DETECTION_WIDTH / aImage.cols : 1.0;
+}
+
+/**
+    @return name of the engine finding the faces
+*/
+char const* FaceDetector::Name() const
+{
+    return mEngine->Name();
+}
@@ -0,0 +1,56 @@
+/**
+    Definition of FaceDetectorEngine
+*/
+
+#include "FaceDetectorEngine.hpp"
+
+#include <iostream> // std::cerr
+
+#include "CascadeFaceDetectorEngine.hpp"
+#include "DnnFaceDetectorEngine.hpp"
+#include "HogFaceDetectorEngine.hpp"
+
+/**
+    Creates the face detector engine with the given name
+
+    @param aEngine "hog", "haar", "lbp", "dnn", or empty for "hog"
+    @param aModelPath cascade file for "haar" and "lbp", empty for the
+            frontal face cascade shipped with OpenCV, or network file for "dnn"
+    @param aWorkers threads the HOG detector is spread over, null or a single
+            thread detects on the calling thread
+
+    @return face detector engine, the HOG detector when aEngine is unknown or
+            its model cannot be loaded
+*/
+std::unique_ptr<FaceDetectorEngine> FaceDetectorEngine::Create
+    (
+    std::string const& aEngine,
+    std::string const& aModelPath,
+    WorkerPool* aWorkers
+    )
+{
+    if( aEngine == "haar" || aEngine == "lbp" )
+    {
+        std::unique_ptr<CascadeFaceDetectorEngine> cascade( new CascadeFaceDetectorEngine( aEngine ) );
+        if( cascade->Load( aModelPath ) )
+        {
+            return cascade;
+        }
+        std::cerr << "Could not load the " << aEngine << " face cascade, using hog" << std::endl;
+    }
+    else if( aEngine == "dnn" )
+    {
+        std::unique_ptr<DnnFaceDetectorEngine> dnn( new DnnFaceDetectorEngine() );
+        if( dnn->Load( aModelPath ) )
+        {
+            return dnn;
+        }
+        std::cerr << "Could not load face detection network " << aModelPath << ", using hog" << std::endl;
+    }
+    else if( !aEngine.empty() && aEngine != "hog" )
+    {
+        std::cerr << "Unknown face detector " << aEngine << ", using hog" << std::endl;
+    }
+
+    return std::unique_ptr<FaceDetectorEngine>( new HogFaceDetectorEngine( aWorkers ) );
+}
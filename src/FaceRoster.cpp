@@ -0,0 +1,163 @@
+/**
+    Definition of FaceRoster
+*/
+
+#include "FaceRoster.hpp"
+
+#include <algorithm>    // std::min
+#include <cmath>        // std::abs
+#include <iostream>     // std::cout
+
+// Score another face needs relative to the primary face to take over
+const double PRIMARY_SWITCH_RATIO = 1.5;
+// Seconds the primary face may be out of view before another face takes over
+const double PRIMARY_TIMEOUT_SECONDS = 2.0;
+// Seconds a face may be out of view before its blink state is forgotten
+const double FACE_TIMEOUT_SECONDS = 30.0;
+// Share of the score lost by a face at the edge of the frame
+const double OFF_CENTRE_PENALTY = 0.5;
+
+/**
+    @return how likely a face is the user's, larger faces closer to the
+            centre of the frame score higher
+*/
+static double Score( dlib::rectangle const& aFace, long aFrameWidth )
+{
+    double halfWidth = std::max( aFrameWidth, 1L ) / 2.0;
+    double offCentre = std::abs( aFace.center().x() - halfWidth ) / halfWidth;
+    return aFace.width() * ( 1.0 - OFF_CENTRE_PENALTY * std::min( offCentre, 1.0 ) );
+}
+
+/**
+    Constructor
+
+    @param aCamera camera the faces are seen by, reported in Status
+*/
+FaceRoster::FaceRoster( std::size_t aCamera )
+    : mCamera( aCamera )
+    , mHasPrimary( false )
+    , mPrimaryId( 0 )
+    , mFixedThreshold( 0.0 )
+{
+}
+
+/**
+    Detects the blinks of every face in a frame and picks the primary face
+
+    @param aTime time of the frame in seconds
+    @param aFrameWidth width of the frame in pixels
+    @param aFaces faces found in the frame
+    @param aPrimary set to the index of the primary face in aFaces when true
+            is returned
+
+    @return false if the primary face is not in aFaces
+*/
+bool FaceRoster::Update
+    (
+    double aTime,
+    long aFrameWidth,
+    std::vector<FaceObservation> const& aFaces,
+    std::size_t& aPrimary
+    )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    std::size_t best = aFaces.size();
+    std::size_t current = aFaces.size();
+    for( std::size_t i = 0; i < aFaces.size(); ++i )
+    {
+        FaceObservation const& observation = aFaces[i];
+        bool added = mFaces.count( observation.id ) == 0;
+        Face& face = mFaces[observation.id];
+        if( added )
+        {
+            face.blinkDetector.SetFixedThreshold( mFixedThreshold );
+        }
+        face.lastSeen = aTime;
+        if( observation.fitted && face.blinkDetector.Update( observation.eyeAspectRatio, aTime ) )
+        {
+            ++face.blinks;
+        }
+
+        if( best == aFaces.size() ||
+            Score( observation.face, aFrameWidth ) > Score( aFaces[best].face, aFrameWidth ) )
+        {
+            best = i;
+        }
+        if( mHasPrimary && observation.id == mPrimaryId )
+        {
+            current = i;
+        }
+    }
+
+    // Keep the primary face unless another face is clearly the user's
+    bool primaryGone = !mHasPrimary ||
+        aTime - mFaces[mPrimaryId].lastSeen > PRIMARY_TIMEOUT_SECONDS;
+    if( best < aFaces.size() &&
+        ( ( current == aFaces.size() && primaryGone ) ||
+          ( current < aFaces.size() &&
+            Score( aFaces[best].face, aFrameWidth ) > PRIMARY_SWITCH_RATIO * Score( aFaces[current].face, aFrameWidth ) ) ) )
+    {
+        if( mHasPrimary )
+        {
+            std::cout << "Camera " << mCamera << " follows face " << aFaces[best].id
+                      << " instead of face " << mPrimaryId << std::endl;
+        }
+        mHasPrimary = true;
+        mPrimaryId = aFaces[best].id;
+        current = best;
+    }
+
+    for( std::map<unsigned long, Face>::iterator face = mFaces.begin(); face != mFaces.end(); )
+    {
+        if( aTime - face->second.lastSeen > FACE_TIMEOUT_SECONDS && !( mHasPrimary && face->first == mPrimaryId ) )
+        {
+            face = mFaces.erase( face );
+        }
+        else
+        {
+            ++face;
+        }
+    }
+
+    aPrimary = current;
+    return current < aFaces.size();
+}
+
+/**
+    @return blink counts of the faces seen recently
+*/
+std::vector<FaceStatus> FaceRoster::Status() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    std::vector<FaceStatus> status;
+    for( std::pair<unsigned long const, Face> const& face : mFaces )
+    {
+        FaceStatus faceStatus;
+        faceStatus.camera = mCamera;
+        faceStatus.id = face.first;
+        faceStatus.blinks = face.second.blinks;
+        faceStatus.primary = mHasPrimary && face.first == mPrimaryId;
+        status.push_back( faceStatus );
+    }
+    return status;
+}
+
+/**
+    Overrides the learned blink threshold of every face, including faces
+    seen from now on, see BlinkDetector::SetFixedThreshold
+
+    @param aThreshold eye aspect ratio below which the eyes count as closed,
+                      0 to use each face's learned threshold again
+*/
+void FaceRoster::SetFixedThreshold( double aThreshold )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    mFixedThreshold = aThreshold;
+    for( std::pair<unsigned long const, Face>& face : mFaces )
+    {
+        face.second.blinkDetector.SetFixedThreshold( aThreshold );
+    }
+}
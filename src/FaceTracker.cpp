@@ -0,0 +1,271 @@
+/**
+    Definition of FaceTracker
+*/
+
+#include "FaceTracker.hpp"
+
+#include <algorithm>    // std::remove_if
+#include <cmath>        // std::abs, std::hypot
+
+// Eye landmark offsets from the first eye landmark, see LandmarkModel
+const unsigned long EYE_PARTS = 12;
+const unsigned long LEFT_EYE_OUTER_CORNER = 0;
+const unsigned long RIGHT_EYE_OUTER_CORNER = 9;
+
+// Fraction of the face width the eye landmarks may fall outside the tracked face
+const double ROI_PADDING = 0.25;
+// Relative change of the eye span allowed before the fit is considered degraded
+const double SPAN_TOLERANCE = 0.25;
+
+// Overlap, intersection over union, a detected face needs with where a face
+// was last seen to keep its ID
+const double MIN_MATCH_OVERLAP = 0.3;
+// Detections a face may be missed by before its ID is forgotten
+const unsigned int MAX_MISSED_DETECTIONS = 5;
+
+/**
+    @return intersection over union of two rectangles, 0 when they do not overlap
+*/
+static double Overlap( dlib::rectangle const& aFirst, dlib::rectangle const& aSecond )
+{
+    double intersection = static_cast<double>( aFirst.intersect( aSecond ).area() );
+    double area = static_cast<double>( aFirst.area() + aSecond.area() ) - intersection;
+    return area > 0.0 ? intersection / area : 0.0;
+}
+
+/**
+    Constructor
+
+    @param aDetectionStride run the full frame detector at least once every
+            aDetectionStride frames, 1 runs it on every frame
+*/
+FaceTracker::FaceTracker( unsigned int aDetectionStride )
+    : mDetectionStride( aDetectionStride > 0 ? aDetectionStride : 1 )
+    , mTracking( false )
+    , mNextFaceId( 0 )
+    , mFramesSinceDetection( 0 )
+    , mDetectionSequence( 0 )
+{
+}
+
+/**
+    Provides the tracked faces for the next frame
+
+    @param aFaces set to the tracked face rectangles when true is returned
+    @param aFaceIds set to the ID of each of aFaces when true is returned
+
+    @return false if the full frame detector has to run on the next frame
+*/
+bool FaceTracker::TrackedFaces
+    (
+    std::vector<dlib::rectangle>& aFaces,
+    std::vector<unsigned long>& aFaceIds
+    )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    if( !mTracking || mFramesSinceDetection + 1 >= mDetectionStride )
+    {
+        return false;
+    }
+
+    ++mFramesSinceDetection;
+    aFaces.clear();
+    aFaceIds.clear();
+    for( Face const& face : mFaces )
+    {
+        if( face.missedDetections == 0 )
+        {
+            aFaces.push_back( face.rectangle );
+            aFaceIds.push_back( face.id );
+        }
+    }
+    return true;
+}
+
+/**
+    Restarts tracking from the result of the full frame detector. Each
+    detected face takes over the ID of the face it overlaps most, if any.
+
+    @param aFaceIds set to the ID of each of aFaces
+*/
+void FaceTracker::OnFacesDetected
+    (
+    unsigned long aSequence,
+    std::vector<dlib::rectangle> const& aFaces,
+    std::vector<unsigned long>& aFaceIds
+    )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mDetectionSequence = aSequence;
+    mFramesSinceDetection = 0;
+    mTracking = !aFaces.empty();
+
+    for( Face& face : mFaces )
+    {
+        ++face.missedDetections;
+    }
+
+    aFaceIds.clear();
+    std::size_t previousFaces = mFaces.size();
+    for( dlib::rectangle const& detected : aFaces )
+    {
+        // Best unclaimed match among the faces known before this detection
+        Face* match = nullptr;
+        double matchOverlap = MIN_MATCH_OVERLAP;
+        for( std::size_t i = 0; i < previousFaces; ++i )
+        {
+            double overlap = Overlap( detected, mFaces[i].rectangle );
+            if( mFaces[i].missedDetections > 0 && overlap >= matchOverlap )
+            {
+                match = &mFaces[i];
+                matchOverlap = overlap;
+            }
+        }
+
+        if( match == nullptr )
+        {
+            mFaces.push_back( Face{ mNextFaceId++, detected, 0, false, 0.0, 0.0, 0.0 } );
+            match = &mFaces.back();
+        }
+        match->rectangle = detected;
+        match->missedDetections = 0;
+        match->hasReference = false;
+        aFaceIds.push_back( match->id );
+    }
+
+    mFaces.erase
+        (
+        std::remove_if
+            (
+            mFaces.begin(),
+            mFaces.end(),
+            []( Face const& aFace ) { return aFace.missedDetections > MAX_MISSED_DETECTIONS; }
+            ),
+        mFaces.end()
+        );
+}
+
+/**
+    Checks the landmarks fitted inside a face and moves the tracked face
+    along with the eyes
+
+    The fit is considered degraded when any eye landmark falls outside the
+    padded face rectangle or the distance between the outer eye corners no
+    longer matches the size of the face. A degraded fit stops tracking so the
+    detector runs on the next frame.
+
+    @param aSequence sequence of the frame the landmarks were fitted on
+    @param aFaceId ID of the face the landmarks were fitted to
+    @param aFace rectangle the landmarks were fitted inside
+    @param aShape landmarks fitted by the shape predictor
+    @param aFirstEyePart index of the first of the twelve eye landmarks in aShape
+
+    @return true if the landmark fit is good
+*/
+bool FaceTracker::OnLandmarksFitted
+    (
+    unsigned long aSequence,
+    unsigned long aFaceId,
+    dlib::rectangle const& aFace,
+    dlib::full_object_detection const& aShape,
+    unsigned long aFirstEyePart
+    )
+{
+    // Measure the eyes and check they are inside the padded face
+    double width = static_cast<double>( aFace.width() );
+    dlib::rectangle roi = dlib::grow_rect( aFace, static_cast<long>( width * ROI_PADDING ) );
+
+    bool inside = true;
+    double sumX = 0.0;
+    double sumY = 0.0;
+    for( unsigned long part = aFirstEyePart; part < aFirstEyePart + EYE_PARTS; ++part )
+    {
+        inside = inside && roi.contains( aShape.part( part ) );
+        sumX += aShape.part( part ).x();
+        sumY += aShape.part( part ).y();
+    }
+
+    double eyeX = sumX / EYE_PARTS;
+    double eyeY = sumY / EYE_PARTS;
+    dlib::point left = aShape.part( aFirstEyePart + LEFT_EYE_OUTER_CORNER );
+    dlib::point right = aShape.part( aFirstEyePart + RIGHT_EYE_OUTER_CORNER );
+    double span = std::hypot
+        (
+        static_cast<double>( right.x() - left.x() ),
+        static_cast<double>( right.y() - left.y() )
+        );
+
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    Face* tracked = nullptr;
+    for( Face& face : mFaces )
+    {
+        if( face.id == aFaceId && face.missedDetections == 0 )
+        {
+            tracked = &face;
+        }
+    }
+
+    // Fits from frames before the last detection no longer describe mFaces
+    if( aSequence < mDetectionSequence || !mTracking || tracked == nullptr )
+    {
+        return inside;
+    }
+
+    if( !tracked->hasReference )
+    {
+        // First fit since detection, remember where the eyes sit in the face.
+        // The detector found this face so the fit is used even if it cannot be tracked.
+        if( !inside || span <= 0.0 )
+        {
+            mTracking = false;
+        }
+        else
+        {
+            tracked->referenceSpan = span / width;
+            tracked->referenceOffsetX = ( eyeX - aFace.center().x() ) / width;
+            tracked->referenceOffsetY = ( eyeY - aFace.center().y() ) / width;
+            tracked->hasReference = true;
+        }
+        return true;
+    }
+
+    if( !inside || std::abs( span / width - tracked->referenceSpan ) > SPAN_TOLERANCE * tracked->referenceSpan )
+    {
+        mTracking = false;
+        return false;
+    }
+
+    // Re-centre the face on the eyes and scale it with the eye span
+    dlib::rectangle const& previous = tracked->rectangle;
+    double aspect = static_cast<double>( previous.height() ) / static_cast<double>( previous.width() );
+    double newWidth = span / tracked->referenceSpan;
+    dlib::point center
+        (
+        static_cast<long>( eyeX - tracked->referenceOffsetX * newWidth ),
+        static_cast<long>( eyeY - tracked->referenceOffsetY * newWidth )
+        );
+    tracked->rectangle = dlib::centered_rect
+        (
+        center,
+        static_cast<unsigned long>( newWidth ),
+        static_cast<unsigned long>( newWidth * aspect )
+        );
+    return true;
+}
+
+/**
+    Changes how often the full frame detector has to run
+*/
+void FaceTracker::SetDetectionStride( unsigned int aDetectionStride )
+{
+    mDetectionStride = ( aDetectionStride > 0 ) ? aDetectionStride : 1;
+}
+
+/**
+    @return number of frames between forced full frame detections
+*/
+unsigned int FaceTracker::DetectionStride() const
+{
+    return mDetectionStride;
+}
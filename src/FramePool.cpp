@@ -0,0 +1,147 @@
+/**
+    Definition of FramePool
+*/
+
+#include "FramePool.hpp"
+
+#include <utility>  // std::swap
+
+/**
+    Constructor, for an empty lease
+*/
+FrameBuffer::FrameBuffer()
+    : mPool( nullptr )
+    , mSlot( 0 )
+{
+}
+
+/**
+    Constructor, for a buffer leased from aPool
+*/
+FrameBuffer::FrameBuffer( FramePool* aPool, std::size_t aSlot )
+    : mPool( aPool )
+    , mSlot( aSlot )
+{
+}
+
+/**
+    Move constructor, aOther is left empty
+*/
+FrameBuffer::FrameBuffer( FrameBuffer&& aOther )
+    : mPool( aOther.mPool )
+    , mSlot( aOther.mSlot )
+{
+    aOther.mPool = nullptr;
+}
+
+/**
+    Move assignment, returns the buffer held so far and leaves aOther empty
+*/
+FrameBuffer& FrameBuffer::operator=( FrameBuffer&& aOther )
+{
+    if( this != &aOther )
+    {
+        Release();
+        std::swap( mPool, aOther.mPool );
+        std::swap( mSlot, aOther.mSlot );
+    }
+    return *this;
+}
+
+/**
+    Destructor, returns the buffer to its pool
+*/
+FrameBuffer::~FrameBuffer()
+{
+    Release();
+}
+
+/**
+    @return true if a buffer is leased
+*/
+FrameBuffer::operator bool() const
+{
+    return mPool != nullptr;
+}
+
+/**
+    @pre a buffer is leased
+
+    @return image of the leased buffer, reading into it reuses its data when
+            the frame size has not changed
+*/
+cv::Mat& FrameBuffer::Image()
+{
+    return mPool->mImages[mSlot];
+}
+
+/**
+    Returns the buffer to its pool and empties the lease
+*/
+void FrameBuffer::Release()
+{
+    if( mPool != nullptr )
+    {
+        mPool->Release( mSlot );
+        mPool = nullptr;
+    }
+}
+
+/**
+    Constructor
+
+    @param aBuffers number of buffers, the most frames that can be in flight
+*/
+FramePool::FramePool( std::size_t aBuffers )
+    : mImages( aBuffers > 0 ? aBuffers : 1 )
+    , mLeased( mImages.size(), false )
+    , mClosed( false )
+{
+}
+
+/**
+    Waits for a free buffer and leases it
+
+    @return lease on a buffer, empty if the pool was closed
+*/
+FrameBuffer FramePool::Acquire()
+{
+    std::unique_lock<std::mutex> lock( mMutex );
+    while( !mClosed )
+    {
+        for( std::size_t slot = 0; slot < mLeased.size(); ++slot )
+        {
+            if( !mLeased[slot] )
+            {
+                mLeased[slot] = true;
+                return FrameBuffer( this, slot );
+            }
+        }
+        mCondVar.wait( lock );
+    }
+    return FrameBuffer();
+}
+
+/**
+    Wakes up Acquire and makes it return empty leases from now on
+*/
+void FramePool::Close()
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mClosed = true;
+    }
+    mCondVar.notify_all();
+}
+
+/**
+    Marks a buffer as free again
+*/
+void FramePool::Release( std::size_t aSlot )
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mLeased[aSlot] = false;
+    }
+    mCondVar.notify_one();
+}
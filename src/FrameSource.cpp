@@ -0,0 +1,54 @@
+/**
+    Definition of FrameSource
+*/
+
+#include "FrameSource.hpp"
+
+#include <algorithm>    // std::all_of
+#include <cctype>       // isdigit
+#include <cstdlib>      // atoi
+#include <filesystem>   // std::filesystem::is_directory
+
+#include "CameraSource.hpp"
+#include "ImageDirectorySource.hpp"
+#include "V4l2CameraSource.hpp"
+#include "VideoFileSource.hpp"
+
+/**
+    Creates the frame source for a location
+
+    @param aLocation empty for the default webcam, a device index, a directory
+            of images or a video file
+    @param aFrameRate rate recordings are replayed at when they do not store one
+    @param aLumaCapture read only the intensity of webcam frames when the
+            device supports it, see V4l2CameraSource
+
+    @return frame source for aLocation
+*/
+std::unique_ptr<FrameSource> FrameSource::Create
+    (
+    std::string const& aLocation,
+    double aFrameRate,
+    bool aLumaCapture
+    )
+{
+    bool device = aLocation.empty() ||
+        std::all_of( aLocation.begin(), aLocation.end(), []( char c ) { return isdigit( c ); } );
+    if( device )
+    {
+        int index = aLocation.empty() ? 0 : atoi( aLocation.c_str() );
+        if( aLumaCapture )
+        {
+            return std::unique_ptr<FrameSource>( new V4l2CameraSource( index ) );
+        }
+        return std::unique_ptr<FrameSource>( new CameraSource( index ) );
+    }
+
+    std::error_code error;
+    if( std::filesystem::is_directory( aLocation, error ) )
+    {
+        return std::unique_ptr<FrameSource>( new ImageDirectorySource( aLocation, aFrameRate ) );
+    }
+
+    return std::unique_ptr<FrameSource>( new VideoFileSource( aLocation, aFrameRate ) );
+}
@@ -0,0 +1,208 @@
+/**
+    Definition of HabitScheduler
+*/
+
+#include "HabitScheduler.hpp"
+
+#include <algorithm>        // std::sort
+#include <cstdint>          // std::uint64_t
+#include <poll.h>           // poll
+#include <sys/eventfd.h>    // eventfd
+#include <sys/timerfd.h>    // timerfd_create, timerfd_settime
+#include <unistd.h>         // close, read, write
+#include <tuple>            // std::tuple, std::get
+
+/**
+    Constructor
+
+    The timerfd uses CLOCK_MONOTONIC, the clock behind std::chrono::steady_clock.
+*/
+HabitScheduler::HabitScheduler()
+    : mArmedDeadline( std::chrono::steady_clock::time_point::max() )
+    , mTimer( timerfd_create( CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK ) )
+    , mWakeEvent( eventfd( 0, EFD_CLOEXEC ) )
+    , mExitScheduler( false )
+{
+}
+
+/**
+    Destructor
+*/
+HabitScheduler::~HabitScheduler()
+{
+    Stop();
+    close( mTimer );
+    close( mWakeEvent );
+}
+
+/**
+    Starts the scheduler thread
+*/
+void HabitScheduler::Start()
+{
+    mExitScheduler = false;
+    mThread = std::thread( &HabitScheduler::Run, this );
+}
+
+/**
+    Wakes up and exits the scheduler thread. Timers keep their deadlines
+    but no callbacks run until the scheduler is started again.
+*/
+void HabitScheduler::Stop()
+{
+    if( !mThread.joinable() )
+    {
+        return;
+    }
+
+    mExitScheduler = true;
+    std::uint64_t wake = 1;
+    ssize_t written = write( mWakeEvent, &wake, sizeof( wake ) );
+    (void)written;
+    mThread.join();
+}
+
+/**
+    Adds a timer, which does not fire until scheduled
+
+    @param aCallback run on the scheduler thread each time the timer fires
+
+    @return id used to schedule and cancel the timer
+*/
+HabitScheduler::TimerId HabitScheduler::AddTimer( std::function<void ()> aCallback )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    mTimers.push_back( Timer{ std::move( aCallback ), std::chrono::steady_clock::time_point::max(), false, 0 } );
+    return mTimers.size() - 1;
+}
+
+/**
+    Sets a timer to fire once after aDelay, replacing any earlier deadline.
+    Can be called from any thread, including from timer callbacks. Only
+    touches the kernel timer when the new deadline is the earliest.
+*/
+void HabitScheduler::Schedule( TimerId aTimer, std::chrono::steady_clock::duration aDelay )
+{
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + aDelay;
+
+    std::lock_guard<std::mutex> lock( mMutex );
+    Timer& timer = mTimers[aTimer];
+    timer.deadline = deadline;
+    timer.armed = true;
+    ++timer.generation;
+
+    if( deadline < mArmedDeadline )
+    {
+        Arm( deadline );
+    }
+}
+
+/**
+    Stops a timer from firing until it is scheduled again
+*/
+void HabitScheduler::Cancel( TimerId aTimer )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    Timer& timer = mTimers[aTimer];
+    timer.armed = false;
+    ++timer.generation;
+}
+
+/**
+    Waits for the kernel timer and runs the callbacks of every timer whose
+    deadline has passed, then re-arms the kernel timer for the next deadline
+*/
+void HabitScheduler::Run()
+{
+    while( !mExitScheduler )
+    {
+        pollfd descriptors[2] = { { mWakeEvent, POLLIN, 0 }, { mTimer, POLLIN, 0 } };
+        poll( descriptors, 2, -1 );
+        if( mExitScheduler )
+        {
+            break;
+        }
+
+        // Clear a wake up left over from an earlier Stop
+        if( descriptors[0].revents & POLLIN )
+        {
+            std::uint64_t wake;
+            ssize_t wakeRead = read( mWakeEvent, &wake, sizeof( wake ) );
+            (void)wakeRead;
+        }
+
+        std::uint64_t expirations;
+        ssize_t bytesRead = read( mTimer, &expirations, sizeof( expirations ) );
+        (void)bytesRead;
+
+        // Collect due timers, callbacks run without the mutex so they can reschedule
+        std::vector<std::tuple<std::chrono::steady_clock::time_point, TimerId, unsigned long>> due;
+        {
+            std::lock_guard<std::mutex> lock( mMutex );
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            std::chrono::steady_clock::time_point next = std::chrono::steady_clock::time_point::max();
+            for( TimerId id = 0; id < mTimers.size(); ++id )
+            {
+                Timer& timer = mTimers[id];
+                if( !timer.armed )
+                {
+                    continue;
+                }
+
+                if( timer.deadline <= now )
+                {
+                    timer.armed = false;
+                    due.emplace_back( timer.deadline, id, timer.generation );
+                }
+                else if( timer.deadline < next )
+                {
+                    next = timer.deadline;
+                }
+            }
+            Arm( next );
+        }
+
+        std::sort( due.begin(), due.end() );
+        for( std::tuple<std::chrono::steady_clock::time_point, TimerId, unsigned long> const& dueTimer : due )
+        {
+            // Skip timers cancelled or rescheduled by an earlier callback or another thread
+            std::function<void ()> callback;
+            {
+                std::lock_guard<std::mutex> lock( mMutex );
+                Timer const& timer = mTimers[std::get<1>( dueTimer )];
+                if( timer.generation != std::get<2>( dueTimer ) )
+                {
+                    continue;
+                }
+                callback = timer.callback;
+            }
+            callback();
+        }
+    }
+}
+
+/**
+    Arms the kernel timer for an absolute deadline, time_point::max()
+    disarms it
+
+    @pre mMutex is locked
+*/
+void HabitScheduler::Arm( std::chrono::steady_clock::time_point aDeadline )
+{
+    mArmedDeadline = aDeadline;
+
+    itimerspec expiry = {};
+    if( aDeadline != std::chrono::steady_clock::time_point::max() )
+    {
+        std::chrono::nanoseconds sinceEpoch = aDeadline.time_since_epoch();
+        expiry.it_value.tv_sec = std::chrono::duration_cast<std::chrono::seconds>( sinceEpoch ).count();
+        expiry.it_value.tv_nsec = ( sinceEpoch % std::chrono::seconds( 1 ) ).count();
+
+        // A zero expiry disarms the timer, deadlines at the epoch fire straight away instead
+        if( expiry.it_value.tv_sec == 0 && expiry.it_value.tv_nsec == 0 )
+        {
+            expiry.it_value.tv_nsec = 1;
+        }
+    }
+    timerfd_settime( mTimer, TFD_TIMER_ABSTIME, &expiry, nullptr );
+}
@@ -0,0 +1,41 @@
+/**
+    Definition of HogFaceDetectorEngine
+*/
+
+#include "HogFaceDetectorEngine.hpp"
+
+#include <dlib/opencv.h>    // dlib::cv_image
+
+/**
+    Constructor
+
+    @param aWorkers threads detection is spread over, null or a single thread
+            detects on the calling thread
+*/
+HogFaceDetectorEngine::HogFaceDetectorEngine( WorkerPool* aWorkers )
+    : mDetector( dlib::get_frontal_face_detector() )
+{
+    if( aWorkers != nullptr && aWorkers->Size() > 1 )
+    {
+        mPyramidDetector.reset( new HogPyramidDetector( mDetector, *aWorkers ) );
+    }
+}
+
+/**
+    Detects faces in an 8 bit single channel image
+
+    @return rectangles of the faces found, in aImage coordinates
+*/
+std::vector<dlib::rectangle> HogFaceDetectorEngine::Detect( cv::Mat const& aImage )
+{
+    dlib::cv_image<unsigned char> cimg( aImage );
+    return mPyramidDetector ? mPyramidDetector->Detect( cimg ) : mDetector( cimg );
+}
+
+/**
+    @return "hog"
+*/
+char const* HogFaceDetectorEngine::Name() const
+{
+    return "hog";
+}
@@ -0,0 +1,174 @@
+/**
+    Definition of HogPyramidDetector
+*/
+
+#include "HogPyramidDetector.hpp"
+
+#include <algorithm>    // std::sort
+
+/**
+    @return true if aFirst scores lower than aSecond, the order dlib sorts
+            detections in
+*/
+static bool ScoreLess
+    (
+    std::pair<double, dlib::rectangle> const& aFirst,
+    std::pair<double, dlib::rectangle> const& aSecond
+    )
+{
+    return aFirst.first < aSecond.first;
+}
+
+/**
+    @return true if aFirst is less confident than aSecond
+*/
+static bool ConfidenceLess( dlib::rect_detection const& aFirst, dlib::rect_detection const& aSecond )
+{
+    return aFirst.detection_confidence < aSecond.detection_confidence;
+}
+
+/**
+    Constructor
+
+    @param aDetector detector to run, must outlive this object
+    @param aWorkers threads the pyramid levels are scanned on
+*/
+HogPyramidDetector::HogPyramidDetector( dlib::frontal_face_detector const& aDetector, WorkerPool& aWorkers )
+    : mDetector( aDetector )
+    , mWorkers( aWorkers )
+{
+    Scanner const& scanner = mDetector.get_scanner();
+    for( unsigned long i = 0; i < mDetector.num_detectors(); ++i )
+    {
+        // The last weight of each filter is its threshold, see dlib::object_detector
+        mFilterbanks.push_back( scanner.build_fhog_filterbank( mDetector.get_w( i ) ) );
+        mThresholds.push_back( mDetector.get_w( i )( scanner.get_num_dimensions() ) );
+    }
+}
+
+/**
+    Detects faces in a grayscale image
+
+    @return rectangles of the faces found, in aImage coordinates
+*/
+std::vector<dlib::rectangle> HogPyramidDetector::Detect( dlib::cv_image<unsigned char> const& aImage )
+{
+    std::size_t levels = PyramidLevels( aImage );
+
+    // Each level is downscaled from the one above it, as dlib builds the pyramid
+    Pyramid pyramid;
+    while( mLevelImages.size() + 1 < levels )
+    {
+        mLevelImages.emplace_back( new dlib::array2d<unsigned char>() );
+    }
+    for( std::size_t level = 1; level < levels; ++level )
+    {
+        if( level == 1 )
+        {
+            pyramid( aImage, *mLevelImages[0] );
+        }
+        else
+        {
+            pyramid( *mLevelImages[level - 2], *mLevelImages[level - 1] );
+        }
+    }
+
+    while( mScanners.size() < levels )
+    {
+        mScanners.emplace_back( new Scanner() );
+        mScanners.back()->copy_configuration( mDetector.get_scanner() );
+        mScanners.back()->set_max_pyramid_levels( 1 );
+    }
+    mDetections.resize( levels, std::vector<Detections>( mFilterbanks.size() ) );
+
+    // Largest level first, so the levels taken last are the cheapest
+    mWorkers.ParallelFor
+        (
+        levels,
+        [&]( std::size_t aLevel )
+        {
+            Scanner& scanner = *mScanners[aLevel];
+            if( aLevel == 0 )
+            {
+                scanner.load( aImage );
+            }
+            else
+            {
+                scanner.load( *mLevelImages[aLevel - 1] );
+            }
+
+            for( std::size_t filter = 0; filter < mFilterbanks.size(); ++filter )
+            {
+                Detections& detections = mDetections[aLevel][filter];
+                scanner.detect( mFilterbanks[filter], detections, mThresholds[filter] );
+                for( std::pair<double, dlib::rectangle>& detection : detections )
+                {
+                    detection.second = pyramid.rect_up( detection.second, aLevel );
+                }
+            }
+        }
+        );
+
+    // Merge the levels of each filter, then the filters, in the order
+    // dlib::object_detector ranks them
+    std::vector<dlib::rect_detection> candidates;
+    for( std::size_t filter = 0; filter < mFilterbanks.size(); ++filter )
+    {
+        Detections detections;
+        for( std::size_t level = 0; level < levels; ++level )
+        {
+            detections.insert( detections.end(), mDetections[level][filter].begin(), mDetections[level][filter].end() );
+        }
+        std::sort( detections.rbegin(), detections.rend(), ScoreLess );
+
+        for( std::pair<double, dlib::rectangle> const& detection : detections )
+        {
+            dlib::rect_detection candidate;
+            candidate.detection_confidence = detection.first - mThresholds[filter];
+            candidate.weight_index = filter;
+            candidate.rect = detection.second;
+            candidates.push_back( candidate );
+        }
+    }
+    if( mFilterbanks.size() > 1 )
+    {
+        std::sort( candidates.rbegin(), candidates.rend(), ConfidenceLess );
+    }
+
+    // Non-max suppression, a detection overlapping a better one is dropped
+    std::vector<dlib::rectangle> faces;
+    for( dlib::rect_detection const& candidate : candidates )
+    {
+        bool overlaps = false;
+        for( dlib::rectangle const& face : faces )
+        {
+            overlaps = overlaps || mDetector.get_overlap_tester()( face, candidate.rect );
+        }
+        if( !overlaps )
+        {
+            faces.push_back( candidate.rect );
+        }
+    }
+    return faces;
+}
+
+/**
+    @return number of pyramid levels dlib scans for an image, levels stop
+            once they are smaller than the scanner's minimum layer size
+*/
+std::size_t HogPyramidDetector::PyramidLevels( dlib::cv_image<unsigned char> const& aImage ) const
+{
+    Scanner const& scanner = mDetector.get_scanner();
+    Pyramid pyramid;
+    dlib::rectangle rect = dlib::get_rect( aImage );
+    std::size_t levels = 0;
+    do
+    {
+        rect = pyramid.rect_down( rect );
+        ++levels;
+    }
+    while( rect.width() >= scanner.get_min_pyramid_layer_width() &&
+           rect.height() >= scanner.get_min_pyramid_layer_height() &&
+           levels < scanner.get_max_pyramid_levels() );
+    return levels;
+}
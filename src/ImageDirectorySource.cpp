@@ -0,0 +1,70 @@
+/**
+    Definition of ImageDirectorySource
+*/
+
+#include "ImageDirectorySource.hpp"
+
+#include <algorithm>                // std::sort
+#include <opencv2/core.hpp>         // cv::glob
+#include <opencv2/imgcodecs.hpp>    // cv::imread
+
+/**
+    Constructor
+*/
+ImageDirectorySource::ImageDirectorySource( std::string const& aDirectory, double aFrameRate )
+    : mDirectory( aDirectory )
+    , mFrameRate( aFrameRate > 0.0 ? aFrameRate : 30.0 )
+    , mNextFile( 0 )
+{
+}
+
+/**
+    Lists the images in the directory
+
+    @return false if the directory holds no files
+*/
+bool ImageDirectorySource::Open()
+{
+    mFiles.clear();
+    cv::glob( mDirectory + "/*", mFiles, false );
+    std::sort( mFiles.begin(), mFiles.end() );
+    mNextFile = 0;
+    return !mFiles.empty();
+}
+
+/**
+    Forgets the listed images
+*/
+void ImageDirectorySource::Close()
+{
+    mFiles.clear();
+    mNextFile = 0;
+}
+
+/**
+    Loads the next image, skipping files that are not images
+
+    @return false once every image has been read
+*/
+bool ImageDirectorySource::Read( Frame& aFrame )
+{
+    while( mNextFile < mFiles.size() )
+    {
+        std::size_t index = mNextFile++;
+        aFrame.image = cv::imread( mFiles[index], cv::IMREAD_COLOR );
+        if( !aFrame.image.empty() )
+        {
+            aFrame.sourceTime = index / mFrameRate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+    @return false, frames come from a recording
+*/
+bool ImageDirectorySource::IsLive() const
+{
+    return false;
+}
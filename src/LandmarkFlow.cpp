@@ -0,0 +1,201 @@
+/**
+    Definition of LandmarkFlow
+*/
+
+#include "LandmarkFlow.hpp"
+
+#include <algorithm>            // std::find
+#include <cmath>                // std::abs, std::lround
+#include <iterator>             // std::next
+#include <opencv2/imgproc.hpp>  // cv::cvtColor
+#include <opencv2/video/tracking.hpp>   // cv::buildOpticalFlowPyramid, cv::calcOpticalFlowPyrLK
+
+#include "Eye.hpp"
+
+// Number of eye landmarks, and the offsets of the outer eye corners among them
+const unsigned long EYE_PARTS = 12;
+const unsigned long LEFT_EYE_OUTER_CORNER = 0;
+const unsigned long RIGHT_EYE_OUTER_CORNER = 9;
+
+// Window matched around each landmark and the pyramid levels above the frame
+const cv::Size FLOW_WINDOW( 15, 15 );
+const int FLOW_LEVELS = 2;
+// Largest distance a landmark may end up from where it started after flowing
+// forward and back, relative to the distance between the outer eye corners
+const double MAX_FORWARD_BACKWARD_ERROR = 0.02;
+// Largest relative change of the eye aspect ratio from the anchored one, beyond
+// which the eyelids are moving too fast for flow and the predictor takes over
+const double MAX_EYE_ASPECT_RATIO_CHANGE = 0.15;
+
+/**
+    @return eye aspect ratio averaged over both eyes of a shape
+*/
+static double EyeAspectRatio( dlib::full_object_detection const& aShape, unsigned long aFirstEyePart )
+{
+    Eye leftEye = Eye::FromShape( aShape, aFirstEyePart, Eye::LEFT_EYE_PARTS );
+    Eye rightEye = Eye::FromShape( aShape, aFirstEyePart, Eye::RIGHT_EYE_PARTS );
+    return ( leftEye.AspectRatio() + rightEye.AspectRatio() ) / 2.0;
+}
+
+/**
+    Constructor
+
+    @param aInterval the predictor runs at least once every aInterval frames,
+                     1 or less runs it on every frame
+*/
+LandmarkFlow::LandmarkFlow( unsigned int aInterval )
+    : mInterval( aInterval )
+{
+}
+
+/**
+    @return true if landmarks are flowed between predictor runs
+*/
+bool LandmarkFlow::Enabled() const
+{
+    return mInterval > 1;
+}
+
+/**
+    Builds the image pyramid of a frame and forgets faces no longer in view
+
+    @param aFaceIds IDs of the faces found in the frame
+*/
+void LandmarkFlow::BeginFrame( cv::Mat const& aImage, std::vector<unsigned long> const& aFaceIds )
+{
+    if( !Enabled() )
+    {
+        return;
+    }
+
+    for( std::map<unsigned long, Face>::iterator face = mFaces.begin(); face != mFaces.end(); )
+    {
+        bool inView = std::find( aFaceIds.begin(), aFaceIds.end(), face->first ) != aFaceIds.end();
+        face = inView ? std::next( face ) : mFaces.erase( face );
+    }
+    for( unsigned long faceId : aFaceIds )
+    {
+        mFaces[faceId];
+    }
+
+    // Frames without faces have no landmarks to flow into the next frame
+    if( aFaceIds.empty() )
+    {
+        mCurrent.clear();
+        return;
+    }
+
+    cv::Mat intensity = aImage;
+    if( aImage.channels() == 3 )
+    {
+        cv::cvtColor( aImage, intensity, cv::COLOR_BGR2GRAY );
+    }
+    cv::buildOpticalFlowPyramid( intensity, mCurrent, FLOW_WINDOW, FLOW_LEVELS );
+}
+
+/**
+    Flows the eye landmarks of a face from the previous frame into this one
+
+    @param aShape set to the last shape of the face with the flowed eye
+                  landmarks when flow succeeds
+
+    @return false if the predictor has to fit the landmarks instead, because
+            the face is due to be anchored, has not been anchored, or the
+            flow failed its checks
+*/
+bool LandmarkFlow::Track( unsigned long aFaceId, unsigned long aFirstEyePart, dlib::full_object_detection& aShape )
+{
+    std::map<unsigned long, Face>::iterator found = mFaces.find( aFaceId );
+    if( !Enabled() || mPrevious.empty() || mCurrent.empty() || found == mFaces.end() ||
+        !found->second.valid || found->second.framesSinceAnchor + 1 >= mInterval )
+    {
+        return false;
+    }
+    Face& face = found->second;
+
+    std::vector<cv::Point2f> forward;
+    std::vector<cv::Point2f> backward;
+    std::vector<unsigned char> forwardFound;
+    std::vector<unsigned char> backwardFound;
+    std::vector<float> errors;
+    cv::calcOpticalFlowPyrLK( mPrevious, mCurrent, face.eyePoints, forward, forwardFound, errors, FLOW_WINDOW, FLOW_LEVELS );
+    cv::calcOpticalFlowPyrLK( mCurrent, mPrevious, forward, backward, backwardFound, errors, FLOW_WINDOW, FLOW_LEVELS );
+
+    double span = cv::norm( face.eyePoints[LEFT_EYE_OUTER_CORNER] - face.eyePoints[RIGHT_EYE_OUTER_CORNER] );
+    for( unsigned long part = 0; part < EYE_PARTS; ++part )
+    {
+        if( !forwardFound[part] || !backwardFound[part] ||
+            cv::norm( backward[part] - face.eyePoints[part] ) > MAX_FORWARD_BACKWARD_ERROR * span )
+        {
+            face.valid = false;
+            return false;
+        }
+    }
+
+    dlib::full_object_detection shape = face.shape;
+    for( unsigned long part = 0; part < EYE_PARTS; ++part )
+    {
+        shape.part( aFirstEyePart + part ) = dlib::point( std::lround( forward[part].x ), std::lround( forward[part].y ) );
+    }
+
+    double change = std::abs( EyeAspectRatio( shape, aFirstEyePart ) - face.anchorEyeAspectRatio );
+    if( change > MAX_EYE_ASPECT_RATIO_CHANGE * face.anchorEyeAspectRatio )
+    {
+        face.valid = false;
+        return false;
+    }
+
+    face.shape = shape;
+    face.eyePoints = forward;
+    ++face.framesSinceAnchor;
+    aShape = shape;
+    return true;
+}
+
+/**
+    Anchors the landmarks of a face to a shape fitted by the predictor
+*/
+void LandmarkFlow::Anchor( unsigned long aFaceId, unsigned long aFirstEyePart, dlib::full_object_detection const& aShape )
+{
+    std::map<unsigned long, Face>::iterator found = mFaces.find( aFaceId );
+    if( !Enabled() || found == mFaces.end() )
+    {
+        return;
+    }
+
+    Face& face = found->second;
+    face.shape = aShape;
+    face.eyePoints.resize( EYE_PARTS );
+    for( unsigned long part = 0; part < EYE_PARTS; ++part )
+    {
+        dlib::point point = aShape.part( aFirstEyePart + part );
+        face.eyePoints[part] = cv::Point2f( static_cast<float>( point.x() ), static_cast<float>( point.y() ) );
+    }
+    face.anchorEyeAspectRatio = EyeAspectRatio( aShape, aFirstEyePart );
+    face.framesSinceAnchor = 0;
+    face.valid = true;
+}
+
+/**
+    Stops flowing the landmarks of a face until it is anchored again, when
+    its landmarks no longer fit the face
+*/
+void LandmarkFlow::Forget( unsigned long aFaceId )
+{
+    std::map<unsigned long, Face>::iterator found = mFaces.find( aFaceId );
+    if( found != mFaces.end() )
+    {
+        found->second.valid = false;
+    }
+}
+
+/**
+    Keeps the pyramid of this frame to flow from on the next frame
+*/
+void LandmarkFlow::EndFrame()
+{
+    if( Enabled() )
+    {
+        mPrevious.swap( mCurrent );
+    }
+}
@@ -0,0 +1,224 @@
+/**
+    Definition of LandmarkModel
+*/
+
+#include "LandmarkModel.hpp"
+
+#include <chrono>       // std::chrono::steady_clock
+#include <cstdlib>      // getenv
+#include <filesystem>   // std::filesystem
+#include <vector>       // std::vector
+
+// Layout of the supported models. Point indicies surrounding left and right eyes
+// in the 68 point model can be found in the following article:
+// https://ibug.doc.ic.ac.uk/resources/facial-point-annotations/
+const unsigned long FULL_FACE_PARTS = 68;
+const unsigned long FULL_FACE_FIRST_EYE_PART = 36;
+const unsigned long EYE_ONLY_PARTS = 12;
+
+// Extension of converted model caches
+const char* CACHE_EXTENSION = ".spcache";
+
+/**
+    Lists the directories searched for models given by file name, in order:
+    $BLINKPLEASE_MODEL_DIR, include/ next to the build directory holding the
+    executable, the source tree's include/ and ../include relative to the
+    working directory
+
+    @return directories to search
+*/
+static std::vector<std::filesystem::path> ModelDirectories()
+{
+    std::vector<std::filesystem::path> directories;
+
+    if( char const* modelDir = getenv( "BLINKPLEASE_MODEL_DIR" ) )
+    {
+        directories.emplace_back( modelDir );
+    }
+
+    std::error_code error;
+    std::filesystem::path executable = std::filesystem::read_symlink( "/proc/self/exe", error );
+    if( !error )
+    {
+        directories.push_back( executable.parent_path().parent_path() / "include" );
+    }
+
+#ifdef BLINKPLEASE_MODEL_DIR
+    directories.emplace_back( BLINKPLEASE_MODEL_DIR );
+#endif
+
+    directories.emplace_back( "../include" );
+    return directories;
+}
+
+/**
+    Finds a model file, absolute paths and paths containing a directory are
+    used as they are
+
+    @return path of the model, empty if it was not found
+*/
+static std::filesystem::path FindModel( std::string const& aName )
+{
+    std::filesystem::path name( aName );
+    if( name.has_parent_path() )
+    {
+        return std::filesystem::exists( name ) ? name : std::filesystem::path();
+    }
+
+    for( std::filesystem::path const& directory : ModelDirectories() )
+    {
+        std::error_code error;
+        if( std::filesystem::exists( directory / name, error ) )
+        {
+            return directory / name;
+        }
+    }
+    return std::filesystem::path();
+}
+
+/**
+    Picks where the cache of a model is stored, $XDG_CACHE_HOME/blinkplease or
+    ~/.cache/blinkplease, falling back to the directory of the model
+
+    @return path of the cache file for aModelPath
+*/
+static std::filesystem::path CachePath( std::filesystem::path const& aModelPath )
+{
+    std::filesystem::path directory;
+    if( char const* cacheHome = getenv( "XDG_CACHE_HOME" ) )
+    {
+        directory = std::filesystem::path( cacheHome ) / "blinkplease";
+    }
+    else if( char const* home = getenv( "HOME" ) )
+    {
+        directory = std::filesystem::path( home ) / ".cache" / "blinkplease";
+    }
+
+    if( !directory.empty() )
+    {
+        std::error_code error;
+        std::filesystem::create_directories( directory, error );
+        if( error )
+        {
+            directory.clear();
+        }
+    }
+
+    if( directory.empty() )
+    {
+        directory = aModelPath.parent_path();
+    }
+
+    return directory / ( aModelPath.filename().string() + CACHE_EXTENSION );
+}
+
+/**
+    Constructor
+*/
+LandmarkModel::LandmarkModel()
+    : mFirstEyePart( 0 )
+    , mLoadMilliseconds( 0.0 )
+    , mLoadedFromCache( false )
+{
+}
+
+/**
+    Loads a serialized dlib shape predictor, a file name without a directory
+    is searched for in the model directories
+
+    The cache of the model is mapped when it is up to date, otherwise the
+    model is converted and the new cache is mapped.
+
+    @return false if the model could not be found or is not a supported model
+*/
+bool LandmarkModel::Load( std::string const& aPath )
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::filesystem::path modelPath = FindModel( aPath );
+    if( modelPath.empty() )
+    {
+        return false;
+    }
+
+    std::string cachePath = CachePath( modelPath ).string();
+    bool fromCache = mPredictor.Map( cachePath, modelPath.string() );
+    if( !fromCache )
+    {
+        if( !CompactShapePredictor::Convert( modelPath.string(), cachePath ) ||
+            !mPredictor.Map( cachePath, modelPath.string() ) )
+        {
+            return false;
+        }
+    }
+
+    if( mPredictor.NumParts() == FULL_FACE_PARTS )
+    {
+        mFirstEyePart = FULL_FACE_FIRST_EYE_PART;
+    }
+    else if( mPredictor.NumParts() == EYE_ONLY_PARTS )
+    {
+        mFirstEyePart = 0;
+    }
+    else
+    {
+        mPredictor.Unmap();
+        return false;
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    mPath = modelPath.string();
+    mLoadMilliseconds = elapsed.count();
+    mLoadedFromCache = fromCache;
+    return true;
+}
+
+/**
+    Fits landmarks to a face
+
+    @return landmarks of the face, eye landmarks start at FirstEyePart
+*/
+dlib::full_object_detection LandmarkModel::Fit( cv::Mat const& aImage, dlib::rectangle const& aFace ) const
+{
+    return mPredictor.Fit( aImage, aFace );
+}
+
+/**
+    @return index of the first of the twelve eye landmarks
+*/
+unsigned long LandmarkModel::FirstEyePart() const
+{
+    return mFirstEyePart;
+}
+
+/**
+    @return number of landmarks fitted by the model, 0 if no model is loaded
+*/
+unsigned long LandmarkModel::NumParts() const
+{
+    return mPredictor.NumParts();
+}
+
+/**
+    @return path of the loaded dlib model
+*/
+std::string const& LandmarkModel::Path() const
+{
+    return mPath;
+}
+
+/**
+    @return time the last successful Load took in milliseconds
+*/
+double LandmarkModel::LoadMilliseconds() const
+{
+    return mLoadMilliseconds;
+}
+
+/**
+    @return true if the last successful Load mapped an existing cache
+*/
+bool LandmarkModel::LoadedFromCache() const
+{
+    return mLoadedFromCache;
+}
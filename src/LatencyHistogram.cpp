@@ -0,0 +1,84 @@
+/**
+    Definition of LatencyHistogram
+*/
+
+#include "LatencyHistogram.hpp"
+
+// Upper bound of the first bucket, every following bucket doubles it
+const std::uint64_t FIRST_BUCKET_MICROSECONDS = 250;
+
+/**
+    Constructor
+*/
+LatencyHistogram::LatencyHistogram()
+    : mSumMicroseconds( 0 )
+{
+    for( std::atomic<std::uint64_t>& count : mCounts )
+    {
+        count = 0;
+    }
+}
+
+/**
+    Records a duration, safe to call from any thread without locking
+*/
+void LatencyHistogram::Record( std::chrono::steady_clock::duration aDuration )
+{
+    std::uint64_t microseconds = static_cast<std::uint64_t>
+        (
+        std::chrono::duration_cast<std::chrono::microseconds>( aDuration ).count()
+        );
+
+    std::size_t bucket = 0;
+    std::uint64_t bound = FIRST_BUCKET_MICROSECONDS;
+    while( bucket < BUCKETS && microseconds > bound )
+    {
+        ++bucket;
+        bound *= 2;
+    }
+
+    mCounts[bucket].fetch_add( 1, std::memory_order_relaxed );
+    mSumMicroseconds.fetch_add( microseconds, std::memory_order_relaxed );
+}
+
+/**
+    Writes the histogram in the Prometheus text exposition format, with
+    cumulative buckets labelled by their upper bound in seconds
+*/
+void LatencyHistogram::WritePrometheus
+    (
+    std::ostream& aOut,
+    std::string const& aName,
+    std::string const& aHelp
+    ) const
+{
+    aOut << "# HELP " << aName << " " << aHelp << "\n";
+    aOut << "# TYPE " << aName << " histogram\n";
+
+    std::uint64_t cumulative = 0;
+    std::uint64_t bound = FIRST_BUCKET_MICROSECONDS;
+    for( std::size_t bucket = 0; bucket < BUCKETS; ++bucket )
+    {
+        cumulative += mCounts[bucket].load( std::memory_order_relaxed );
+        aOut << aName << "_bucket{le=\"" << bound / 1e6 << "\"} " << cumulative << "\n";
+        bound *= 2;
+    }
+    cumulative += mCounts[BUCKETS].load( std::memory_order_relaxed );
+
+    aOut << aName << "_bucket{le=\"+Inf\"} " << cumulative << "\n";
+    aOut << aName << "_sum " << mSumMicroseconds.load( std::memory_order_relaxed ) / 1e6 << "\n";
+    aOut << aName << "_count " << cumulative << "\n";
+}
+
+/**
+    @return mean of the recorded durations in seconds, 0 if none were recorded
+*/
+double LatencyHistogram::MeanSeconds() const
+{
+    std::uint64_t count = 0;
+    for( std::atomic<std::uint64_t> const& bucketCount : mCounts )
+    {
+        count += bucketCount.load( std::memory_order_relaxed );
+    }
+    return ( count > 0 ) ? mSumMicroseconds.load( std::memory_order_relaxed ) / 1e6 / count : 0.0;
+}
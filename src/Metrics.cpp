@@ -0,0 +1,73 @@
+/**
+    Definition of Metrics
+*/
+
+#include "Metrics.hpp"
+
+/**
+    Writes a counter in the Prometheus text exposition format
+*/
+static void WriteCounter
+    (
+    std::ostream& aOut,
+    char const* aName,
+    char const* aHelp,
+    std::atomic<std::uint64_t> const& aValue
+    )
+{
+    aOut << "# HELP " << aName << " " << aHelp << "\n";
+    aOut << "# TYPE " << aName << " counter\n";
+    aOut << aName << " " << aValue.load( std::memory_order_relaxed ) << "\n";
+}
+
+/**
+    Constructor
+*/
+Metrics::Metrics()
+    : framesCaptured( 0 )
+    , framesDropped( 0 )
+    , framesSkipped( 0 )
+    , framesBackedOff( 0 )
+    , framesTracked( 0 )
+    , landmarksFlowed( 0 )
+    , framesNoFace( 0 )
+    , framesMultipleFaces( 0 )
+    , blinks( 0 )
+    , blinkReminders( 0 )
+    , restReminders( 0 )
+    , restChecks( 0 )
+    , restChecksEyesClosed( 0 )
+    , cameraReleases( 0 )
+    , eventsDropped( 0 )
+    , nightLightChanges( 0 )
+    , nightLightSkipped( 0 )
+{
+}
+
+/**
+    Writes every metric in the Prometheus text exposition format
+*/
+void Metrics::WritePrometheus( std::ostream& aOut ) const
+{
+    detectTime.WritePrometheus( aOut, "blinkplease_detect_seconds", "Time spent running the full frame face detector" );
+    landmarkTime.WritePrometheus( aOut, "blinkplease_landmark_seconds", "Time spent fitting landmarks to a face" );
+    frameLatency.WritePrometheus( aOut, "blinkplease_frame_latency_seconds", "Time from reading a frame to finishing its eye aspect ratio" );
+
+    WriteCounter( aOut, "blinkplease_frames_captured_total", "Frames read from the frame source", framesCaptured );
+    WriteCounter( aOut, "blinkplease_frames_dropped_total", "Frames discarded because a later stage was busy", framesDropped );
+    WriteCounter( aOut, "blinkplease_frames_skipped_total", "Frames skipped to stay within the CPU budget", framesSkipped );
+    WriteCounter( aOut, "blinkplease_frames_backed_off_total", "Frames not processed because nobody was in view or the user was resting", framesBackedOff );
+    WriteCounter( aOut, "blinkplease_frames_tracked_total", "Frames where the tracked face was reused instead of detecting", framesTracked );
+    WriteCounter( aOut, "blinkplease_landmarks_flowed_total", "Faces whose eye landmarks were flowed instead of fitted", landmarksFlowed );
+    WriteCounter( aOut, "blinkplease_frames_no_face_total", "Frames without a face", framesNoFace );
+    WriteCounter( aOut, "blinkplease_frames_multiple_faces_total", "Frames with more than one face", framesMultipleFaces );
+    WriteCounter( aOut, "blinkplease_blinks_total", "Blinks detected", blinks );
+    WriteCounter( aOut, "blinkplease_blink_reminders_total", "Reminders to blink", blinkReminders );
+    WriteCounter( aOut, "blinkplease_rest_reminders_total", "Reminders to rest", restReminders );
+    WriteCounter( aOut, "blinkplease_rest_checks_total", "Checks of the eyes during rests", restChecks );
+    WriteCounter( aOut, "blinkplease_rest_checks_eyes_closed_total", "Checks of the eyes during rests that found them closed", restChecksEyesClosed );
+    WriteCounter( aOut, "blinkplease_camera_releases_total", "Times a camera was released because nobody was in view", cameraReleases );
+    WriteCounter( aOut, "blinkplease_events_dropped_total", "Events dropped because the event bus was full", eventsDropped );
+    WriteCounter( aOut, "blinkplease_night_light_changes_total", "Night light changes applied to the desktop", nightLightChanges );
+    WriteCounter( aOut, "blinkplease_night_light_skipped_total", "Night light changes skipped because nothing changed", nightLightSkipped );
+}
@@ -0,0 +1,246 @@
+/**
+    Definition of MetricsExporter
+*/
+
+#include "MetricsExporter.hpp"
+
+#include <cstdio>           // std::rename
+#include <fstream>          // std::ofstream
+#include <poll.h>           // poll
+#include <sstream>          // std::ostringstream
+#include <sys/eventfd.h>    // eventfd
+#include <sys/socket.h>     // socket, bind, listen, accept4, send
+#include <sys/stat.h>       // chmod, lstat
+#include <sys/un.h>         // sockaddr_un
+#include <unistd.h>         // close, unlink, write
+
+// Rolling windows of BlinkStatistics and their label values
+const BlinkStatistics::Window WINDOWS[] = { BlinkStatistics::Window::MINUTE, BlinkStatistics::Window::HOUR, BlinkStatistics::Window::DAY };
+const char* const WINDOW_LABELS[] = { "1m", "1h", "1d" };
+
+/**
+    Removes a socket left behind at aPath by an earlier run. Anything else at
+    aPath is kept, so binding to it fails rather than deleting a user's file.
+*/
+static void RemoveStaleSocket( std::string const& aPath )
+{
+    struct stat status;
+    if( lstat( aPath.c_str(), &status ) == 0 && S_ISSOCK( status.st_mode ) )
+    {
+        unlink( aPath.c_str() );
+    }
+}
+
+/**
+    Constructor
+*/
+MetricsExporter::MetricsExporter
+    (
+    Metrics const& aMetrics,
+    BlinkStatistics const& aStatistics,
+    MetricsSettings const& aSettings
+    )
+    : mMetrics( aMetrics )
+    , mStatistics( aStatistics )
+    , mSettings( aSettings )
+    , mSocket( -1 )
+    , mWakeEvent( -1 )
+    , mExitExporter( false )
+{
+    if( mSettings.intervalSeconds <= 0 )
+    {
+        mSettings.intervalSeconds = 1;
+    }
+}
+
+/**
+    Destructor
+*/
+MetricsExporter::~MetricsExporter()
+{
+    Stop();
+}
+
+/**
+    Opens the socket and starts the export thread
+*/
+void MetricsExporter::Start()
+{
+    if( !mSettings.socketPath.empty() )
+    {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if( mSettings.socketPath.size() < sizeof( address.sun_path ) )
+        {
+            mSettings.socketPath.copy( address.sun_path, mSettings.socketPath.size() );
+            RemoveStaleSocket( mSettings.socketPath );
+
+            // The metrics describe the user's blinks, so only the user may connect
+            mSocket = socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+            if( mSocket >= 0 )
+            {
+                bool bound = bind( mSocket, reinterpret_cast<sockaddr*>( &address ), sizeof( address ) ) == 0;
+                if( !bound ||
+                    chmod( mSettings.socketPath.c_str(), S_IRUSR | S_IWUSR ) != 0 ||
+                    listen( mSocket, 4 ) != 0 )
+                {
+                    close( mSocket );
+                    mSocket = -1;
+                    if( bound )
+                    {
+                        unlink( mSettings.socketPath.c_str() );
+                    }
+                }
+            }
+        }
+    }
+
+    mWakeEvent = eventfd( 0, EFD_CLOEXEC );
+    mExitExporter = false;
+    mThread = std::thread( &MetricsExporter::Export, this );
+}
+
+/**
+    Wakes up and exits the export thread, writing the metrics file one last time
+*/
+void MetricsExporter::Stop()
+{
+    if( !mThread.joinable() )
+    {
+        return;
+    }
+
+    mExitExporter = true;
+    std::uint64_t wake = 1;
+    ssize_t written = write( mWakeEvent, &wake, sizeof( wake ) );
+    (void)written;
+    mThread.join();
+
+    if( !mSettings.filePath.empty() )
+    {
+        WriteFile( Render() );
+    }
+
+    if( mSocket >= 0 )
+    {
+        close( mSocket );
+        unlink( mSettings.socketPath.c_str() );
+        mSocket = -1;
+    }
+    close( mWakeEvent );
+    mWakeEvent = -1;
+}
+
+/**
+    Serves socket clients and writes the metrics file every interval until
+    woken up to exit
+*/
+void MetricsExporter::Export()
+{
+    std::chrono::steady_clock::duration interval = std::chrono::seconds( mSettings.intervalSeconds );
+    std::chrono::steady_clock::time_point nextWrite = std::chrono::steady_clock::now() + interval;
+
+    while( !mExitExporter )
+    {
+        pollfd descriptors[2] = { { mWakeEvent, POLLIN, 0 }, { mSocket, POLLIN, 0 } };
+        int timeout = static_cast<int>
+            (
+            std::chrono::duration_cast<std::chrono::milliseconds>( nextWrite - std::chrono::steady_clock::now() ).count()
+            );
+        poll( descriptors, ( mSocket >= 0 ) ? 2 : 1, ( timeout > 0 ) ? timeout : 0 );
+
+        if( descriptors[0].revents & POLLIN )
+        {
+            break;
+        }
+
+        if( mSocket >= 0 && ( descriptors[1].revents & POLLIN ) )
+        {
+            int client = accept4( mSocket, nullptr, nullptr, SOCK_CLOEXEC );
+            if( client >= 0 )
+            {
+                std::string text = Render();
+                send( client, text.data(), text.size(), MSG_NOSIGNAL );
+                close( client );
+            }
+        }
+
+        if( std::chrono::steady_clock::now() >= nextWrite )
+        {
+            if( !mSettings.filePath.empty() )
+            {
+                WriteFile( Render() );
+            }
+            nextWrite += interval;
+        }
+    }
+}
+
+/**
+    Renders the metrics and the rolling blink statistics gauges
+
+    @return metrics in the Prometheus text format
+*/
+std::string MetricsExporter::Render() const
+{
+    std::ostringstream text;
+    mMetrics.WritePrometheus( text );
+
+    WindowStatistics windows[3];
+    for( std::size_t i = 0; i < 3; ++i )
+    {
+        windows[i] = mStatistics.Query( WINDOWS[i] );
+    }
+
+    text << "# HELP blinkplease_blinks_per_minute Blinks per minute over the last minute\n";
+    text << "# TYPE blinkplease_blinks_per_minute gauge\n";
+    text << "blinkplease_blinks_per_minute " << windows[0].blinksPerMinute << "\n";
+
+    text << "# HELP blinkplease_blink_rate_per_minute Blinks per minute over a rolling window\n";
+    text << "# TYPE blinkplease_blink_rate_per_minute gauge\n";
+    for( std::size_t i = 0; i < 3; ++i )
+    {
+        text << "blinkplease_blink_rate_per_minute{window=\"" << WINDOW_LABELS[i] << "\"} " << windows[i].blinksPerMinute << "\n";
+    }
+
+    text << "# HELP blinkplease_blink_interval_seconds Time between blinks over a rolling window\n";
+    text << "# TYPE blinkplease_blink_interval_seconds gauge\n";
+    for( std::size_t i = 0; i < 3; ++i )
+    {
+        text << "blinkplease_blink_interval_seconds{window=\"" << WINDOW_LABELS[i] << "\",quantile=\"0.5\"} " << windows[i].medianInterval << "\n";
+        text << "blinkplease_blink_interval_seconds{window=\"" << WINDOW_LABELS[i] << "\",quantile=\"0.9\"} " << windows[i].interval90 << "\n";
+    }
+
+    text << "# HELP blinkplease_blink_reminder_ratio Share of a rolling window the blink reminder was showing\n";
+    text << "# TYPE blinkplease_blink_reminder_ratio gauge\n";
+    for( std::size_t i = 0; i < 3; ++i )
+    {
+        text << "blinkplease_blink_reminder_ratio{window=\"" << WINDOW_LABELS[i] << "\"} " << windows[i].reminderShare << "\n";
+    }
+
+    text << "# HELP blinkplease_rest_seconds Time spent resting the eyes over a rolling window\n";
+    text << "# TYPE blinkplease_rest_seconds gauge\n";
+    for( std::size_t i = 0; i < 3; ++i )
+    {
+        text << "blinkplease_rest_seconds{window=\"" << WINDOW_LABELS[i] << "\"} " << windows[i].restSeconds << "\n";
+    }
+    return text.str();
+}
+
+/**
+    Replaces the metrics file, writing a temporary file first so readers
+    never see a partial file
+*/
+void MetricsExporter::WriteFile( std::string const& aText )
+{
+    std::string temporaryPath = mSettings.filePath + ".tmp";
+    {
+        std::ofstream file( temporaryPath, std::ios::trunc );
+        file << aText;
+        if( !file )
+        {
+            return;
+        }
+    }
+    std::rename( temporaryPath.c_str(), mSettings.filePath.c_str() );
+}
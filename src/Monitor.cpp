@@ -4,31 +4,161 @@
 
 #include "Monitor.hpp"
 
-#include <dlib/image_processing.h> 						 	// dlib::shape_predictor
-#include <dlib/image_processing/frontal_face_detector.h>	// dlib::frontal_face_detector
-#include <dlib/opencv.h>									// dlib::cv_image, dlib::bgr_pixel
-#include <opencv2/opencv.hpp>								// cv::VideoCapture
+#include <algorithm>										// std::min, std::max
+#include <cmath>											// std::floor
+#include <functional>										// std::bind, std::ref
+#include <iostream>											// std::cout, std::cerr
+#include <opencv2/imgproc.hpp>								// cv::cvtColor, cv::resize
 
 #include "Eye.hpp"
 
-// Threshold parameters for detecting blinks
-const double EYE_ASPECT_RATIO_THRESHOLD = 0.2;
-const int EYE_ASPECT_RATIO_CONSECUTIVE_FRAMES = 2;
+// Landmark models tried in order when no model is set in MonitorSettings,
+// searched for in the model directories, see LandmarkModel::Load
+const char* EYE_LANDMARK_MODEL_PATH = "shape_predictor_12_eye_landmarks.dat";
+const char* FACE_LANDMARK_MODEL_PATH = "shape_predictor_68_face_landmarks.dat";
+
+// Number of frames each camera's queue holds before dropping the oldest
+const std::size_t CAPTURED_FRAMES_CAPACITY = 1;
+// Frame buffers of each camera: one being read, those queued and one being processed
+const std::size_t FRAME_BUFFERS = CAPTURED_FRAMES_CAPACITY + 2;
+
+// Length of the time slots the best view of the eyes is picked for, one
+// frame of a typical webcam
+const double VIEW_SLOT_SECONDS = 1.0 / 30.0;
+
+// Time between opening a released camera to look for motion, the frames read
+// each time so exposure settles first, the size of the thumbnails compared and
+// the mean change in intensity of a thumbnail pixel that counts as motion
+const std::chrono::seconds MOTION_PROBE_INTERVAL( 2 );
+const int MOTION_PROBE_FRAMES = 5;
+const cv::Size MOTION_THUMBNAIL_SIZE( 32, 24 );
+const double MOTION_THRESHOLD = 8.0;
+
+/**
+    @return small intensity copy of a frame, compared to find motion
+*/
+static cv::Mat MotionThumbnail( cv::Mat const& aImage )
+{
+    cv::Mat intensity = aImage;
+    if( aImage.channels() == 3 )
+    {
+        cv::cvtColor( aImage, intensity, cv::COLOR_BGR2GRAY );
+    }
+    cv::Mat thumbnail;
+    cv::resize( intensity, thumbnail, MOTION_THUMBNAIL_SIZE, 0.0, 0.0, cv::INTER_AREA );
+    return thumbnail;
+}
+
+/**
+    @return frame sources of every camera, the default webcam when none are set
+*/
+static std::vector<std::string> FrameSources( MonitorSettings const& aSettings )
+{
+    return aSettings.frameSources.empty()
+        ? std::vector<std::string>( 1, std::string() )
+        : aSettings.frameSources;
+}
+
+/**
+    @return number of worker threads set in the settings, or one per core.
+            Frames of one camera are processed in order by a single worker,
+            the other workers fit the landmarks of further faces in parallel.
+*/
+static unsigned int WorkerThreads( MonitorSettings const& aSettings )
+{
+    if( aSettings.workerThreads > 0 )
+    {
+        return aSettings.workerThreads;
+    }
+    return std::max( std::thread::hardware_concurrency(), 1u );
+}
+
+/**
+    Constructor
+*/
+Monitor::Camera::Camera
+    (
+    std::size_t aIndex,
+    std::string const& aFrameSource,
+    MonitorSettings const& aSettings,
+    WorkerPool& aWorkers
+    )
+    : index( aIndex )
+    , frameSource( FrameSource::Create( aFrameSource, aSettings.replayFrameRate, aSettings.lumaCapture ) )
+    , faceDetector( aSettings.detectionScale, &aWorkers, aSettings.faceDetector, aSettings.faceModelPath )
+    , faceTracker( aSettings.faceDetectionStride )
+    , landmarkFlow( aSettings.landmarkInterval )
+    , faceRoster( aIndex )
+    , dutyCycle( frameSource->IsLive() )
+    , framePool( FRAME_BUFFERS )
+    , capturedFrames( CAPTURED_FRAMES_CAPACITY )
+    , scheduled( false )
+{
+}
 
 /**
     Constructor
 */
-Monitor::Monitor()
-    : mExitMonitoring( false )
+Monitor::Monitor
+    (
+    Metrics& aMetrics,
+    EventBus& aEventBus,
+    MonitorSettings const& aSettings,
+    EventLog* aEventLog
+    )
+    : mMetrics( aMetrics )
+    , mEventLog( aEventLog )
+    , mEventBus( aEventBus )
+    , mProducer( aEventBus.AddProducer() )
+    , mDropFrames( aSettings.realTime )
+    , mRealTime( aSettings.realTime )
+    , mGovernor( aSettings )
+    , mWorkers( WorkerThreads( aSettings ) )
+    , mLandmarkModelPath( aSettings.landmarkModelPath )
+    , mReportedStartup( false )
+    , mViewSelector( FrameSources( aSettings ).size(), VIEW_SLOT_SECONDS )
+    , mEyeAspectRatioSum( 0.0 )
+    , mEyeAspectRatioCount( 0 )
+    , mEyeAspectRatioSecond( 0.0 )
+    , mResting( false )
+    , mRestChecks( 0 )
+    , mRestChecksEyesClosed( 0 )
+    , mCalibrationPath( aSettings.calibrationPath )
+    , mPaused( false )
+    , mExitMonitoring( false )
 {
+    for( std::string const& frameSource : FrameSources( aSettings ) )
+    {
+        mCameras.emplace_back( new Camera( mCameras.size(), frameSource, aSettings, mWorkers ) );
+        mGovernor.AddCamera( mCameras.back()->faceDetector, mCameras.back()->faceTracker );
+    }
+    mDropFrames = mDropFrames || IsLive();
+    if( !mCameras.empty() )
+    {
+        std::cout << "Detecting faces with " << mCameras.front()->faceDetector.Name() << std::endl;
+    }
+
+    if( !mCalibrationPath.empty() && mBlinkDetector.Load( mCalibrationPath ) )
+    {
+        std::cout << "Loaded blink calibration from " << mCalibrationPath << std::endl;
+    }
 }
 
 /**
-    Starts thread for monitoring eyes
+    Starts the worker pool and a thread grabbing frames for each camera
+
+    The landmark model is loaded in the background while the frame sources open.
 */
 void Monitor::Start()
 {
-    mThread = std::thread( &Monitor::TrackEyes, this );
+    mStartTime = std::chrono::steady_clock::now();
+    mLandmarkModelLoaded = std::async( std::launch::async, &Monitor::LoadLandmarkModel, this ).share();
+
+    mWorkers.Start();
+    for( std::unique_ptr<Camera>& camera : mCameras )
+    {
+        camera->grabThread = std::thread( &Monitor::GrabFrames, this, std::ref( *camera ) );
+    }
 }
 
 /**
@@ -36,114 +166,682 @@ void Monitor::Start()
 */
 void Monitor::Stop()
 {
-    mExitMonitoring = true;
-    if( mThread.joinable() )
     {
-        mThread.join();
+        std::lock_guard<std::mutex> lock( mCondVarMutex );
+        mExitMonitoring = true;
+    }
+    mCondVar.notify_all();
+    for( std::unique_ptr<Camera>& camera : mCameras )
+    {
+        camera->capturedFrames.Close();
+        camera->framePool.Close();
+    }
+
+    for( std::unique_ptr<Camera>& camera : mCameras )
+    {
+        if( camera->grabThread.joinable() )
+        {
+            camera->grabThread.join();
+        }
+    }
+    mWorkers.Stop();
+
+    if( !mCalibrationPath.empty() && !mBlinkDetector.Save( mCalibrationPath ) )
+    {
+        std::cerr << "Could not save blink calibration to " << mCalibrationPath << std::endl;
+    }
+}
+
+/**
+    Waits until every frame of the recordings has been processed. Returns
+    straight away when a live camera is used, which only ends when stopped.
+*/
+void Monitor::WaitUntilFinished()
+{
+    if( IsLive() )
+    {
+        return;
+    }
+
+    for( std::unique_ptr<Camera>& camera : mCameras )
+    {
+        if( camera->grabThread.joinable() )
+        {
+            camera->grabThread.join();
+        }
+    }
+    mWorkers.WaitIdle();
+
+    std::vector<View> completed;
+    std::lock_guard<std::mutex> lock( mViewMutex );
+    mViewSelector.Flush( completed );
+    DetectBlinks( completed );
+}
+
+/**
+    @return true if frames come from at least one live webcam rather than
+            only from recordings
+*/
+bool Monitor::IsLive() const
+{
+    for( std::unique_ptr<Camera> const& camera : mCameras )
+    {
+        if( camera->frameSource->IsLive() )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+    @return blink detector holding the calibration learned for the user
+*/
+BlinkDetector const& Monitor::Calibration() const
+{
+    return mBlinkDetector;
+}
+
+/**
+    Stops processing frames while keeping the cameras open and the landmark
+    model loaded, so Resume picks up again straight away
+*/
+void Monitor::Pause()
+{
+    mPaused = true;
+}
+
+/**
+    Processes frames again after Pause
+*/
+void Monitor::Resume()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    for( std::unique_ptr<Camera>& camera : mCameras )
+    {
+        camera->dutyCycle.Wake( now );
     }
+    mPaused = false;
 }
 
 /**
-    Registers callback for mUserBlinked signal
+    @return true between Pause and Resume
+*/
+bool Monitor::IsPaused() const
+{
+    return mPaused;
+}
 
-    @return connection to mUserBlinked signal
+/**
+    Called for REST_REMINDER events of Rest, checks at a low rate that the eyes
+    are closed instead of detecting blinks until OnRestEnded
+*/
+void Monitor::OnRestStarted()
+{
+	{
+		std::lock_guard<std::mutex> lock( mViewMutex );
+		mResting = true;
+		mRestChecks = 0;
+		mRestChecksEyesClosed = 0;
+	}
+	for( std::unique_ptr<Camera>& camera : mCameras )
+	{
+		camera->dutyCycle.SetResting( true );
+	}
+}
+
+/**
+    Called for REST_CANCEL events of Rest, reports how much of the rest the eyes
+    were closed and detects blinks again
+*/
+void Monitor::OnRestEnded()
+{
+	for( std::unique_ptr<Camera>& camera : mCameras )
+	{
+		camera->dutyCycle.SetResting( false );
+	}
+
+	std::lock_guard<std::mutex> lock( mViewMutex );
+	if( mResting && mRestChecks > 0 )
+	{
+		std::cout << "Eyes closed in " << 100 * mRestChecksEyesClosed / mRestChecks << "% of checks during the rest" << std::endl;
+	}
+	mResting = false;
+}
+
+/**
+    Changes the blink interval the CPU governor paces frames by
+*/
+void Monitor::SetBlinkInterval( int aBlinkInterval )
+{
+    mGovernor.SetBlinkInterval( aBlinkInterval );
+}
+
+/**
+    Overrides the learned blink threshold of the user and of every face each
+    camera sees, see BlinkDetector::SetFixedThreshold
+*/
+void Monitor::SetBlinkThreshold( double aThreshold )
+{
+    mBlinkDetector.SetFixedThreshold( aThreshold );
+    for( std::unique_ptr<Camera> const& camera : mCameras )
+    {
+        camera->faceRoster.SetFixedThreshold( aThreshold );
+    }
+}
+
+/**
+    @return blink counts of the faces every camera has seen recently
+*/
+std::vector<FaceStatus> Monitor::Faces() const
+{
+    std::vector<FaceStatus> faces;
+    for( std::unique_ptr<Camera> const& camera : mCameras )
+    {
+        std::vector<FaceStatus> cameraFaces = camera->faceRoster.Status();
+        faces.insert( faces.end(), cameraFaces.begin(), cameraFaces.end() );
+    }
+    return faces;
+}
+
+/**
+    Registers callback for USER_BLINKED events, run on the event bus thread
+
+    @return connection to the callback
 */
 boost::signals2::connection Monitor::RegisterUserBlinked
     (
     boost::signals2::signal<void ()>::slot_type const& aSlot
     )
 {
-    return mUserBlinked.connect( aSlot );
+    return mEventBus.Subscribe( BusEvent::USER_BLINKED, aSlot );
 }
 
 /**
-    Tracks users eyes and sends mUserBlinked signal every time user blinks
+    Reads frames from a camera as fast as it delivers them, skipping those
+    mGovernor decides are not needed, and has a worker process them
 
-	Method of determining if eyes are open or not is described in this paper:
-	http://vision.fe.uni-lj.si/cvww2016/proceedings/papers/05.pdf. Using landmarks on the face
-	surrounding the eye, the eye aspect ratio is calculated which represents the ratio of the
-	height of the eye to the width of the eye. If this ratio falls below the set threshold in
-	a particular frame, the counter is incremented. When this ratio is not below the set threshold,
-	the number of consecutive frames the eye was closed is checked. If the number of consecutive
-	frames is above the set threhold the user has blinked, otherwise the counter is reset.
+    Frames are read into buffers of the camera's FramePool, which return to
+    the pool once the frame is processed or dropped. Only the most recent
+    frame is kept in the camera's queue, older frames are discarded so the
+    workers never work on a stale image. Recordings are
+    paced to their recorded frame rate unless real time replay is off, in
+    which case every frame is processed as fast as possible.
 */
-void Monitor::TrackEyes()
+void Monitor::GrabFrames( Camera& aCamera )
 {
-	// Open webcam for detecting blinks
-	cv::VideoCapture videoCapture( 0 );
-	if( !videoCapture.isOpened() )
+	// Open webcam or recording for detecting blinks
+	if( !aCamera.frameSource->Open() )
 	{
+		aCamera.capturedFrames.Close();
+		RemoveCamera( aCamera.index );
 		return;
 	}
 
-	// Tracks how many consecutive frames eye aspect ratio is below EYE_ASPECT_RATIO_THRESHOLD
-	int counter = 0;
+	std::chrono::steady_clock::time_point openedTime = std::chrono::steady_clock::now();
+	std::chrono::duration<double, std::milli> openTime = openedTime - mStartTime;
+	std::cout << "Frame source " << aCamera.index << " opened in " << openTime.count() << " ms" << std::endl;
+	aCamera.dutyCycle.Wake( openedTime );
+
+	bool paced = !aCamera.frameSource->IsLive() && mRealTime;
+	unsigned long sequence = 0;
+
+	while( !mExitMonitoring )
+	{
+		// Capture single frame of video into a pooled buffer. Webcams and
+		// videos reuse its pixels once it has grown to the frame size, image
+		// directories decode every file into a new image
+		Frame frame;
+		frame.buffer = aCamera.framePool.Acquire();
+		if( !frame.buffer )
+		{
+			break;
+		}
+		frame.image = frame.buffer.Image();
+		if( !aCamera.frameSource->Read( frame ) )
+		{
+			break;
+		}
+		frame.buffer.Image() = frame.image;
+
+		if( paced )
+		{
+			std::this_thread::sleep_until
+				(
+				openedTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>
+					(
+					std::chrono::duration<double>( frame.sourceTime )
+					)
+				);
+		}
+
+		frame.captureTime = std::chrono::steady_clock::now();
+		mMetrics.framesCaptured.fetch_add( 1, std::memory_order_relaxed );
+
+		// Frames keep being read while paused so the camera keeps streaming
+		if( mPaused )
+		{
+			continue;
+		}
+
+		// After a long absence the camera is released until something moves
+		if( aCamera.dutyCycle.ShouldRelease( frame.captureTime ) )
+		{
+			if( !ReleaseUntilMotion( aCamera, frame.image ) )
+			{
+				break;
+			}
+			continue;
+		}
 
-	// Get dlib facial detector
-	dlib::frontal_face_detector facialDetector = dlib::get_frontal_face_detector();
+		// Without a face in view or while the user rests only some frames are processed
+		if( !aCamera.dutyCycle.Admit( frame.captureTime ) )
+		{
+			mMetrics.framesBackedOff.fetch_add( 1, std::memory_order_relaxed );
+			continue;
+		}
 
-	// Get predictor that maps points onto the face
-	dlib::shape_predictor shapePredictor;
-	dlib::deserialize( "../include/shape_predictor_68_face_landmarks.dat" ) >> shapePredictor;
+		// Recordings processed as fast as possible keep every frame
+		if( mDropFrames && !mGovernor.OnFrame( aCamera.index, frame ) )
+		{
+			mMetrics.framesSkipped.fetch_add( 1, std::memory_order_relaxed );
+			continue;
+		}
+		frame.sequence = sequence++;
 
-	// Face with all 68 points mapped onto it
-	dlib::full_object_detection face;
+		if( !PushFrame( aCamera, std::move( frame ) ) )
+		{
+			break;
+		}
 
-	while( !mExitMonitoring )
+		// One task at a time works through the queue of a camera, so its
+		// frames are processed in order
+		if( !aCamera.scheduled.exchange( true ) )
+		{
+			mWorkers.Submit( std::bind( &Monitor::ProcessFrames, this, std::ref( aCamera ) ) );
+		}
+	}
+
+	aCamera.frameSource->Close();
+	aCamera.capturedFrames.Close();
+	RemoveCamera( aCamera.index );
+}
+
+/**
+    Releases a camera nobody has been in front of for a long time, and
+    reopens it every MOTION_PROBE_INTERVAL to compare a thumbnail of a frame
+    with the previous one. The camera stays open once they differ.
+
+    @param aLastImage last frame read before releasing the camera
+
+    @return true once motion is seen, false when stopped or the camera fails
+*/
+bool Monitor::ReleaseUntilMotion( Camera& aCamera, cv::Mat const& aLastImage )
+{
+	cv::Mat reference = MotionThumbnail( aLastImage );
+	aCamera.frameSource->Close();
+	mMetrics.cameraReleases.fetch_add( 1, std::memory_order_relaxed );
+	std::cout << "Camera " << aCamera.index << " released, nobody in view" << std::endl;
+
+	while( true )
 	{
-		// Capture single frame of video
-		cv::Mat frame;
-		videoCapture >> frame;
-		dlib::cv_image<dlib::bgr_pixel> cimg( frame );
+		{
+			std::unique_lock<std::mutex> lock( mCondVarMutex );
+			mCondVar.wait_for( lock, MOTION_PROBE_INTERVAL, [this]() { return mExitMonitoring.load(); } );
+		}
+		if( mExitMonitoring )
+		{
+			return false;
+		}
 
-		// Detect faces in frame
-		std::vector<dlib::rectangle> faces = facialDetector( cimg );
+		// A camera that cannot be opened, for example while another program
+		// uses it, is tried again later
+		if( !aCamera.frameSource->Open() )
+		{
+			continue;
+		}
 
-		if( faces.size() == 1 )
+		Frame probe;
+		bool read = true;
+		for( int i = 0; i < MOTION_PROBE_FRAMES && read; ++i )
 		{
-			face = shapePredictor( cimg, faces[0] );
+			read = aCamera.frameSource->Read( probe );
+		}
+		if( !read )
+		{
+			aCamera.frameSource->Close();
+			continue;
+		}
 
-			// Point indicies surrounding left and right eyes can be found in the following
-			// article: https://ibug.doc.ic.ac.uk/resources/facial-point-annotations/
-			// Points on diagram are one-based indicies, zero-based below
+		cv::Mat thumbnail = MotionThumbnail( probe.image );
+		if( thumbnail.size() == reference.size() &&
+			cv::norm( thumbnail, reference, cv::NORM_L1 ) / thumbnail.total() > MOTION_THRESHOLD )
+		{
+			std::cout << "Camera " << aCamera.index << " reopened on motion" << std::endl;
+			aCamera.dutyCycle.Wake( std::chrono::steady_clock::now() );
+			return true;
+		}
 
-			Eye leftEye
-				(
-				face.part( 36 ).x(), face.part( 36 ).y(),
-				face.part( 37 ).x(), face.part( 37 ).y(),
-				face.part( 38 ).x(), face.part( 38 ).y(),
-				face.part( 39 ).x(), face.part( 39 ).y(),
-				face.part( 40 ).x(), face.part( 40 ).y(),
-				face.part( 41 ).x(), face.part( 41 ).y()
-				);
+		// Slow changes such as daylight fading are followed rather than waking the camera
+		reference = thumbnail;
+		aCamera.frameSource->Close();
+	}
+}
 
-			Eye rightEye
-				(
-				face.part( 36 ).x(), face.part( 36 ).y(),
-				face.part( 37 ).x(), face.part( 37 ).y(),
-				face.part( 38 ).x(), face.part( 38 ).y(),
-				face.part( 39 ).x(), face.part( 39 ).y(),
-				face.part( 40 ).x(), face.part( 40 ).y(),
-				face.part( 41 ).x(), face.part( 41 ).y()
-				);
+/**
+    Queues a frame for the workers, dropping the oldest waiting frame when
+    frames are paced in real time and waiting for space otherwise
+
+    @return false if monitoring is shutting down
+*/
+bool Monitor::PushFrame( Camera& aCamera, Frame aFrame )
+{
+	if( !mDropFrames )
+	{
+		return aCamera.capturedFrames.PushWait( std::move( aFrame ) );
+	}
+
+	bool pushed = aCamera.capturedFrames.Push( std::move( aFrame ) );
 
-			double averagedEyeAspectRatio =
-				( leftEye.AspectRatio() + rightEye.AspectRatio() ) / 2.0;
+	unsigned long dropped = 0;
+	for( std::unique_ptr<Camera> const& camera : mCameras )
+	{
+		dropped += camera->capturedFrames.Dropped();
+	}
+	mMetrics.framesDropped.store( dropped, std::memory_order_relaxed );
+	return pushed;
+}
 
-			if( averagedEyeAspectRatio < EYE_ASPECT_RATIO_THRESHOLD )
+/**
+    Worker task processing the frames queued for a camera until its queue is
+    empty
+*/
+void Monitor::ProcessFrames( Camera& aCamera )
+{
+	Frame frame;
+	do
+	{
+		while( aCamera.capturedFrames.TryPop( frame ) )
+		{
+			TrackEyes( aCamera, frame );
+		}
+		aCamera.scheduled = false;
+
+		// A frame pushed after the last TryPop found this task still
+		// scheduled, so no other task was queued for it
+	}
+	while( !aCamera.capturedFrames.Empty() && !aCamera.scheduled.exchange( true ) );
+}
+
+/**
+    Loads the landmark model set in the settings, or the eye only model
+    falling back to the 68 point face model when none is set
+
+    @return false if no landmark model could be loaded
+*/
+bool Monitor::LoadLandmarkModel()
+{
+	bool loaded = false;
+	if( !mLandmarkModelPath.empty() )
+	{
+		loaded = mLandmarkModel.Load( mLandmarkModelPath );
+	}
+	else
+	{
+		loaded = mLandmarkModel.Load( EYE_LANDMARK_MODEL_PATH ) ||
+		         mLandmarkModel.Load( FACE_LANDMARK_MODEL_PATH );
+	}
+
+	if( loaded )
+	{
+		std::cout << "Landmark model " << mLandmarkModel.Path() << " loaded in "
+		          << mLandmarkModel.LoadMilliseconds() << " ms"
+		          << ( mLandmarkModel.LoadedFromCache() ? " from cache" : ", cache created" ) << std::endl;
+	}
+	else
+	{
+		std::cout << "No landmark model could be loaded" << std::endl;
+	}
+	return loaded;
+}
+
+/**
+    Detects or tracks the faces in a frame, fits landmarks to them and hands
+    the view of the eyes of the face taken to be the user to mViewSelector
+
+	Method of determining if eyes are open or not is described in this paper:
+	http://vision.fe.uni-lj.si/cvww2016/proceedings/papers/05.pdf. Using landmarks on the face
+	surrounding the eye, the eye aspect ratio is calculated which represents the ratio of the
+	height of the eye to the width of the eye. While aCamera's tracker is following the faces
+	their rectangles are reused and the full frame detector is skipped.
+*/
+void Monitor::TrackEyes( Camera& aCamera, Frame& aFrame )
+{
+	// Wait for the predictor that maps points onto the face
+	if( !mLandmarkModelLoaded.get() )
+	{
+		mExitMonitoring = true;
+		for( std::unique_ptr<Camera>& camera : mCameras )
+		{
+			camera->capturedFrames.Close();
+		}
+		return;
+	}
+	unsigned long firstEyePart = mLandmarkModel.FirstEyePart();
+
+	if( aCamera.faceTracker.TrackedFaces( aFrame.faces, aFrame.faceIds ) )
+	{
+		mMetrics.framesTracked.fetch_add( 1, std::memory_order_relaxed );
+	}
+	else
+	{
+		// Detect faces in frame
+		std::chrono::steady_clock::time_point detectStart = std::chrono::steady_clock::now();
+		aFrame.faces = aCamera.faceDetector.Detect( aFrame.image );
+		mMetrics.detectTime.Record( std::chrono::steady_clock::now() - detectStart );
+		aCamera.faceTracker.OnFacesDetected( aFrame.sequence, aFrame.faces, aFrame.faceIds );
+	}
+
+	aCamera.dutyCycle.OnFaces( aFrame.captureTime, !aFrame.faces.empty() );
+	if( aFrame.faces.empty() )
+	{
+		mMetrics.framesNoFace.fetch_add( 1, std::memory_order_relaxed );
+	}
+	else if( aFrame.faces.size() > 1 )
+	{
+		mMetrics.framesMultipleFaces.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	// Fit the landmarks of every face in parallel, the model is shared read only
+	// and the landmarks of each face are flowed from the previous frame when they can be
+	aCamera.landmarkFlow.BeginFrame( aFrame.image, aFrame.faceIds );
+	std::vector<FaceObservation>& observations = aCamera.observations;
+	observations.assign( aFrame.faces.size(), FaceObservation() );
+	mWorkers.ParallelFor
+		(
+		aFrame.faces.size(),
+		[&]( std::size_t aFace )
+		{
+			FaceObservation& observation = observations[aFace];
+			observation.id = aFrame.faceIds[aFace];
+			observation.face = aFrame.faces[aFace];
+
+			// Face with all landmarks of the model mapped onto it
+			dlib::full_object_detection face;
+			bool flowed = aCamera.landmarkFlow.Track( observation.id, firstEyePart, face );
+			if( flowed )
 			{
-				// Blink detected
-				++counter;
+				mMetrics.landmarksFlowed.fetch_add( 1, std::memory_order_relaxed );
 			}
 			else
 			{
-				// Check if eye was closed for required number of frames
-				if( counter >= EYE_ASPECT_RATIO_CONSECUTIVE_FRAMES )
-				{
-					mUserBlinked();
-				}
-				counter = 0;
+				std::chrono::steady_clock::time_point landmarkStart = std::chrono::steady_clock::now();
+				face = mLandmarkModel.Fit( aFrame.image, observation.face );
+				mMetrics.landmarkTime.Record( std::chrono::steady_clock::now() - landmarkStart );
+			}
+
+			// Frames where the landmarks no longer fit the tracked face only move time on
+			observation.fitted = aCamera.faceTracker.OnLandmarksFitted
+				(
+				aFrame.sequence, observation.id, observation.face, face, firstEyePart
+				);
+			if( !observation.fitted )
+			{
+				aCamera.landmarkFlow.Forget( observation.id );
+				return;
+			}
+			if( !flowed )
+			{
+				aCamera.landmarkFlow.Anchor( observation.id, firstEyePart, face );
 			}
+
+			// Point indicies surrounding left and right eyes can be found in the following
+			// article: https://ibug.doc.ic.ac.uk/resources/facial-point-annotations/
+			// Points on diagram are one-based indicies, zero-based in Eye's part tables. The
+			// eye only model holds the same twelve points starting at index 0 instead of 36.
+
+			Eye leftEye = Eye::FromShape( face, firstEyePart, Eye::LEFT_EYE_PARTS );
+			Eye rightEye = Eye::FromShape( face, firstEyePart, Eye::RIGHT_EYE_PARTS );
+
+			observation.eyeAspectRatio = ( leftEye.AspectRatio() + rightEye.AspectRatio() ) / 2.0;
+
+			// Larger eyes are seen in more detail, and eyes of equal width are
+			// seen from the front rather than from the side
+			double leftWidth = leftEye.Width();
+			double rightWidth = rightEye.Width();
+			observation.quality = ( leftWidth + rightWidth ) *
+				std::min( leftWidth, rightWidth ) / std::max( std::max( leftWidth, rightWidth ), 1.0 );
+		}
+		);
+	aCamera.landmarkFlow.EndFrame();
+
+	if( !aFrame.faces.empty() )
+	{
+		mMetrics.frameLatency.Record( std::chrono::steady_clock::now() - aFrame.captureTime );
+
+		if( !mReportedStartup.exchange( true ) )
+		{
+			std::chrono::duration<double, std::milli> startupTime = std::chrono::steady_clock::now() - mStartTime;
+			std::cout << "Tracking eyes " << startupTime.count() << " ms after start" << std::endl;
+		}
+	}
+
+	// Live cameras are compared on the time since Start, recordings on their own timeline
+	View view;
+	view.camera = aCamera.index;
+	view.time = aCamera.frameSource->IsLive()
+		? std::chrono::duration<double>( aFrame.captureTime - mStartTime ).count()
+		: aFrame.sourceTime;
+
+	// Only the user's face counts towards the reminders, every face counts its own blinks
+	std::size_t primary = 0;
+	if( aCamera.faceRoster.Update( view.time, aFrame.image.cols, observations, primary ) &&
+	    observations[primary].fitted )
+	{
+		view.eyeAspectRatio = observations[primary].eyeAspectRatio;
+		view.quality = observations[primary].quality;
+	}
+
+	SelectView( view );
+}
+
+/**
+    Adds a view to mViewSelector and detects blinks in the views it completes
+*/
+void Monitor::SelectView( View const& aView )
+{
+	std::vector<View> completed;
+	std::lock_guard<std::mutex> lock( mViewMutex );
+	mViewSelector.Add( aView, completed );
+	DetectBlinks( completed );
+}
+
+/**
+    Stops waiting for views of a camera whose frame source has ended, and
+    detects blinks in the views this completes
+*/
+void Monitor::RemoveCamera( std::size_t aCamera )
+{
+	std::vector<View> completed;
+	std::lock_guard<std::mutex> lock( mViewMutex );
+	mViewSelector.RemoveCamera( aCamera, completed );
+	DetectBlinks( completed );
+}
+
+/**
+    Passes the eye aspect ratio of the best view of each time slot to
+    mBlinkDetector, which learns the user's open eye ratio and reports a blink
+    when the ratio has been below the learned threshold for long enough, see
+    BlinkDetector. Slots in which no camera fitted the eyes are skipped.
+
+    Publishing never blocks and runs no slots, so it is done under
+    mViewMutex, which makes the workers take turns as one producer.
+
+    @pre mViewMutex is locked
+*/
+void Monitor::DetectBlinks( std::vector<View> const& aViews )
+{
+	for( View const& view : aViews )
+	{
+		if( view.quality <= 0.0 )
+		{
+			continue;
+		}
+
+		LogEyeAspectRatio( view );
+
+		// While resting the eyes are only checked to be closed
+		if( mResting )
+		{
+			bool closed = view.eyeAspectRatio < mBlinkDetector.Threshold();
+			mRestChecks += 1;
+			mRestChecksEyesClosed += closed ? 1 : 0;
+			mMetrics.restChecks.fetch_add( 1, std::memory_order_relaxed );
+			mMetrics.restChecksEyesClosed.fetch_add( closed ? 1 : 0, std::memory_order_relaxed );
+			continue;
+		}
+
+		if( !mBlinkDetector.Update( view.eyeAspectRatio, view.time ) )
+		{
+			continue;
+		}
+
+		if( !IsLive() )
+		{
+			std::cout << "Blink at " << view.time << " s" << std::endl;
 		}
+		if( mEventLog != nullptr )
+		{
+			mEventLog->Append( EventType::BLINK, static_cast<float>( mBlinkDetector.Threshold() ) );
+		}
+		mMetrics.blinks.fetch_add( 1, std::memory_order_relaxed );
+		mGovernor.OnUserBlinked();
+		mEventBus.Publish( mProducer, BusEvent::USER_BLINKED );
+	}
+}
+
+/**
+    Adds the eye aspect ratio of a selected view to the current second's
+    sample and appends the mean to mEventLog once the view time reaches the
+    next second, so the log holds one sample per second the eyes were seen
+
+    @pre mViewMutex is locked
+*/
+void Monitor::LogEyeAspectRatio( View const& aView )
+{
+	if( mEventLog == nullptr )
+	{
+		return;
 	}
-}
\ No newline at end of file
+
+	double second = std::floor( aView.time );
+	if( second != mEyeAspectRatioSecond && mEyeAspectRatioCount > 0 )
+	{
+		mEventLog->Append( EventType::EYE_ASPECT_RATIO, static_cast<float>( mEyeAspectRatioSum / mEyeAspectRatioCount ) );
+		mEyeAspectRatioSum = 0.0;
+		mEyeAspectRatioCount = 0;
+	}
+	mEyeAspectRatioSecond = second;
+	mEyeAspectRatioSum += aView.eyeAspectRatio;
+	++mEyeAspectRatioCount;
+}
@@ -0,0 +1,75 @@
+/**
+    Definition of RecordingDisplayEffects
+*/
+
+#include "RecordingDisplayEffects.hpp"
+
+/**
+    Constructor
+
+    @param aLog stream each effect is written to as it is applied, null for none
+*/
+RecordingDisplayEffects::RecordingDisplayEffects( std::ostream* aLog )
+    : mLog( aLog )
+{
+}
+
+/**
+    Records a night light change
+*/
+void RecordingDisplayEffects::NightLight( bool aTurnOn, int aTemperature )
+{
+    DisplayEffect effect;
+    effect.type = DisplayEffect::Type::NightLight;
+    effect.time = std::chrono::steady_clock::now();
+    effect.turnOn = aTurnOn;
+    effect.temperature = aTemperature;
+
+    std::lock_guard<std::mutex> lock( mMutex );
+    mEffects.push_back( effect );
+    if( mLog )
+    {
+        *mLog << "Night light " << ( aTurnOn ? "on" : "off" );
+        if( aTemperature > 0 )
+        {
+            *mLog << " at " << aTemperature << " K";
+        }
+        *mLog << std::endl;
+    }
+}
+
+/**
+    Records a notification
+*/
+void RecordingDisplayEffects::Notify( std::string const& aMessage, int aTimeout )
+{
+    DisplayEffect effect;
+    effect.type = DisplayEffect::Type::Notification;
+    effect.time = std::chrono::steady_clock::now();
+    effect.message = aMessage;
+    effect.timeout = aTimeout;
+
+    std::lock_guard<std::mutex> lock( mMutex );
+    mEffects.push_back( effect );
+    if( mLog )
+    {
+        *mLog << "Notification \"" << aMessage << "\" for " << aTimeout << " s" << std::endl;
+    }
+}
+
+/**
+    @return "recording"
+*/
+char const* RecordingDisplayEffects::Name() const
+{
+    return "recording";
+}
+
+/**
+    @return copy of every effect applied so far, oldest first
+*/
+std::vector<DisplayEffect> RecordingDisplayEffects::Effects() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mEffects;
+}
@@ -7,10 +7,14 @@
 /**
     Constructor
 */
-Rest::Rest( int aInterval, int aRestDuration )
-    : mInterval( aInterval )
+Rest::Rest( HabitScheduler& aScheduler, EventBus& aEventBus, int aInterval, int aRestDuration )
+    : mScheduler( aScheduler )
+    , mInterval( aInterval )
     , mRestDuration( aRestDuration )
-    , mExitHabit( false )
+    , mEventBus( aEventBus )
+    , mProducer( aEventBus.AddProducer() )
+    , mRestDueTimer( aScheduler.AddTimer( [this]() { OnRestDue(); } ) )
+    , mRestDoneTimer( aScheduler.AddTimer( [this]() { OnRestDone(); } ) )
 {
 }
 
@@ -19,76 +23,92 @@ Rest::Rest( int aInterval, int aRestDuration )
 */
 void Rest::Start()
 {
-    mThread = std::thread( &Rest::HostHabit, this );
+    mScheduler.Schedule( mRestDueTimer, std::chrono::seconds( mInterval ) );
 }
 
 /**
-    Wakes up waiting condition variable to exit thread
+    Stops enforcement of rest habit
 */
 void Rest::Stop()
 {
-    mExitHabit = true;
-    mCondVar.notify_one();
-    if( mThread.joinable() )
-    {
-        mThread.join();
-    }
+    mScheduler.Cancel( mRestDueTimer );
+    mScheduler.Cancel( mRestDoneTimer );
 }
 
 /**
-    Registers callback for mRemind signal for rest reminders
+    @return seconds between rests
+*/
+int Rest::Interval() const
+{
+    return mInterval;
+}
+
+/**
+    Changes the time between rests, taking effect from the next interval
+*/
+void Rest::SetInterval( int aInterval )
+{
+    mInterval = aInterval;
+}
 
-    @return connection to mRemind signal
+/**
+    @return seconds each rest lasts
+*/
+int Rest::RestDuration() const
+{
+    return mRestDuration;
+}
+
+/**
+    Changes how long each rest lasts, taking effect from the next rest
+*/
+void Rest::SetRestDuration( int aRestDuration )
+{
+    mRestDuration = aRestDuration;
+}
+
+/**
+    Registers callback for REST_REMINDER events, run on the event bus thread
+
+    @return connection to the callback
 */
 boost::signals2::connection Rest::RegisterRestReminder
     (
     boost::signals2::signal<void ( int aRestDuration )>::slot_type const& aSlot
     )
 {
-    return mRemind.connect( aSlot );
+    return mEventBus.Subscribe( BusEvent::REST_REMINDER, aSlot );
 }
 
 /**
-    Registers callback for mCancel signal for rest reminders
+    Registers callback for REST_CANCEL events, run on the event bus thread
 
-    @return connection to mCancel signal
+    @return connection to the callback
 */
 boost::signals2::connection Rest::RegisterRestCancel
     (
     boost::signals2::signal<void ()>::slot_type const& aSlot
     )
 {
-    return mCancel.connect( aSlot );
+    return mEventBus.Subscribe( BusEvent::REST_CANCEL, aSlot );
 }
 
 /**
-    Manages habit of resting eyes every mInterval minutes for mRestDutation seconds
+    mInterval seconds have passed, reminds user to rest for mRestDuration seconds
 */
-void Rest::HostHabit()
+void Rest::OnRestDue()
 {
-    while( !mExitHabit )
-    {
-        std::unique_lock<std::mutex> lock( mCondVarMutex );
-        if( mCondVar.wait_for
-            (
-            lock,
-            std::chrono::seconds( mInterval ),
-            [this]() { return mExitHabit || false; }
-            ) )
-        {
-            // if woken up
-            break;
-        }
-
-        mRemind( mRestDuration );
-
-        mCondVar.wait_for
-            (
-            lock,
-            std::chrono::seconds( mRestDuration ),
-            [this]() { return mExitHabit || false; }
-            );
+    int restDuration = mRestDuration;
+    mEventBus.Publish( mProducer, BusEvent::REST_REMINDER, restDuration );
+    mScheduler.Schedule( mRestDoneTimer, std::chrono::seconds( restDuration ) );
+}
 
-        mCancel();
-    }
-}
\ No newline at end of file
+/**
+    User has rested for mRestDuration seconds, ends the rest and starts the
+    next interval
+*/
+void Rest::OnRestDone()
+{
+    mEventBus.Publish( mProducer, BusEvent::REST_CANCEL );
+    mScheduler.Schedule( mRestDueTimer, std::chrono::seconds( mInterval ) );
+}
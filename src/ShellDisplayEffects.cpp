@@ -0,0 +1,44 @@
+/**
+    Definition of ShellDisplayEffects
+*/
+
+#include "ShellDisplayEffects.hpp"
+
+#include <cstdlib>  // system
+
+/**
+    Sets the state of the desktop night light
+*/
+void ShellDisplayEffects::NightLight( bool aTurnOn, int aTemperature )
+{
+    if( aTemperature > 0 )
+    {
+        // Set temperature for night light
+        std::string setTempCommand = "gsettings set org.gnome.settings-daemon.plugins.color night-light-temperature ";
+        setTempCommand += std::to_string( aTemperature );
+        system( setTempCommand.c_str() );
+    }
+
+    // Switches light on or off
+    std::string onOffCommand = "gsettings set org.gnome.settings-daemon.plugins.color night-light-enabled ";
+    onOffCommand += ( aTurnOn ) ? "true" : "false";
+    system( onOffCommand.c_str() );
+}
+
+/**
+    Sends notification to user
+*/
+void ShellDisplayEffects::Notify( std::string const& aMessage, int aTimeout )
+{
+    // Note: notify-send ignores timeout, it is a known bug
+    std::string command = "notify-send -u critical \"" + aMessage + "\" -t " + std::to_string( aTimeout*1000 );
+    system( command.c_str() );
+}
+
+/**
+    @return "shell"
+*/
+char const* ShellDisplayEffects::Name() const
+{
+    return "shell";
+}
@@ -0,0 +1,284 @@
+/**
+    Definition of V4l2CameraSource
+*/
+
+#include "V4l2CameraSource.hpp"
+
+#ifdef BLINKPLEASE_HAVE_V4L2
+#include <cerrno>               // errno, EINTR
+#include <cstring>              // std::memcpy, std::memset
+#include <fcntl.h>              // open
+#include <linux/videodev2.h>    // v4l2_format, VIDIOC_*
+#include <string>               // std::string, std::to_string
+#include <sys/ioctl.h>          // ioctl
+#include <sys/mman.h>           // mmap, munmap
+#include <unistd.h>             // close
+#endif
+
+#include <iostream>             // std::cout
+
+// Buffers the driver fills in turn, few so frames are not queued up in the driver
+const unsigned int DRIVER_BUFFERS = 2;
+
+#ifdef BLINKPLEASE_HAVE_V4L2
+/**
+    Calls ioctl, retrying when interrupted by a signal
+
+    @return result of ioctl
+*/
+static int Control( int aFd, unsigned long aRequest, void* aArgument )
+{
+    int result;
+    do
+    {
+        result = ioctl( aFd, aRequest, aArgument );
+    }
+    while( result == -1 && errno == EINTR );
+    return result;
+}
+#endif
+
+/**
+    Constructor
+*/
+V4l2CameraSource::V4l2CameraSource( int aDevice )
+    : mDevice( aDevice )
+    , mFd( -1 )
+    , mPixelFormat( 0 )
+    , mWidth( 0 )
+    , mHeight( 0 )
+    , mBytesPerLine( 0 )
+    , mFallback( aDevice )
+    , mUsingFallback( false )
+{
+}
+
+/**
+    Destructor
+*/
+V4l2CameraSource::~V4l2CameraSource()
+{
+    Close();
+}
+
+/**
+    Opens the webcam for intensity only frames, or for colour frames through
+    CameraSource when it cannot deliver them
+
+    @return false if the webcam could not be opened
+*/
+bool V4l2CameraSource::Open()
+{
+    // A webcam found not to deliver intensity only frames is reopened in colour straight away
+    if( !mUsingFallback )
+    {
+        if( OpenDevice() )
+        {
+            mOpenTime = std::chrono::steady_clock::now();
+            return true;
+        }
+
+        Close();
+        std::cout << "Camera " << mDevice << " cannot deliver intensity only frames, capturing colour" << std::endl;
+        mUsingFallback = true;
+    }
+    return mFallback.Open();
+}
+
+/**
+    Releases the webcam
+*/
+void V4l2CameraSource::Close()
+{
+    if( mUsingFallback )
+    {
+        mFallback.Close();
+        return;
+    }
+
+#ifdef BLINKPLEASE_HAVE_V4L2
+    if( mFd >= 0 )
+    {
+        v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        Control( mFd, VIDIOC_STREAMOFF, &type );
+    }
+    for( MappedBuffer const& buffer : mBuffers )
+    {
+        munmap( buffer.start, buffer.length );
+    }
+    if( mFd >= 0 )
+    {
+        close( mFd );
+    }
+#endif
+    mBuffers.clear();
+    mFd = -1;
+}
+
+/**
+    Waits for the next frame and copies its intensity into the frame image,
+    which is reused when it already has the frame size
+
+    @return false if the webcam stopped delivering frames
+*/
+bool V4l2CameraSource::Read( Frame& aFrame )
+{
+    if( mUsingFallback )
+    {
+        return mFallback.Read( aFrame );
+    }
+
+#ifdef BLINKPLEASE_HAVE_V4L2
+    v4l2_buffer buffer;
+    std::memset( &buffer, 0, sizeof( buffer ) );
+    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffer.memory = V4L2_MEMORY_MMAP;
+    if( Control( mFd, VIDIOC_DQBUF, &buffer ) == -1 || buffer.index >= mBuffers.size() )
+    {
+        return false;
+    }
+
+    aFrame.image.create( mHeight, mWidth, CV_8UC1 );
+    unsigned char const* source = static_cast<unsigned char const*>( mBuffers[buffer.index].start );
+    for( int y = 0; y < mHeight; ++y )
+    {
+        unsigned char const* sourceRow = source + y * mBytesPerLine;
+        unsigned char* row = aFrame.image.ptr<unsigned char>( y );
+        if( mPixelFormat == V4L2_PIX_FMT_GREY )
+        {
+            std::memcpy( row, sourceRow, mWidth );
+        }
+        else
+        {
+            // YUYV holds Y0 U Y1 V for every two pixels
+            for( int x = 0; x < mWidth; ++x )
+            {
+                row[x] = sourceRow[2 * x];
+            }
+        }
+    }
+
+    // Hand the buffer back to the driver straight away, the frame has its own copy
+    if( Control( mFd, VIDIOC_QBUF, &buffer ) == -1 )
+    {
+        return false;
+    }
+
+    std::chrono::duration<double> sinceOpen = std::chrono::steady_clock::now() - mOpenTime;
+    aFrame.sourceTime = sinceOpen.count();
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+    @return true, frames arrive in real time
+*/
+bool V4l2CameraSource::IsLive() const
+{
+    return true;
+}
+
+/**
+    Opens the device, picks GREY or YUYV at the device's current frame size
+    and starts streaming into mapped buffers
+
+    @return false if the device cannot stream either format
+*/
+bool V4l2CameraSource::OpenDevice()
+{
+#ifdef BLINKPLEASE_HAVE_V4L2
+    std::string path = "/dev/video" + std::to_string( mDevice );
+    mFd = open( path.c_str(), O_RDWR );
+    if( mFd < 0 )
+    {
+        return false;
+    }
+
+    v4l2_capability capability;
+    std::memset( &capability, 0, sizeof( capability ) );
+    if( Control( mFd, VIDIOC_QUERYCAP, &capability ) == -1 ||
+        !( capability.capabilities & V4L2_CAP_VIDEO_CAPTURE ) ||
+        !( capability.capabilities & V4L2_CAP_STREAMING ) )
+    {
+        return false;
+    }
+
+    // Keep the frame size the device is set to, only change the pixel format
+    v4l2_format format;
+    std::memset( &format, 0, sizeof( format ) );
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if( Control( mFd, VIDIOC_G_FMT, &format ) == -1 )
+    {
+        return false;
+    }
+
+    bool formatSet = false;
+    for( std::uint32_t pixelFormat : { V4L2_PIX_FMT_GREY, V4L2_PIX_FMT_YUYV } )
+    {
+        format.fmt.pix.pixelformat = pixelFormat;
+        format.fmt.pix.field = V4L2_FIELD_NONE;
+        if( Control( mFd, VIDIOC_S_FMT, &format ) == 0 && format.fmt.pix.pixelformat == pixelFormat )
+        {
+            formatSet = true;
+            break;
+        }
+    }
+    if( !formatSet )
+    {
+        return false;
+    }
+
+    mPixelFormat = format.fmt.pix.pixelformat;
+    mWidth = static_cast<int>( format.fmt.pix.width );
+    mHeight = static_cast<int>( format.fmt.pix.height );
+    mBytesPerLine = format.fmt.pix.bytesperline;
+    std::size_t minBytesPerLine = mWidth * ( mPixelFormat == V4L2_PIX_FMT_GREY ? 1 : 2 );
+    if( mBytesPerLine < minBytesPerLine )
+    {
+        mBytesPerLine = minBytesPerLine;
+    }
+
+    v4l2_requestbuffers request;
+    std::memset( &request, 0, sizeof( request ) );
+    request.count = DRIVER_BUFFERS;
+    request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    request.memory = V4L2_MEMORY_MMAP;
+    if( Control( mFd, VIDIOC_REQBUFS, &request ) == -1 || request.count == 0 )
+    {
+        return false;
+    }
+
+    for( unsigned int index = 0; index < request.count; ++index )
+    {
+        v4l2_buffer buffer;
+        std::memset( &buffer, 0, sizeof( buffer ) );
+        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buffer.memory = V4L2_MEMORY_MMAP;
+        buffer.index = index;
+        if( Control( mFd, VIDIOC_QUERYBUF, &buffer ) == -1 )
+        {
+            return false;
+        }
+
+        void* start = mmap( nullptr, buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, buffer.m.offset );
+        if( start == MAP_FAILED )
+        {
+            return false;
+        }
+        mBuffers.push_back( MappedBuffer{ start, buffer.length } );
+
+        if( Control( mFd, VIDIOC_QBUF, &buffer ) == -1 ||
+            buffer.length < mBytesPerLine * mHeight )
+        {
+            return false;
+        }
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    return Control( mFd, VIDIOC_STREAMON, &type ) == 0;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,69 @@
+/**
+    Definition of VideoFileSource
+*/
+
+#include "VideoFileSource.hpp"
+
+/**
+    Constructor
+*/
+VideoFileSource::VideoFileSource( std::string const& aPath, double aDefaultFrameRate )
+    : mPath( aPath )
+    , mFrameRate( aDefaultFrameRate )
+    , mFramesRead( 0 )
+{
+}
+
+/**
+    Opens the video file and reads its frame rate
+
+    @return false if the file could not be opened
+*/
+bool VideoFileSource::Open()
+{
+    if( !mVideoCapture.open( mPath ) )
+    {
+        return false;
+    }
+
+    double frameRate = mVideoCapture.get( cv::CAP_PROP_FPS );
+    if( frameRate > 0.0 )
+    {
+        mFrameRate = frameRate;
+    }
+    mFramesRead = 0;
+    return true;
+}
+
+/**
+    Closes the video file
+*/
+void VideoFileSource::Close()
+{
+    mVideoCapture.release();
+}
+
+/**
+    Decodes the next frame of the video
+
+    @return false at the end of the video
+*/
+bool VideoFileSource::Read( Frame& aFrame )
+{
+    if( !mVideoCapture.read( aFrame.image ) || aFrame.image.empty() )
+    {
+        return false;
+    }
+
+    aFrame.sourceTime = mFramesRead / mFrameRate;
+    ++mFramesRead;
+    return true;
+}
+
+/**
+    @return false, frames come from a recording
+*/
+bool VideoFileSource::IsLive() const
+{
+    return false;
+}
@@ -0,0 +1,106 @@
+/**
+    Definition of ViewSelector
+*/
+
+#include "ViewSelector.hpp"
+
+#include <algorithm>    // std::max, std::min
+#include <climits>      // LONG_MAX
+#include <cmath>        // std::floor
+
+// Slots are completed once any camera is this many slots ahead of them
+const long SLOT_LAG = 3;
+
+/**
+    Constructor
+
+    @param aCameras number of cameras delivering views
+    @param aSlotSeconds length of a time slot, about one frame interval
+*/
+ViewSelector::ViewSelector( std::size_t aCameras, double aSlotSeconds )
+    : mSlotSeconds( aSlotSeconds )
+    , mCameraSlots( aCameras, -1 )
+    , mActive( aCameras, true )
+    , mCompletedSlot( -1 )
+{
+}
+
+/**
+    Adds the view of one camera
+
+    @param aCompleted receives the best view of each slot completed by this
+            view, oldest first, views without a face are included
+*/
+void ViewSelector::Add( View const& aView, std::vector<View>& aCompleted )
+{
+    long slot = static_cast<long>( std::floor( aView.time / mSlotSeconds ) );
+    mCameraSlots[aView.camera] = std::max( mCameraSlots[aView.camera], slot );
+
+    if( slot > mCompletedSlot )
+    {
+        std::map<long, View>::iterator open = mOpenSlots.find( slot );
+        if( open == mOpenSlots.end() )
+        {
+            mOpenSlots.emplace( slot, aView );
+        }
+        else if( aView.quality > open->second.quality )
+        {
+            open->second = aView;
+        }
+    }
+
+    Complete( aCompleted );
+}
+
+/**
+    Stops waiting for views from a camera, for example at the end of a
+    recording
+
+    @param aCompleted receives the best view of each slot completed
+*/
+void ViewSelector::RemoveCamera( std::size_t aCamera, std::vector<View>& aCompleted )
+{
+    mActive[aCamera] = false;
+    Complete( aCompleted );
+}
+
+/**
+    Completes every open slot
+
+    @param aCompleted receives the best view of each open slot
+*/
+void ViewSelector::Flush( std::vector<View>& aCompleted )
+{
+    for( std::pair<long const, View> const& open : mOpenSlots )
+    {
+        aCompleted.push_back( open.second );
+        mCompletedSlot = open.first;
+    }
+    mOpenSlots.clear();
+}
+
+/**
+    Hands out open slots that every active camera has moved past, or that
+    are SLOT_LAG slots behind the newest view
+*/
+void ViewSelector::Complete( std::vector<View>& aCompleted )
+{
+    long oldest = LONG_MAX;
+    long newest = -1;
+    for( std::size_t camera = 0; camera < mCameraSlots.size(); ++camera )
+    {
+        newest = std::max( newest, mCameraSlots[camera] );
+        if( mActive[camera] )
+        {
+            oldest = std::min( oldest, mCameraSlots[camera] );
+        }
+    }
+
+    while( !mOpenSlots.empty() &&
+           ( mOpenSlots.begin()->first <= oldest || mOpenSlots.begin()->first <= newest - SLOT_LAG ) )
+    {
+        aCompleted.push_back( mOpenSlots.begin()->second );
+        mCompletedSlot = mOpenSlots.begin()->first;
+        mOpenSlots.erase( mOpenSlots.begin() );
+    }
+}
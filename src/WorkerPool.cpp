@@ -0,0 +1,193 @@
+/**
+    Definition of WorkerPool
+*/
+
+#include "WorkerPool.hpp"
+
+#include <algorithm>    // std::min
+#include <atomic>       // std::atomic
+#include <memory>       // std::shared_ptr
+
+/**
+    Constructor
+
+    @param aThreads number of threads, at least one is started
+*/
+WorkerPool::WorkerPool( unsigned int aThreads )
+    : mSize( aThreads > 0 ? aThreads : 1 )
+    , mRunning( 0 )
+    , mExit( false )
+{
+}
+
+/**
+    Destructor
+*/
+WorkerPool::~WorkerPool()
+{
+    Stop();
+}
+
+/**
+    Starts the threads
+*/
+void WorkerPool::Start()
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mExit = false;
+    }
+
+    for( unsigned int i = 0; i < mSize; ++i )
+    {
+        mThreads.emplace_back( &WorkerPool::Work, this );
+    }
+}
+
+/**
+    Waits for running tasks to finish and stops the threads. Tasks that have
+    not started are discarded.
+*/
+void WorkerPool::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mExit = true;
+        mTasks.clear();
+    }
+    mCondVar.notify_all();
+
+    for( std::thread& thread : mThreads )
+    {
+        if( thread.joinable() )
+        {
+            thread.join();
+        }
+    }
+    mThreads.clear();
+    mIdleCondVar.notify_all();
+}
+
+/**
+    Queues a task to run on the next free thread
+*/
+void WorkerPool::Submit( std::function<void ()> aTask )
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mTasks.push_back( std::move( aTask ) );
+    }
+    mCondVar.notify_one();
+}
+
+/**
+    Runs aBody for every index from 0 to aCount - 1 on the calling thread and
+    on idle threads of the pool, and waits until all have finished
+
+    The calling thread takes indices as well, so this never waits on a busy
+    pool and can be called from a task running on the pool.
+*/
+void WorkerPool::ParallelFor( std::size_t aCount, std::function<void ( std::size_t )> const& aBody )
+{
+    if( aCount == 0 )
+    {
+        return;
+    }
+
+    /**
+        State shared with the helping tasks, which may start after the loop
+        has finished
+    */
+    struct Loop
+    {
+        std::function<void ( std::size_t )> body;
+        std::size_t count;
+        std::atomic<std::size_t> next;
+        std::size_t finished;
+        std::condition_variable condVar;
+        std::mutex mutex;
+    };
+
+    std::shared_ptr<Loop> loop = std::make_shared<Loop>();
+    loop->body = aBody;
+    loop->count = aCount;
+    loop->next = 0;
+    loop->finished = 0;
+
+    std::function<void ()> run = [loop]()
+    {
+        std::size_t finished = 0;
+        for( std::size_t i = loop->next++; i < loop->count; i = loop->next++ )
+        {
+            loop->body( i );
+            ++finished;
+        }
+
+        if( finished > 0 )
+        {
+            std::lock_guard<std::mutex> lock( loop->mutex );
+            loop->finished += finished;
+            if( loop->finished == loop->count )
+            {
+                loop->condVar.notify_all();
+            }
+        }
+    };
+
+    std::size_t helpers = std::min<std::size_t>( aCount - 1, mSize );
+    for( std::size_t i = 0; i < helpers; ++i )
+    {
+        Submit( run );
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock( loop->mutex );
+    loop->condVar.wait( lock, [&loop]() { return loop->finished == loop->count; } );
+}
+
+/**
+    Waits until no tasks are queued or running
+*/
+void WorkerPool::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock( mMutex );
+    mIdleCondVar.wait( lock, [this]() { return mExit || ( mTasks.empty() && mRunning == 0 ); } );
+}
+
+/**
+    @return number of threads
+*/
+unsigned int WorkerPool::Size() const
+{
+    return mSize;
+}
+
+/**
+    Runs tasks until the pool stops
+*/
+void WorkerPool::Work()
+{
+    std::unique_lock<std::mutex> lock( mMutex );
+    while( true )
+    {
+        mCondVar.wait( lock, [this]() { return mExit || !mTasks.empty(); } );
+        if( mExit )
+        {
+            return;
+        }
+
+        std::function<void ()> task = std::move( mTasks.front() );
+        mTasks.pop_front();
+        ++mRunning;
+
+        lock.unlock();
+        task();
+        lock.lock();
+
+        --mRunning;
+        if( mTasks.empty() && mRunning == 0 )
+        {
+            mIdleCondVar.notify_all();
+        }
+    }
+}
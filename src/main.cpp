@@ -11,9 +11,31 @@
     their eyes for 20 seconds. The screen's night light will be turned on at a strong intensity
     until the required 20 seconds of rest has been completed. The user will be able to set the
     cadence of the reminders to blink and rest and the duration of the resting period.
+
+    Options:
+    --source <device | video file | image directory>   track eyes in a recording instead of the webcam,
+                                                       repeat to watch with several cameras
+    --workers <threads>                                threads detecting faces and fitting landmarks
+    --fast                                             process recordings as fast as possible
+    --detection-scale <scale>                          scale frames by before face detection
+    --face-detector <hog | haar | lbp | dnn>           engine finding faces
+    --face-model <path>                                cascade or network file of the face detector
+    --landmark-interval <frames>                       fit eye landmarks every N frames, flow them in between
+    --metrics-socket <path>                            serve metrics on a Unix domain socket
+    --metrics-file <path>                              write metrics to a file every interval
+    --metrics-interval <seconds>                       seconds between metrics file writes
+    --event-log <directory>                            log blinks and reminders for blinklog
+    --calibration <path>                               load and save the blink calibration
+    --cpu-budget <percent>                             share of one core eye tracking may use
+    --max-frame-rate <frames per second>               highest rate frames are processed at
+    --effects <dbus | shell | recording>               how the night light and notifications are shown
+    --colour-capture                                   read colour frames from webcams instead of intensity only
+    --daemon <socket path>                             run until stopped, serving commands on a control socket
 */
 
-#include <cstdlib>  // atoi
+#include <cstdlib>  // atoi, atof
+#include <string>   // std::string
+#include <vector>   // std::vector
 
 #include "App.hpp"
 
@@ -22,8 +44,91 @@ int main( int argc, char* argv[] )
     int blinkInterval;
     int restInterval;
     int restDuration;
+    MonitorSettings monitorSettings;
+    MetricsSettings metricsSettings;
+    std::string displayEffects;
+    std::string controlSocket;
 
-    if( argc != 4 )
+    // Options may appear anywhere, the remaining arguments are the intervals
+    std::vector<int> intervals;
+    for( int i = 1; i < argc; ++i )
+    {
+        std::string argument = argv[i];
+        if( argument == "--source" && i + 1 < argc )
+        {
+            monitorSettings.frameSources.push_back( argv[++i] );
+        }
+        else if( argument == "--workers" && i + 1 < argc )
+        {
+            monitorSettings.workerThreads = atoi( argv[++i] );
+        }
+        else if( argument == "--colour-capture" )
+        {
+            monitorSettings.lumaCapture = false;
+        }
+        else if( argument == "--fast" )
+        {
+            monitorSettings.realTime = false;
+        }
+        else if( argument == "--detection-scale" && i + 1 < argc )
+        {
+            monitorSettings.detectionScale = atof( argv[++i] );
+        }
+        else if( argument == "--face-detector" && i + 1 < argc )
+        {
+            monitorSettings.faceDetector = argv[++i];
+        }
+        else if( argument == "--face-model" && i + 1 < argc )
+        {
+            monitorSettings.faceModelPath = argv[++i];
+        }
+        else if( argument == "--landmark-interval" && i + 1 < argc )
+        {
+            monitorSettings.landmarkInterval = atoi( argv[++i] );
+        }
+        else if( argument == "--metrics-socket" && i + 1 < argc )
+        {
+            metricsSettings.socketPath = argv[++i];
+        }
+        else if( argument == "--metrics-file" && i + 1 < argc )
+        {
+            metricsSettings.filePath = argv[++i];
+        }
+        else if( argument == "--metrics-interval" && i + 1 < argc )
+        {
+            metricsSettings.intervalSeconds = atoi( argv[++i] );
+        }
+        else if( argument == "--event-log" && i + 1 < argc )
+        {
+            metricsSettings.eventLogDirectory = argv[++i];
+        }
+        else if( argument == "--calibration" && i + 1 < argc )
+        {
+            monitorSettings.calibrationPath = argv[++i];
+        }
+        else if( argument == "--cpu-budget" && i + 1 < argc )
+        {
+            monitorSettings.cpuBudget = atof( argv[++i] ) / 100.0;
+        }
+        else if( argument == "--max-frame-rate" && i + 1 < argc )
+        {
+            monitorSettings.maxFrameRate = atof( argv[++i] );
+        }
+        else if( argument == "--effects" && i + 1 < argc )
+        {
+            displayEffects = argv[++i];
+        }
+        else if( argument == "--daemon" && i + 1 < argc )
+        {
+            controlSocket = argv[++i];
+        }
+        else
+        {
+            intervals.push_back( atoi( argument.c_str() ) );
+        }
+    }
+
+    if( intervals.size() != 3 )
     {
         blinkInterval = 4;       // 4 seconds
         restInterval  = 20 * 60; // 20 minutes
@@ -31,12 +136,14 @@ int main( int argc, char* argv[] )
     }
     else
     {
-        blinkInterval = atoi( argv[1] );
-        restInterval  = atoi( argv[2] );
-        restDuration  = atoi( argv[3] );
+        blinkInterval = intervals[0];
+        restInterval  = intervals[1];
+        restDuration  = intervals[2];
     }
 
-    App application( blinkInterval, restInterval, restDuration );
+    monitorSettings.blinkInterval = blinkInterval;
+
+    App application( blinkInterval, restInterval, restDuration, monitorSettings, metricsSettings, displayEffects, controlSocket );
     application.Run();
 
     return 0;
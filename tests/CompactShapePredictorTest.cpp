@@ -0,0 +1,241 @@
+/**
+    Checks CompactShapePredictor against dlib::shape_predictor
+
+    Trains a small shape predictor on synthetic faces, converts it to a cache
+    and fits every face with both, at the labelled rectangles and at shifted
+    and scaled ones, on intensity and colour images. The landmark models
+    installed in include/ are checked the same way on random images. Any
+    landmark that differs fails the test.
+
+    Usage:
+    ./compact_shape_predictor_test
+*/
+
+#include <cstdlib>                  // EXIT_SUCCESS, EXIT_FAILURE
+#include <dlib/array.h>             // dlib::array
+#include <dlib/array2d.h>           // dlib::array2d
+#include <dlib/image_processing.h>  // dlib::shape_predictor, dlib::shape_predictor_trainer
+#include <dlib/opencv.h>            // dlib::cv_image
+#include <filesystem>               // std::filesystem
+#include <iostream>                 // std::cout, std::cerr
+#include <opencv2/imgproc.hpp>      // cv::cvtColor
+#include <random>                   // std::mt19937, std::uniform_int_distribution
+#include <string>                   // std::string
+#include <unistd.h>                 // getpid
+#include <vector>                   // std::vector
+
+#include "CompactShapePredictor.hpp"
+
+// Synthetic training set: images, their size and the landmarks of each face
+const unsigned long IMAGES = 24;
+const long IMAGE_SIZE = 160;
+const unsigned long PARTS = 12;
+
+typedef std::vector<std::vector<dlib::full_object_detection>> FaceList;
+
+/**
+    Fills an image with noise
+*/
+static void FillNoise( dlib::array2d<unsigned char>& aImage, std::mt19937& aRandom )
+{
+    std::uniform_int_distribution<int> intensity( 0, 255 );
+    for( long y = 0; y < aImage.nr(); ++y )
+    {
+        for( long x = 0; x < aImage.nc(); ++x )
+        {
+            aImage[y][x] = static_cast<unsigned char>( intensity( aRandom ) );
+        }
+    }
+}
+
+/**
+    Draws a face of PARTS bright landmarks on a noisy image
+
+    @return the face with its landmarks
+*/
+static dlib::full_object_detection DrawFace( dlib::array2d<unsigned char>& aImage, std::mt19937& aRandom )
+{
+    std::uniform_int_distribution<long> corner( 10, 50 );
+    std::uniform_int_distribution<long> size( 70, 100 );
+    std::uniform_int_distribution<long> jitter( -3, 3 );
+
+    long left = corner( aRandom );
+    long top = corner( aRandom );
+    long width = size( aRandom );
+    dlib::rectangle face( left, top, left + width - 1, top + width - 1 );
+
+    std::vector<dlib::point> parts;
+    for( unsigned long part = 0; part < PARTS; ++part )
+    {
+        long x = left + width * static_cast<long>( 2 + ( part % 6 ) ) / 9 + jitter( aRandom );
+        long y = top + width * static_cast<long>( part < 6 ? 3 : 5 ) / 9 + jitter( aRandom );
+        parts.emplace_back( x, y );
+        for( long dy = -2; dy <= 2; ++dy )
+        {
+            for( long dx = -2; dx <= 2; ++dx )
+            {
+                aImage[y + dy][x + dx] = 255;
+            }
+        }
+    }
+    return dlib::full_object_detection( face, parts );
+}
+
+/**
+    @return a copy of a rectangle moved and resized by up to a tenth of its size
+*/
+static dlib::rectangle Perturb( dlib::rectangle const& aFace, std::mt19937& aRandom )
+{
+    long step = static_cast<long>( aFace.width() ) / 10;
+    std::uniform_int_distribution<long> offset( -step, step );
+    return dlib::rectangle
+        (
+        aFace.left() + offset( aRandom ),
+        aFace.top() + offset( aRandom ),
+        aFace.right() + offset( aRandom ),
+        aFace.bottom() + offset( aRandom )
+        );
+}
+
+/**
+    Fits a face with dlib and the compact predictor on the intensity image and
+    on a colour copy of it
+
+    @return number of landmarks that differ
+*/
+static unsigned long CompareFit
+    (
+    dlib::shape_predictor const& aPredictor,
+    CompactShapePredictor const& aCompact,
+    dlib::array2d<unsigned char>& aImage,
+    dlib::rectangle const& aFace
+    )
+{
+    cv::Mat intensity( static_cast<int>( aImage.nr() ), static_cast<int>( aImage.nc() ), CV_8UC1, &aImage[0][0] );
+    cv::Mat colour;
+    cv::cvtColor( intensity, colour, cv::COLOR_GRAY2BGR );
+
+    dlib::full_object_detection expected[2] =
+        {
+        aPredictor( dlib::cv_image<unsigned char>( intensity ), aFace ),
+        aPredictor( dlib::cv_image<dlib::bgr_pixel>( colour ), aFace )
+        };
+    dlib::full_object_detection fitted[2] =
+        {
+        aCompact.Fit( intensity, aFace ),
+        aCompact.Fit( colour, aFace )
+        };
+
+    unsigned long differences = 0;
+    for( int image = 0; image < 2; ++image )
+    {
+        if( fitted[image].num_parts() != expected[image].num_parts() )
+        {
+            return expected[image].num_parts();
+        }
+        for( unsigned long part = 0; part < expected[image].num_parts(); ++part )
+        {
+            if( fitted[image].part( part ) != expected[image].part( part ) )
+            {
+                ++differences;
+            }
+        }
+    }
+    return differences;
+}
+
+/**
+    Converts and maps a model and compares it with dlib on faces of images
+
+    @return false if the model could not be converted or any landmark differs
+*/
+static bool CheckModel
+    (
+    std::string const& aName,
+    std::string const& aModelPath,
+    std::filesystem::path const& aDirectory,
+    dlib::array<dlib::array2d<unsigned char>>& aImages,
+    std::vector<dlib::rectangle> const& aFaces,
+    std::mt19937& aRandom
+    )
+{
+    dlib::shape_predictor predictor;
+    dlib::deserialize( aModelPath ) >> predictor;
+
+    std::string cachePath = ( aDirectory / ( aName + ".spcache" ) ).string();
+    CompactShapePredictor compact;
+    if( !CompactShapePredictor::Convert( aModelPath, cachePath ) || !compact.Map( cachePath, aModelPath ) )
+    {
+        std::cerr << aName << ": could not convert " << aModelPath << std::endl;
+        return false;
+    }
+
+    unsigned long fits = 0;
+    unsigned long differences = 0;
+    for( std::size_t image = 0; image < aImages.size(); ++image )
+    {
+        differences += CompareFit( predictor, compact, aImages[image], aFaces[image] );
+        differences += CompareFit( predictor, compact, aImages[image], Perturb( aFaces[image], aRandom ) );
+        fits += 4;
+    }
+
+    std::cout << aName << ": " << fits << " fits of " << predictor.num_parts() << " landmarks, "
+              << differences << " landmarks differ" << std::endl;
+    return differences == 0;
+}
+
+int main()
+{
+    std::mt19937 random( 5 );
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() /
+        ( "blinkplease_compact_test_" + std::to_string( getpid() ) );
+    std::filesystem::create_directories( directory );
+
+    // Train a small predictor on synthetic faces
+    dlib::array<dlib::array2d<unsigned char>> images;
+    images.resize( IMAGES );
+    FaceList faces( IMAGES );
+    std::vector<dlib::rectangle> rectangles;
+    for( unsigned long image = 0; image < IMAGES; ++image )
+    {
+        images[image].set_size( IMAGE_SIZE, IMAGE_SIZE );
+        FillNoise( images[image], random );
+        faces[image].push_back( DrawFace( images[image], random ) );
+        rectangles.push_back( faces[image][0].get_rect() );
+    }
+
+    dlib::shape_predictor_trainer trainer;
+    trainer.set_cascade_depth( 4 );
+    trainer.set_num_trees_per_cascade_level( 50 );
+    trainer.set_tree_depth( 3 );
+    trainer.set_oversampling_amount( 10 );
+    trainer.set_num_threads( 1 );
+    std::string trainedPath = ( directory / "trained.dat" ).string();
+    dlib::serialize( trainedPath ) << trainer.train( images, faces );
+
+    bool passed = CheckModel( "trained", trainedPath, directory, images, rectangles, random );
+
+    // Installed models are checked on random faces of noise images
+#ifdef BLINKPLEASE_MODEL_DIR
+    for( char const* model : { "shape_predictor_12_eye_landmarks.dat", "shape_predictor_68_face_landmarks.dat" } )
+    {
+        std::filesystem::path modelPath = std::filesystem::path( BLINKPLEASE_MODEL_DIR ) / model;
+        if( !std::filesystem::exists( modelPath ) )
+        {
+            continue;
+        }
+
+        for( unsigned long image = 0; image < IMAGES; ++image )
+        {
+            FillNoise( images[image], random );
+        }
+        passed = CheckModel( model, modelPath.string(), directory, images, rectangles, random ) && passed;
+    }
+#endif
+
+    std::error_code error;
+    std::filesystem::remove_all( directory, error );
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
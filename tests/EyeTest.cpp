@@ -0,0 +1,295 @@
+/**
+    Checks the Eye Aspect Ratio of Eye and EyeBatch
+
+    Eyes with hand computed ratios are checked exactly, random eyes are
+    checked against the original pow based formula, and the left and right
+    eye part tables are checked against the landmark numbering of the 68
+    point face model and of the 12 point eye model. Any difference fails the
+    test.
+
+    Usage:
+    ./eye_test
+*/
+
+#include <cmath>        // std::pow, std::sqrt
+#include <cstdlib>      // EXIT_SUCCESS, EXIT_FAILURE
+#include <iostream>     // std::cout, std::cerr
+#include <random>       // std::mt19937, std::uniform_int_distribution
+#include <string>       // std::string
+#include <vector>       // std::vector
+
+#include "Eye.hpp"
+#include "EyeBatch.hpp"
+
+// Number of random eyes checked against the original formula
+const std::size_t RANDOM_EYES = 4096;
+
+// Random landmark coordinates are drawn from [-COORDINATE_RANGE, COORDINATE_RANGE]
+const int COORDINATE_RANGE = 2000;
+
+/**
+    Eye outline with its expected aspect ratio and width
+*/
+struct Expected
+{
+    std::string name;
+    int points[Eye::POINTS][2];
+    double aspectRatio;
+    double width;
+};
+
+// Eyes whose ratios are exact in double precision
+const std::vector<Expected> HAND_COMPUTED =
+    {
+    // heights 2 and 2, width 4
+    { "open", { { 0, 0 }, { 1, -1 }, { 3, -1 }, { 4, 0 }, { 3, 1 }, { 1, 1 } }, 0.5, 4.0 },
+    // heights 5 (3-4-5) and 3, width 10 (6-8-10)
+    { "slanted", { { 0, 0 }, { 1, -2 }, { 5, -2 }, { 6, 8 }, { 5, 1 }, { 4, 2 } }, 0.4, 10.0 },
+    // lids on the corner line
+    { "closed", { { 10, 20 }, { 13, 20 }, { 17, 20 }, { 20, 20 }, { 17, 20 }, { 13, 20 } }, 0.0, 10.0 },
+    // heights 6 and 6, width 10
+    { "wide", { { -5, 7 }, { -3, 4 }, { 3, 4 }, { 5, 7 }, { 3, 10 }, { -3, 10 } }, 0.6, 10.0 }
+    };
+
+/**
+    Landmark numbering of a shape predictor model
+*/
+struct Layout
+{
+    std::string name;
+    unsigned long parts;
+    unsigned long firstEyePart;
+    unsigned long leftEye[Eye::POINTS];
+    unsigned long rightEye[Eye::POINTS];
+};
+
+const std::vector<Layout> LAYOUTS =
+    {
+    { "68 point face model", 68, 36, { 36, 37, 38, 39, 40, 41 }, { 42, 43, 44, 45, 46, 47 } },
+    { "12 point eye model", 12, 0, { 0, 1, 2, 3, 4, 5 }, { 6, 7, 8, 9, 10, 11 } }
+    };
+
+/**
+    Shape with the part( i ).x() and part( i ).y() interface of a fitted dlib shape
+*/
+class Shape
+{
+public:
+
+    struct Point
+    {
+        int mX;
+        int mY;
+        int x() const { return mX; }
+        int y() const { return mY; }
+    };
+
+    std::vector<Point> mParts;
+
+    Point const& part( unsigned long aIndex ) const { return mParts.at( aIndex ); }
+};
+
+/**
+    Eye Aspect Ratio as computed before Eye stored its points inline, with std::pow
+
+    @return ratio of the eye outlined by aPoints
+*/
+static double OriginalAspectRatio( int const aPoints[Eye::POINTS][2] )
+{
+    auto distance = [&aPoints]( int p, int q )
+        {
+        return std::sqrt( std::pow( ( aPoints[q][0] - aPoints[p][0] ), 2.0 ) +
+                          std::pow( ( aPoints[q][1] - aPoints[p][1] ), 2.0 )
+                        );
+        };
+    return ( distance( 1, 5 ) + distance( 2, 4 ) ) / ( 2.0 * distance( 0, 3 ) );
+}
+
+/**
+    @return eye outlined by aPoints
+*/
+static Eye MakeEye( int const aPoints[Eye::POINTS][2] )
+{
+    return Eye
+        (
+        aPoints[0][0], aPoints[0][1],
+        aPoints[1][0], aPoints[1][1],
+        aPoints[2][0], aPoints[2][1],
+        aPoints[3][0], aPoints[3][1],
+        aPoints[4][0], aPoints[4][1],
+        aPoints[5][0], aPoints[5][1]
+        );
+}
+
+/**
+    Reports a failed check
+
+    @return false
+*/
+static bool Fail( std::string const& aCheck, double aExpected, double aActual )
+{
+    std::cerr.precision( 17 );
+    std::cerr << aCheck << ": expected " << aExpected << ", got " << aActual << std::endl;
+    return false;
+}
+
+/**
+    Checks Eye and EyeBatch on eyes with hand computed ratios
+
+    @return false if any ratio or width differs
+*/
+static bool CheckHandComputed()
+{
+    bool passed = true;
+    EyeBatch batch;
+    for( Expected const& expected : HAND_COMPUTED )
+    {
+        Eye eye = MakeEye( expected.points );
+        batch.Add( eye );
+        if( eye.AspectRatio() != expected.aspectRatio )
+        {
+            passed = Fail( "Eye::AspectRatio of " + expected.name + " eye", expected.aspectRatio, eye.AspectRatio() );
+        }
+        if( eye.Width() != expected.width )
+        {
+            passed = Fail( "Eye::Width of " + expected.name + " eye", expected.width, eye.Width() );
+        }
+    }
+
+    std::vector<double> ratios;
+    batch.AspectRatios( ratios );
+    for( std::size_t i = 0; i < HAND_COMPUTED.size(); ++i )
+    {
+        if( ratios[i] != HAND_COMPUTED[i].aspectRatio )
+        {
+            passed = Fail( "EyeBatch::AspectRatios of " + HAND_COMPUTED[i].name + " eye", HAND_COMPUTED[i].aspectRatio, ratios[i] );
+        }
+    }
+
+    std::cout << HAND_COMPUTED.size() << " hand computed eyes checked" << std::endl;
+    return passed;
+}
+
+/**
+    Checks Eye and EyeBatch against the original formula on random eyes, and
+    that a cleared batch is reused correctly
+
+    @return false if any ratio differs
+*/
+static bool CheckOriginalFormula( std::mt19937& aRandom )
+{
+    std::uniform_int_distribution<int> coordinate( -COORDINATE_RANGE, COORDINATE_RANGE );
+
+    std::vector<std::vector<int>> eyes;
+    while( eyes.size() < RANDOM_EYES )
+    {
+        std::vector<int> eye( Eye::POINTS * 2 );
+        for( int& value : eye )
+        {
+            value = coordinate( aRandom );
+        }
+        // Corners must differ or the ratio is not defined
+        if( eye[0] != eye[6] || eye[1] != eye[7] )
+        {
+            eyes.push_back( eye );
+        }
+    }
+
+    bool passed = true;
+    EyeBatch batch;
+    batch.Add( MakeEye( HAND_COMPUTED[0].points ) );
+    batch.Clear();
+    batch.Reserve( eyes.size() );
+    std::vector<double> expected;
+    for( std::vector<int> const& values : eyes )
+    {
+        auto points = reinterpret_cast<int const ( * )[2]>( values.data() );
+        Eye eye = MakeEye( points );
+        batch.Add( eye );
+        expected.push_back( OriginalAspectRatio( points ) );
+        if( eye.AspectRatio() != expected.back() && passed )
+        {
+            passed = Fail( "Eye::AspectRatio of random eye " + std::to_string( expected.size() - 1 ), expected.back(), eye.AspectRatio() );
+        }
+    }
+
+    std::vector<double> ratios;
+    batch.AspectRatios( ratios );
+    if( ratios.size() != expected.size() )
+    {
+        return Fail( "EyeBatch::AspectRatios count", static_cast<double>( expected.size() ), static_cast<double>( ratios.size() ) );
+    }
+    for( std::size_t i = 0; i < expected.size(); ++i )
+    {
+        if( ratios[i] != expected[i] )
+        {
+            passed = Fail( "EyeBatch::AspectRatios of random eye " + std::to_string( i ), expected[i], ratios[i] );
+            break;
+        }
+    }
+
+    std::cout << eyes.size() << " random eyes checked against the original formula" << std::endl;
+    return passed;
+}
+
+/**
+    Checks that the part tables pick the landmarks of each eye of a layout
+
+    @return false if Eye::FromShape builds an eye from other landmarks
+*/
+static bool CheckLayout( Layout const& aLayout, std::mt19937& aRandom )
+{
+    std::uniform_int_distribution<int> coordinate( -COORDINATE_RANGE, COORDINATE_RANGE );
+
+    Shape shape;
+    for( unsigned long part = 0; part < aLayout.parts; ++part )
+    {
+        shape.mParts.push_back( Shape::Point{ coordinate( aRandom ), coordinate( aRandom ) } );
+    }
+
+    bool passed = true;
+    struct Side
+    {
+        char const* name;
+        Eye::Parts const& parts;
+        unsigned long const* landmarks;
+    };
+    for( Side const& side : { Side{ "left", Eye::LEFT_EYE_PARTS, aLayout.leftEye }, Side{ "right", Eye::RIGHT_EYE_PARTS, aLayout.rightEye } } )
+    {
+        int points[Eye::POINTS][2];
+        for( std::size_t point = 0; point < Eye::POINTS; ++point )
+        {
+            points[point][0] = shape.part( side.landmarks[point] ).x();
+            points[point][1] = shape.part( side.landmarks[point] ).y();
+        }
+        Eye expected = MakeEye( points );
+        Eye eye = Eye::FromShape( shape, aLayout.firstEyePart, side.parts );
+
+        std::string check = std::string( side.name ) + " eye of " + aLayout.name;
+        if( eye.AspectRatio() != expected.AspectRatio() )
+        {
+            passed = Fail( "Eye::AspectRatio of " + check, expected.AspectRatio(), eye.AspectRatio() );
+        }
+        if( eye.Width() != expected.Width() )
+        {
+            passed = Fail( "Eye::Width of " + check, expected.Width(), eye.Width() );
+        }
+    }
+
+    std::cout << "eye parts of the " << aLayout.name << " checked" << std::endl;
+    return passed;
+}
+
+int main()
+{
+    std::mt19937 random( 9 );
+
+    bool passed = CheckHandComputed();
+    passed = CheckOriginalFormula( random ) && passed;
+    for( Layout const& layout : LAYOUTS )
+    {
+        passed = CheckLayout( layout, random ) && passed;
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,285 @@
+/**
+    Reports eye habits recorded in event logs
+
+    Reads the event logs written by EventLog with --event-log, for as many
+    months as are given, and prints for each day and in total how long the
+    eyes were tracked, how often the user blinked, the median and 90th
+    percentile time between blinks, and how many blink and rest reminders
+    were given. Files are mapped and scanned once, so a year of logs is
+    reported on in well under a second.
+
+    Usage:
+    ./blinklog <log directory | log file> ... [--from YYYY-MM-DD] [--to YYYY-MM-DD]
+*/
+
+#include <algorithm>    // std::sort
+#include <array>        // std::array
+#include <cstdint>      // std::int64_t, std::uint64_t
+#include <cstdio>       // std::printf, std::sscanf
+#include <ctime>        // std::tm, std::mktime, localtime_r
+#include <filesystem>   // std::filesystem::directory_iterator
+#include <iostream>     // std::cerr
+#include <map>          // std::map
+#include <string>       // std::string
+#include <vector>       // std::vector
+
+#include "EventLog.hpp"
+#include "EventLogReader.hpp"
+
+// Blinks further apart than this are taken to span a break, not an interval between blinks
+const double MAX_BLINK_INTERVAL_SECONDS = 60.0;
+// Resolution of the blink interval histogram
+const double INTERVAL_BIN_SECONDS = 0.1;
+const std::size_t INTERVAL_BINS = 600;
+const std::int64_t MICROSECONDS_PER_SECOND = 1000000;
+
+/**
+    Eye habits over a span of time
+*/
+struct Summary
+{
+    // Eye aspect ratio samples, one for each second the eyes were tracked
+    std::uint64_t trackedSeconds = 0;
+    std::uint64_t blinks = 0;
+    std::uint64_t blinkReminders = 0;
+    std::uint64_t restReminders = 0;
+    std::uint64_t restsCompleted = 0;
+    // Histogram of the intervals between blinks
+    std::array<std::uint64_t, INTERVAL_BINS> intervals = {};
+    std::uint64_t intervalCount = 0;
+
+    void AddInterval( double aSeconds )
+    {
+        std::size_t bin = static_cast<std::size_t>( aSeconds / INTERVAL_BIN_SECONDS );
+        ++intervals[bin < INTERVAL_BINS ? bin : INTERVAL_BINS - 1];
+        ++intervalCount;
+    }
+
+    void Add( Summary const& aOther )
+    {
+        trackedSeconds += aOther.trackedSeconds;
+        blinks += aOther.blinks;
+        blinkReminders += aOther.blinkReminders;
+        restReminders += aOther.restReminders;
+        restsCompleted += aOther.restsCompleted;
+        for( std::size_t bin = 0; bin < INTERVAL_BINS; ++bin )
+        {
+            intervals[bin] += aOther.intervals[bin];
+        }
+        intervalCount += aOther.intervalCount;
+    }
+
+    /**
+        @return interval in seconds below which aFraction of the intervals fall, 0 without intervals
+    */
+    double IntervalPercentile( double aFraction ) const
+    {
+        std::uint64_t rank = static_cast<std::uint64_t>( aFraction * intervalCount );
+        std::uint64_t seen = 0;
+        for( std::size_t bin = 0; bin < INTERVAL_BINS && intervalCount > 0; ++bin )
+        {
+            seen += intervals[bin];
+            if( seen > rank )
+            {
+                return ( bin + 0.5 ) * INTERVAL_BIN_SECONDS;
+            }
+        }
+        return 0.0;
+    }
+};
+
+/**
+    Parses a YYYY-MM-DD date as local midnight
+
+    @return false if aText is not a date
+*/
+bool ParseDate( std::string const& aText, std::int64_t& aTime )
+{
+    std::tm date = {};
+    if( std::sscanf( aText.c_str(), "%d-%d-%d", &date.tm_year, &date.tm_mon, &date.tm_mday ) != 3 )
+    {
+        return false;
+    }
+    date.tm_year -= 1900;
+    date.tm_mon -= 1;
+    date.tm_isdst = -1;
+    aTime = static_cast<std::int64_t>( std::mktime( &date ) ) * MICROSECONDS_PER_SECOND;
+    return true;
+}
+
+/**
+    Finds the local day an event time falls in
+
+    @param aStart set to the start of the day in microseconds since the epoch
+    @param aEnd set to the start of the next day
+    @return day as YYYY-MM-DD
+*/
+std::string LocalDay( std::int64_t aTime, std::int64_t& aStart, std::int64_t& aEnd )
+{
+    std::time_t time = static_cast<std::time_t>( aTime / MICROSECONDS_PER_SECOND );
+    std::tm day;
+    localtime_r( &time, &day );
+
+    char name[16];
+    std::snprintf( name, sizeof( name ), "%04d-%02d-%02d", day.tm_year + 1900, day.tm_mon + 1, day.tm_mday );
+
+    day.tm_hour = 0;
+    day.tm_min = 0;
+    day.tm_sec = 0;
+    day.tm_isdst = -1;
+    aStart = static_cast<std::int64_t>( std::mktime( &day ) ) * MICROSECONDS_PER_SECOND;
+    day.tm_mday += 1;
+    day.tm_isdst = -1;
+    aEnd = static_cast<std::int64_t>( std::mktime( &day ) ) * MICROSECONDS_PER_SECOND;
+    return name;
+}
+
+/**
+    Prints one row of the report
+*/
+void PrintRow( std::string const& aLabel, Summary const& aSummary )
+{
+    double trackedMinutes = aSummary.trackedSeconds / 60.0;
+    double blinkRate = trackedMinutes > 0.0 ? aSummary.blinks / trackedMinutes : 0.0;
+    std::printf
+        (
+        "%-10s %8.1f h %8llu %10.1f %9.1f s %9.1f s %10llu %10llu %8llu\n",
+        aLabel.c_str(),
+        trackedMinutes / 60.0,
+        static_cast<unsigned long long>( aSummary.blinks ),
+        blinkRate,
+        aSummary.IntervalPercentile( 0.5 ),
+        aSummary.IntervalPercentile( 0.9 ),
+        static_cast<unsigned long long>( aSummary.blinkReminders ),
+        static_cast<unsigned long long>( aSummary.restReminders ),
+        static_cast<unsigned long long>( aSummary.restsCompleted )
+        );
+}
+
+int main( int argc, char** argv )
+{
+    std::vector<std::string> paths;
+    std::int64_t from = INT64_MIN;
+    std::int64_t to = INT64_MAX;
+    for( int i = 1; i < argc; ++i )
+    {
+        std::string argument = argv[i];
+        if( argument == "--from" && i + 1 < argc )
+        {
+            if( !ParseDate( argv[++i], from ) )
+            {
+                std::cerr << "Invalid date " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if( argument == "--to" && i + 1 < argc )
+        {
+            // Inclusive, so up to the start of the next day
+            if( !ParseDate( argv[++i], to ) )
+            {
+                std::cerr << "Invalid date " << argv[i] << std::endl;
+                return 1;
+            }
+            std::int64_t start = 0;
+            LocalDay( to, start, to );
+        }
+        else if( std::filesystem::is_directory( argument ) )
+        {
+            for( std::filesystem::directory_entry const& entry : std::filesystem::directory_iterator( argument ) )
+            {
+                if( entry.path().extension() == ".events" )
+                {
+                    paths.push_back( entry.path().string() );
+                }
+            }
+        }
+        else
+        {
+            paths.push_back( argument );
+        }
+    }
+
+    if( paths.empty() )
+    {
+        std::cerr << "Usage: " << argv[0] << " <log directory | log file> ... [--from YYYY-MM-DD] [--to YYYY-MM-DD]" << std::endl;
+        return 1;
+    }
+
+    // Files are named by month, so sorting them orders their events in time
+    std::sort( paths.begin(), paths.end() );
+
+    std::map<std::string, Summary> days;
+    Summary* day = nullptr;
+    std::int64_t dayStart = 0;
+    std::int64_t dayEnd = 0;
+    // Time of the previous blink, valid once seenBlink is true
+    bool seenBlink = false;
+    std::int64_t lastBlink = 0;
+
+    EventLogReader reader;
+    for( std::string const& path : paths )
+    {
+        if( !reader.Open( path ) )
+        {
+            std::cerr << "Skipping " << path << ", not an event log" << std::endl;
+            continue;
+        }
+
+        for( EventRecord const& record : reader )
+        {
+            if( record.time < from || record.time >= to )
+            {
+                continue;
+            }
+            if( day == nullptr || record.time < dayStart || record.time >= dayEnd )
+            {
+                day = &days[LocalDay( record.time, dayStart, dayEnd )];
+            }
+
+            switch( static_cast<EventType>( record.type ) )
+            {
+            case EventType::BLINK:
+            {
+                if( seenBlink )
+                {
+                    double interval = static_cast<double>( record.time - lastBlink ) / MICROSECONDS_PER_SECOND;
+                    if( interval >= 0.0 && interval <= MAX_BLINK_INTERVAL_SECONDS )
+                    {
+                        day->AddInterval( interval );
+                    }
+                }
+                seenBlink = true;
+                lastBlink = record.time;
+                ++day->blinks;
+                break;
+            }
+            case EventType::EYE_ASPECT_RATIO:
+                ++day->trackedSeconds;
+                break;
+            case EventType::BLINK_REMINDER:
+                ++day->blinkReminders;
+                break;
+            case EventType::REST_REMINDER:
+                ++day->restReminders;
+                break;
+            case EventType::REST_END:
+                ++day->restsCompleted;
+                break;
+            }
+        }
+    }
+
+    std::printf
+        (
+        "%-10s %10s %8s %10s %11s %11s %10s %10s %8s\n",
+        "Date", "Tracked", "Blinks", "Blinks/min", "Median gap", "90% gap", "Blink rem.", "Rest rem.", "Rests"
+        );
+    Summary total;
+    for( std::pair<std::string const, Summary> const& entry : days )
+    {
+        PrintRow( entry.first, entry.second );
+        total.Add( entry.second );
+    }
+    PrintRow( "Total", total );
+    return 0;
+}
@@ -0,0 +1,147 @@
+/**
+    Trains an eye only landmark model
+
+    Monitor only uses the twelve landmarks surrounding the eyes, but the 68 point
+    face model fits and stores every landmark of the face. This tool reads a dlib
+    image dataset labelled with the 68 point iBUG scheme, such as the iBUG 300-W
+    dataset at http://dlib.net/files/data/ibug_300W_large_face_landmark_dataset.tar.gz,
+    prunes every face down to points 36 to 47 and trains a shape predictor that
+    fits only those twelve points. Datasets that are already labelled with the
+    twelve eye points are used as they are.
+
+    The resulting model is loaded by LandmarkModel and is used by Monitor in
+    place of the 68 point model when installed as
+    include/shape_predictor_12_eye_landmarks.dat.
+
+    Usage:
+    ./train_eye_model <training.xml> <output.dat> [testing.xml]
+*/
+
+#include <cmath>                    // std::hypot
+#include <dlib/array.h>             // dlib::array
+#include <dlib/array2d.h>           // dlib::array2d
+#include <dlib/data_io.h>           // dlib::load_image_dataset
+#include <dlib/image_processing.h>  // dlib::shape_predictor_trainer
+#include <iostream>                 // std::cout, std::cerr
+#include <thread>                   // std::thread::hardware_concurrency
+#include <vector>                   // std::vector
+
+// Layout of the 68 point iBUG annotation
+const unsigned long FULL_FACE_PARTS = 68;
+const unsigned long FULL_FACE_FIRST_EYE_PART = 36;
+// Landmarks kept in the eye only model, six for each eye
+const unsigned long EYE_ONLY_PARTS = 12;
+const unsigned long PARTS_PER_EYE = 6;
+
+typedef std::vector<std::vector<dlib::full_object_detection>> FaceList;
+
+/**
+    Removes every landmark except the twelve eye landmarks from each face
+
+    @return false if a face is labelled with neither 68 nor 12 points
+*/
+bool PruneToEyes( FaceList& aFaces )
+{
+    for( std::vector<dlib::full_object_detection>& imageFaces : aFaces )
+    {
+        for( dlib::full_object_detection& face : imageFaces )
+        {
+            if( face.num_parts() == EYE_ONLY_PARTS )
+            {
+                continue;
+            }
+            if( face.num_parts() != FULL_FACE_PARTS )
+            {
+                return false;
+            }
+
+            std::vector<dlib::point> eyeParts;
+            for( unsigned long part = 0; part < EYE_ONLY_PARTS; ++part )
+            {
+                eyeParts.push_back( face.part( FULL_FACE_FIRST_EYE_PART + part ) );
+            }
+            face = dlib::full_object_detection( face.get_rect(), eyeParts );
+        }
+    }
+    return true;
+}
+
+/**
+    Calculates the distance between the centres of the eyes of every face,
+    used to normalise the landmark error so it does not depend on face size
+
+    @return interocular distance of each face in aFaces
+*/
+std::vector<std::vector<double>> InterocularDistances( FaceList const& aFaces )
+{
+    std::vector<std::vector<double>> distances;
+    for( std::vector<dlib::full_object_detection> const& imageFaces : aFaces )
+    {
+        std::vector<double> imageDistances;
+        for( dlib::full_object_detection const& face : imageFaces )
+        {
+            double leftX = 0.0, leftY = 0.0, rightX = 0.0, rightY = 0.0;
+            for( unsigned long part = 0; part < PARTS_PER_EYE; ++part )
+            {
+                leftX  += face.part( part ).x();
+                leftY  += face.part( part ).y();
+                rightX += face.part( PARTS_PER_EYE + part ).x();
+                rightY += face.part( PARTS_PER_EYE + part ).y();
+            }
+            imageDistances.push_back( std::hypot( rightX - leftX, rightY - leftY ) / PARTS_PER_EYE );
+        }
+        distances.push_back( imageDistances );
+    }
+    return distances;
+}
+
+int main( int argc, char* argv[] )
+{
+    if( argc < 3 )
+    {
+        std::cerr << "Usage: " << argv[0] << " <training.xml> <output.dat> [testing.xml]" << std::endl;
+        return 1;
+    }
+
+    dlib::array<dlib::array2d<unsigned char>> trainingImages;
+    FaceList trainingFaces;
+    dlib::load_image_dataset( trainingImages, trainingFaces, argv[1] );
+    if( !PruneToEyes( trainingFaces ) )
+    {
+        std::cerr << argv[1] << " must be labelled with 68 face or 12 eye landmarks" << std::endl;
+        return 1;
+    }
+
+    // Settings follow dlib's shape predictor example, the smaller output shape
+    // leaves room for more oversampling at the same training cost
+    dlib::shape_predictor_trainer trainer;
+    trainer.set_oversampling_amount( 300 );
+    trainer.set_nu( 0.05 );
+    trainer.set_tree_depth( 2 );
+    trainer.set_num_threads( std::thread::hardware_concurrency() );
+    trainer.be_verbose();
+
+    dlib::shape_predictor predictor = trainer.train( trainingImages, trainingFaces );
+
+    std::cout << "Mean training error: "
+              << dlib::test_shape_predictor( predictor, trainingImages, trainingFaces, InterocularDistances( trainingFaces ) )
+              << std::endl;
+
+    if( argc > 3 )
+    {
+        dlib::array<dlib::array2d<unsigned char>> testingImages;
+        FaceList testingFaces;
+        dlib::load_image_dataset( testingImages, testingFaces, argv[3] );
+        if( PruneToEyes( testingFaces ) )
+        {
+            std::cout << "Mean testing error: "
+                      << dlib::test_shape_predictor( predictor, testingImages, testingFaces, InterocularDistances( testingFaces ) )
+                      << std::endl;
+        }
+    }
+
+    dlib::serialize( argv[2] ) << predictor;
+    std::cout << "Saved " << EYE_ONLY_PARTS << " point eye model to " << argv[2] << std::endl;
+
+    return 0;
+}